@@ -0,0 +1,260 @@
+/*
+ * Bulk file encryption with AES-CCM, from minicrypt library host tools
+ *
+ * Usage: ccmfile [-d] [-t] [-q depth] [-c chunkKB] <hexkey> <infile> <outfile>
+ *
+ * The file is encrypted as a sequence of AES-CCM messages, one per chunk
+ * of plaintext, each carrying its own random nonce and tag (see
+ * AESCCMMini_Encrypt). The same chunk size must be given to decrypt.
+ *
+ * Each message starts with an 8-byte big-endian header inside the
+ * encryption: the chunk number, with the top bit set on the last chunk.
+ * Decryption checks the numbers run 0, 1, 2 ... and that the file ends
+ * with, and only with, the marked chunk, so dropping, reordering or
+ * truncating whole chunks is detected as well as changes within one.
+ * An empty file is encrypted as a single empty last chunk.
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define _GNU_SOURCE
+#include "aesccm_mini.h"
+#include "filepipe.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/random.h>
+#include <sys/stat.h>
+
+#define CCMFILE_L  4   /* Allows chunks up to 4GB */
+#define CCMFILE_M  16
+#define CCMFILE_DEFAULT_CHUNK_KB 1024
+#define CCMFILE_HDR 8
+#define CCMFILE_FINAL 0x8000000000000000ULL
+
+typedef struct
+{
+  AESCCMMini_ctx ccm;
+  uint64_t index;       /* Number of the next chunk */
+  uint64_t nchunks;     /* Encrypting: chunks in the whole file */
+  int sawFinal;         /* Decrypting: the last-chunk mark has been seen */
+  uint8_t *buf;         /* Header plus one chunk of plaintext */
+}
+  CCMFile;
+
+MCResult MC_GetRandom(uint8_t *buffer, size_t length)
+{
+  while ( length > 0 )
+  {
+    ssize_t n = getrandom(buffer, length, 0);
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return MC_RANDOM_FAIL;
+    buffer += n;
+    length -= (size_t)n;
+  }
+  return MC_OK;
+}
+
+static void put_header(uint8_t *p, uint64_t v)
+{
+  int i;
+  for (i=0; i < CCMFILE_HDR; i++)
+    p[i] = (uint8_t)(v >> (8*(CCMFILE_HDR-1-i)));
+}
+
+static uint64_t get_header(const uint8_t *p)
+{
+  uint64_t v = 0;
+  int i;
+  for (i=0; i < CCMFILE_HDR; i++)
+    v = (v << 8) | p[i];
+  return v;
+}
+
+static MCResult encrypt_chunk(void *arg, const uint8_t *in, size_t inLen,
+                              uint8_t *out, size_t *outLen)
+{
+  CCMFile *cf = (CCMFile *)arg;
+  size_t cLen;
+  MCResult rc;
+
+  if ( AESCCMMini_EncryptLength(&cf->ccm, CCMFILE_HDR + inLen, &cLen) != MC_OK || cLen > *outLen )
+    return MC_BAD_LENGTH;
+  put_header(cf->buf, cf->index | (cf->index + 1 >= cf->nchunks ? CCMFILE_FINAL : 0));
+  if ( inLen > 0 )
+    memcpy(cf->buf + CCMFILE_HDR, in, inLen);
+  rc = AESCCMMini_Encrypt(&cf->ccm, cf->buf, CCMFILE_HDR + inLen, out, cLen);
+  cf->index++;
+  *outLen = cLen;
+  return rc;
+}
+
+static MCResult decrypt_chunk(void *arg, const uint8_t *in, size_t inLen,
+                              uint8_t *out, size_t *outLen)
+{
+  CCMFile *cf = (CCMFile *)arg;
+  size_t pLen;
+  uint64_t hdr;
+  MCResult rc;
+
+  if ( AESCCMMini_DecryptLength(&cf->ccm, inLen, &pLen) != MC_OK
+       || pLen < CCMFILE_HDR || pLen - CCMFILE_HDR > *outLen )
+    return MC_BAD_LENGTH;
+  if ( cf->sawFinal )
+    return MC_VERIFY_FAILED;   /* Chunks after the last one */
+  rc = AESCCMMini_Decrypt(&cf->ccm, in, inLen, cf->buf, pLen);
+  if ( rc != MC_OK )
+    return rc;
+
+  hdr = get_header(cf->buf);
+  if ( (hdr & ~CCMFILE_FINAL) != cf->index )
+    return MC_VERIFY_FAILED;
+  cf->sawFinal = (hdr & CCMFILE_FINAL) != 0;
+  cf->index++;
+  *outLen = pLen - CCMFILE_HDR;
+  memcpy(out, cf->buf + CCMFILE_HDR, *outLen);
+  return MC_OK;
+}
+
+/* Writes the single empty last chunk which stands for an empty file */
+static MCResult encrypt_empty(CCMFile *cf, int outfd, size_t cipherChunk)
+{
+  uint8_t *out = malloc(cipherChunk);
+  size_t outLen = cipherChunk;
+  MCResult rc;
+
+  if ( out == NULL )
+    return MC_BAD_LENGTH;
+  rc = encrypt_chunk(cf, NULL, 0, out, &outLen);
+  if ( rc == MC_OK && write(outfd, out, outLen) != (ssize_t)outLen )
+    rc = MC_IO_ERROR;
+  free(out);
+  return rc;
+}
+
+static int parse_key(const char *hex, uint8_t *key)
+{
+  size_t n = strlen(hex), i;
+
+  if ( n != 2*AESMINI_128BIT_KEY && n != 2*AESMINI_192BIT_KEY && n != 2*AESMINI_256BIT_KEY )
+    return 0;
+  for (i=0; i < n/2; i++)
+  {
+    unsigned v;
+    if ( sscanf(hex + 2*i, "%2x", &v) != 1 )
+      return 0;
+    key[i] = (uint8_t)v;
+  }
+  return (int)(n/2);
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "Usage: ccmfile [-d] [-t] [-q depth] [-c chunkKB] <hexkey> <infile> <outfile>\n"
+                  "  -d  decrypt (default is encrypt)\n"
+                  "  -t  use I/O thread instead of io_uring\n"
+                  "  -q  number of chunks in flight (default %d)\n"
+                  "  -c  plaintext chunk size in KB (default %d)\n",
+                  FILEPIPE_DEFAULT_DEPTH, CCMFILE_DEFAULT_CHUNK_KB);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  CCMFile cf;
+  struct stat st;
+  uint8_t key[AESMINI_256BIT_KEY];
+  int keylen, opt, infd, outfd;
+  int decrypt = 0, ioMode = FILEPIPE_IO_AUTO;
+  unsigned depth = FILEPIPE_DEFAULT_DEPTH;
+  size_t chunk = CCMFILE_DEFAULT_CHUNK_KB * 1024, cipherChunk;
+  MCResult rc;
+
+  while ( (opt = getopt(argc, argv, "dtq:c:")) != -1 )
+  {
+    switch (opt)
+    {
+      case 'd': decrypt = 1; break;
+      case 't': ioMode = FILEPIPE_IO_THREAD; break;
+      case 'q': depth = (unsigned) atoi(optarg); break;
+      case 'c': chunk = (size_t) atol(optarg) * 1024; break;
+      default: usage();
+    }
+  }
+  if ( argc - optind != 3 )
+    usage();
+
+  keylen = parse_key(argv[optind], key);
+  if ( keylen == 0 )
+  {
+    fprintf(stderr, "ccmfile: key must be 32, 48 or 64 hex digits\n");
+    return 2;
+  }
+  memset(&cf, 0, sizeof(cf));
+  if ( chunk == 0
+       || AESCCMMini_Init(&cf.ccm, key, keylen, CCMFILE_L, CCMFILE_M) != MC_OK
+       || AESCCMMini_EncryptLength(&cf.ccm, CCMFILE_HDR + chunk, &cipherChunk) != MC_OK )
+  {
+    fprintf(stderr, "ccmfile: bad parameters\n");
+    return 2;
+  }
+  memset(key, 0, sizeof(key));
+  cf.buf = malloc(CCMFILE_HDR + chunk);
+  if ( cf.buf == NULL )
+  {
+    fprintf(stderr, "ccmfile: out of memory\n");
+    return 1;
+  }
+
+  infd = open(argv[optind+1], O_RDONLY);
+  if ( infd < 0 )
+  {
+    perror(argv[optind+1]);
+    return 1;
+  }
+  outfd = open(argv[optind+2], O_WRONLY|O_CREAT|O_TRUNC, 0600);
+  if ( outfd < 0 )
+  {
+    perror(argv[optind+2]);
+    return 1;
+  }
+
+  if ( decrypt )
+  {
+    rc = FilePipe_Run(infd, outfd, cipherChunk, chunk, depth, ioMode, decrypt_chunk, &cf);
+    if ( rc == MC_OK && !cf.sawFinal )
+      rc = MC_VERIFY_FAILED;   /* Truncated */
+  }
+  else if ( fstat(infd, &st) != 0 )
+    rc = MC_BAD_PARAMS;
+  else
+  {
+    cf.nchunks = ((uint64_t)st.st_size + chunk - 1) / chunk;
+    if ( cf.nchunks == 0 )
+      rc = encrypt_empty(&cf, outfd, cipherChunk);
+    else
+      rc = FilePipe_Run(infd, outfd, chunk, cipherChunk, depth, ioMode, encrypt_chunk, &cf);
+  }
+  free(cf.buf);
+
+  close(infd);
+  if ( close(outfd) != 0 && rc == MC_OK )
+    rc = MC_IO_ERROR;
+
+  if ( rc != MC_OK )
+  {
+    fprintf(stderr, "ccmfile: %s failed (error %d, %s I/O)\n",
+            decrypt ? "decryption" : "encryption", rc, FilePipe_LastIOMode());
+    unlink(argv[optind+2]);
+    return 1;
+  }
+  return 0;
+}
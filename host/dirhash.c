@@ -0,0 +1,414 @@
+/*
+ * Multi-threaded directory tree hashing from minicrypt library host tools
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define _GNU_SOURCE
+#include "dirhash.h"
+#include "workpool.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define READ_SIZE  (1024*1024)
+#define SLOT_SIZE  (DIRHASH_SMALL_MAX + 1)  /* One more, to see if a file grew */
+
+typedef struct
+{
+  size_t first;           /* Index into the entry list */
+  size_t count;           /* 1 for a large file */
+  int large;
+}
+  Item;
+
+typedef struct
+{
+  DirHash_entry *entries;
+  size_t nentries, entcap;
+  Item *items;
+  size_t nitems;
+  uint8_t **bufs;         /* Per worker, DIRHASH_BATCH slots */
+
+  pthread_mutex_t lock;   /* Protects the rest */
+  uint8_t *done;
+  size_t next;            /* Next entry to pass to fn */
+  DirHash_fn fn;
+  void *arg;
+}
+  Run;
+
+/* Walking ---------------------------------------- */
+
+static int add_entry(Run *r, char *path, uint64_t size, int err)
+{
+  if ( r->nentries == r->entcap )
+  {
+    size_t cap = r->entcap ? 2 * r->entcap : 1024;
+    DirHash_entry *e = realloc(r->entries, cap * sizeof(DirHash_entry));
+    if ( e == NULL )
+      return ENOMEM;
+    r->entries = e;
+    r->entcap = cap;
+  }
+  memset(&r->entries[r->nentries], 0, sizeof(DirHash_entry));
+  r->entries[r->nentries].path = path;
+  r->entries[r->nentries].size = size;
+  r->entries[r->nentries].err = err;
+  r->nentries++;
+  return 0;
+}
+
+static int cmp_names(const void *a, const void *b)
+{
+  return strcmp(*(char *const *)a, *(char *const *)b);
+}
+
+static char *join(const char *dir, const char *name)
+{
+  size_t dl = strlen(dir), nl = strlen(name);
+  char *p = malloc(dl + nl + 2);
+
+  if ( p != NULL )
+  {
+    memcpy(p, dir, dl);
+    p[dl] = '/';
+    memcpy(p + dl + 1, name, nl + 1);
+  }
+  return p;
+}
+
+/* Takes ownership of 'path'. Anything which can't be examined or
+   listed becomes an entry with 'err' set, and the walk goes on; only
+   running out of memory stops it. */
+static int walk(Run *r, char *path)
+{
+  struct stat st;
+  DIR *d;
+  struct dirent *de;
+  char **names = NULL;
+  size_t n = 0, cap = 0, i;
+  int rc = 0, err = 0;
+
+  if ( lstat(path, &st) != 0 )
+    return add_entry(r, path, 0, errno);
+  if ( S_ISREG(st.st_mode) )
+    return add_entry(r, path, (uint64_t)st.st_size, 0);
+  if ( !S_ISDIR(st.st_mode) )
+  {
+    free(path);
+    return 0;
+  }
+
+  d = opendir(path);
+  if ( d == NULL )
+    return add_entry(r, path, 0, errno);
+  for (;;)
+  {
+    errno = 0;
+    de = readdir(d);
+    if ( de == NULL )
+    {
+      err = errno;
+      break;
+    }
+    if ( strcmp(de->d_name, ".") == 0 || strcmp(de->d_name, "..") == 0 )
+      continue;
+    if ( n == cap )
+    {
+      char **nn;
+      cap = cap ? 2 * cap : 64;
+      nn = realloc(names, cap * sizeof(char *));
+      if ( nn == NULL )
+      {
+        rc = ENOMEM;
+        break;
+      }
+      names = nn;
+    }
+    names[n] = join(path, de->d_name);
+    if ( names[n] == NULL )
+    {
+      rc = ENOMEM;
+      break;
+    }
+    n++;
+  }
+  closedir(d);
+
+  qsort(names, n, sizeof(char *), cmp_names);
+  for (i=0; i < n; i++)
+  {
+    if ( rc == 0 )
+      rc = walk(r, names[i]);
+    else
+      free(names[i]);
+  }
+  free(names);
+
+  /* Listing failed part way: report the directory after what was seen */
+  if ( rc == 0 && err != 0 )
+    return add_entry(r, path, 0, err);
+  free(path);
+  return rc;
+}
+
+/* Hashing ---------------------------------------- */
+
+static int hash_mapped(DirHash_entry *e, int fd, SHA256Mini_ctx *ctx)
+{
+  struct stat st;
+  void *map;
+
+  if ( fstat(fd, &st) != 0 || st.st_size <= 0 || (uint64_t)st.st_size != (size_t)st.st_size )
+    return 0;
+  map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  if ( map == MAP_FAILED )
+    return 0;
+  madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+  SHA256Mini_Update(ctx, map, (size_t)st.st_size);
+  munmap(map, (size_t)st.st_size);
+  e->size = (uint64_t)st.st_size;
+  return 1;
+}
+
+static void hash_large(DirHash_entry *e, uint8_t *buf)
+{
+  SHA256Mini_ctx ctx;
+  int fd = open(e->path, O_RDONLY);
+
+  if ( fd < 0 )
+  {
+    e->err = errno;
+    return;
+  }
+  SHA256Mini_Init(&ctx);
+  e->size = 0;
+  if ( !hash_mapped(e, fd, &ctx) )
+  {
+    /* Not mappable (e.g. shrank to nothing): plain reads */
+    for (;;)
+    {
+      ssize_t n = read(fd, buf, READ_SIZE);
+      if ( n == 0 )
+        break;
+      if ( n < 0 )
+      {
+        if ( errno == EINTR )
+          continue;
+        e->err = errno;
+        break;
+      }
+      SHA256Mini_Update(&ctx, buf, (size_t)n);
+      e->size += (uint64_t)n;
+    }
+  }
+  close(fd);
+  SHA256Mini_Final(&ctx, e->hash);
+}
+
+/* Reads up to SLOT_SIZE bytes; returns the count, or -1 with e->err set */
+static ssize_t read_small(DirHash_entry *e, uint8_t *slot)
+{
+  size_t got = 0;
+  int fd = open(e->path, O_RDONLY);
+
+  if ( fd < 0 )
+  {
+    e->err = errno;
+    return -1;
+  }
+  while ( got < SLOT_SIZE )
+  {
+    ssize_t n = read(fd, slot + got, SLOT_SIZE - got);
+    if ( n == 0 )
+      break;
+    if ( n < 0 )
+    {
+      if ( errno == EINTR )
+        continue;
+      e->err = errno;
+      close(fd);
+      return -1;
+    }
+    got += (size_t)n;
+  }
+  close(fd);
+  return (ssize_t)got;
+}
+
+static void hash_batch(Run *r, const Item *it, uint8_t *buf)
+{
+  const void *msgs[DIRHASH_BATCH];
+  size_t lens[DIRHASH_BATCH];
+  size_t map[DIRHASH_BATCH];
+  uint8_t out[DIRHASH_BATCH * SHA256MINI_HASHLEN];
+  size_t i, n = 0;
+
+  for (i=0; i < it->count; i++)
+  {
+    DirHash_entry *e = &r->entries[it->first + i];
+    uint8_t *slot = buf + i * SLOT_SIZE;
+    ssize_t got;
+
+    if ( e->err != 0 )
+      continue;           /* Failed during the walk */
+    got = read_small(e, slot);
+    if ( got < 0 )
+      continue;
+    if ( got == SLOT_SIZE )
+    {
+      /* Grew since the walk; too big for its slot */
+      hash_large(e, buf + DIRHASH_BATCH * SLOT_SIZE);
+      continue;
+    }
+    e->size = (uint64_t)got;
+    msgs[n] = slot;
+    lens[n] = (size_t)got;
+    map[n++] = it->first + i;
+  }
+
+  SHA256Mini_Multi(msgs, lens, n, out);
+  for (i=0; i < n; i++)
+    memcpy(r->entries[map[i]].hash, out + i * SHA256MINI_HASHLEN, SHA256MINI_HASHLEN);
+}
+
+/* Marks entries done, and passes on all those now ready in order */
+static void finish(Run *r, size_t first, size_t count)
+{
+  pthread_mutex_lock(&r->lock);
+  memset(r->done + first, 1, count);
+  while ( r->next < r->nentries && r->done[r->next] )
+  {
+    r->fn(r->arg, &r->entries[r->next]);
+    r->next++;
+  }
+  pthread_mutex_unlock(&r->lock);
+}
+
+static void do_item(void *arg, size_t item, unsigned worker)
+{
+  Run *r = (Run *)arg;
+  const Item *it = &r->items[item];
+  uint8_t *buf = r->bufs[worker];
+
+  if ( it->large )
+    hash_large(&r->entries[it->first], buf);
+  else
+    hash_batch(r, it, buf);
+  finish(r, it->first, it->count);
+}
+
+/* Setup ------------------------------------------ */
+
+static int cmp_large_items(const void *a, const void *b, void *pv)
+{
+  const DirHash_entry *e = (const DirHash_entry *)pv;
+  uint64_t sa = e[((const Item *)a)->first].size;
+  uint64_t sb = e[((const Item *)b)->first].size;
+  return (sa < sb) - (sa > sb);
+}
+
+static int make_items(Run *r)
+{
+  size_t i, nlarge = 0;
+
+  /* At worst one item per entry */
+  r->items = malloc((r->nentries ? r->nentries : 1) * sizeof(Item));
+  if ( r->items == NULL )
+    return ENOMEM;
+
+  for (i=0; i < r->nentries; i++)
+    if ( r->entries[i].size > DIRHASH_SMALL_MAX )
+    {
+      Item *it = &r->items[r->nitems++];
+      it->first = i;
+      it->count = 1;
+      it->large = 1;
+      nlarge++;
+    }
+  qsort_r(r->items, nlarge, sizeof(Item), cmp_large_items, r->entries);
+
+  /* Runs of consecutive small files, so results stay in order */
+  for (i=0; i < r->nentries; )
+  {
+    Item *it;
+
+    if ( r->entries[i].size > DIRHASH_SMALL_MAX )
+    {
+      i++;
+      continue;
+    }
+    it = &r->items[r->nitems++];
+    it->first = i;
+    it->count = 0;
+    it->large = 0;
+    while ( i < r->nentries && it->count < DIRHASH_BATCH
+            && r->entries[i].size <= DIRHASH_SMALL_MAX )
+    {
+      it->count++;
+      i++;
+    }
+  }
+  return 0;
+}
+
+int DirHash_Run(const char *root, unsigned nthreads, DirHash_fn fn, void *arg)
+{
+  Run r;
+  char *rootcopy = strdup(root);
+  size_t i;
+  int rc;
+
+  memset(&r, 0, sizeof(r));
+  if ( rootcopy == NULL )
+    return ENOMEM;
+  /* Keep output paths tidy when given "dir/" */
+  for (i=strlen(rootcopy); i > 1 && rootcopy[i-1] == '/'; i--)
+    rootcopy[i-1] = 0;
+
+  rc = walk(&r, rootcopy);
+  if ( rc == 0 )
+    rc = make_items(&r);
+  if ( nthreads < 1 )
+    nthreads = 1;
+  if ( rc == 0 )
+  {
+    r.done = calloc(r.nentries ? r.nentries : 1, 1);
+    r.bufs = calloc(nthreads, sizeof(uint8_t *));
+    if ( r.done == NULL || r.bufs == NULL )
+      rc = ENOMEM;
+  }
+  /* Batch slots, plus space to stream a file which outgrew its slot */
+  for (i=0; rc == 0 && i < nthreads; i++)
+    if ( posix_memalign((void **)&r.bufs[i], 4096, DIRHASH_BATCH * SLOT_SIZE + READ_SIZE) != 0 )
+      rc = ENOMEM;
+
+  if ( rc == 0 )
+  {
+    pthread_mutex_init(&r.lock, NULL);
+    r.fn = fn;
+    r.arg = arg;
+    WorkPool_Run(r.nitems, nthreads, do_item, &r);
+    pthread_mutex_destroy(&r.lock);
+  }
+
+  for (i=0; r.bufs != NULL && i < nthreads; i++)
+    free(r.bufs[i]);
+  free(r.bufs);
+  free(r.done);
+  free(r.items);
+  for (i=0; i < r.nentries; i++)
+    free((char *)r.entries[i].path);
+  free(r.entries);
+  return rc;
+}
@@ -0,0 +1,59 @@
+#ifndef DIRHASH_H
+#define DIRHASH_H
+/*
+ * Multi-threaded SHA-256 of every file in a directory tree,
+ * from minicrypt library host tools
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * The tree is walked first, giving a list of regular files in a stable
+ * order: depth first, with each directory's entries sorted by name.
+ * Symbolic links are not followed.
+ *
+ * Small files are then read in batches of up to DIRHASH_BATCH, and each
+ * batch hashed with SHA256Mini_Multi so that the files share SIMD lanes.
+ * Each large file is a work item of its own, hashed in one stream; they
+ * are queued first, biggest first, so that they do not hold up the end
+ * of the run. The items are shared out with a work-stealing pool (see
+ * workpool.h).
+ *
+ * Results are passed to a callback in list order, as soon as all the
+ * files before them are done, so output streams out while hashing goes on.
+ */
+
+#include "sha2_mini.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define DIRHASH_SMALL_MAX  (64*1024)  /* Largest file to put in a batch */
+#define DIRHASH_BATCH      64
+
+typedef struct
+{
+  const char *path;       /* The root given to DirHash_Run, then '/'-separated names */
+  uint64_t size;          /* Bytes hashed */
+  uint8_t hash[SHA256MINI_HASHLEN];
+  int err;                /* errno if the file or directory could not be read, else 0 */
+}
+  DirHash_entry;
+
+typedef void (*DirHash_fn)(void *arg, const DirHash_entry *e);
+/* Called once per file (or unreadable directory), in order, from one
+ * thread at a time */
+
+extern int DirHash_Run(const char *root, unsigned nthreads, DirHash_fn fn, void *arg);
+/* Hashes every regular file under 'root' (which may also be a single
+ * file). Anything that can't be examined or listed, including 'root'
+ * itself, is passed to fn as an entry with 'err' set, and the rest of
+ * the tree is still hashed. Returns 0, or ENOMEM if memory ran out; in
+ * that case no files are hashed. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* DIRHASH_H */
@@ -0,0 +1,603 @@
+/*
+ * Overlapped read/transform/write pipeline from minicrypt library host tools
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define _GNU_SOURCE
+#include "filepipe.h"
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+
+#if defined(__linux__) && defined(__NR_io_uring_setup)
+#include <linux/io_uring.h>
+#define HAVE_IO_URING 1
+#else
+#define HAVE_IO_URING 0
+#endif
+
+#define BUF_ALIGN 4096
+
+enum { SLOT_FREE, SLOT_READING, SLOT_READY, SLOT_WRITING };
+
+typedef struct
+{
+  uint8_t *in;
+  uint8_t *out;
+  size_t inLen, inDone;
+  size_t outLen, outDone;
+  uint64_t chunk;
+  int state;
+}
+  Slot;
+
+typedef struct
+{
+  int infd, outfd;
+  size_t inChunk, outChunk;
+  unsigned depth;
+  uint64_t insize;
+  uint64_t nchunks;
+  uint64_t nextRead;   /* Next chunk to start reading */
+  uint64_t nextXform;  /* Next chunk to hand to the transform */
+  uint64_t written;    /* Count of chunks completely written */
+  MCResult rc;
+  Slot slots[FILEPIPE_MAX_DEPTH];
+  FilePipe_fn fn;
+  void *arg;
+}
+  Pipe;
+
+static const char *lastMode = "none";
+
+const char *FilePipe_LastIOMode(void)
+{
+  return lastMode;
+}
+
+/* ---------------------------------------------- */
+
+static Slot *slot_for(Pipe *p, uint64_t chunk)
+{
+  return &p->slots[chunk % p->depth];
+}
+
+static void slot_begin_read(Pipe *p, Slot *s, uint64_t chunk)
+{
+  uint64_t off = chunk * p->inChunk;
+  uint64_t left = p->insize - off;
+
+  s->chunk = chunk;
+  s->inLen = (left < p->inChunk) ? (size_t)left : p->inChunk;
+  s->inDone = 0;
+  s->state = SLOT_READING;
+}
+
+static MCResult slot_transform(Pipe *p, Slot *s)
+{
+  MCResult rc;
+  size_t outLen = p->outChunk;
+
+  rc = p->fn(p->arg, s->in, s->inLen, s->out, &outLen);
+  if ( rc != MC_OK )
+    return rc;
+  if ( outLen > p->outChunk || (outLen < p->outChunk && s->chunk+1 != p->nchunks) )
+    return MC_BAD_LENGTH;
+  s->outLen = outLen;
+  s->outDone = 0;
+  s->state = SLOT_WRITING;
+  return MC_OK;
+}
+
+/* io_uring engine -------------------------------- */
+
+#if HAVE_IO_URING
+
+typedef struct
+{
+  int fd;
+  unsigned *sq_head, *sq_tail, *sq_mask, *sq_array;
+  unsigned *cq_head, *cq_tail, *cq_mask;
+  struct io_uring_sqe *sqes;
+  struct io_uring_cqe *cqes;
+  void *sq_ptr, *cq_ptr;
+  size_t sq_sz, cq_sz, sqes_sz;
+  unsigned queued;  /* SQEs filled in but not yet passed to the kernel */
+  unsigned inflight; /* SQEs filled in and not yet completed */
+  int fixed;        /* Buffers are registered */
+}
+  Ring;
+
+#define UD_WRITE  0x80000000u
+#define PROBE_OPS 256
+
+/* Kernels 5.1 to 5.5 have io_uring but not IORING_OP_READ/WRITE, and
+   fail them with -EINVAL. They lack IORING_REGISTER_PROBE too, so a
+   failed probe also means falling back to the thread engine. */
+static int ring_ops_supported(int fd)
+{
+  static const uint8_t need[] =
+    { IORING_OP_READ, IORING_OP_WRITE, IORING_OP_READ_FIXED, IORING_OP_WRITE_FIXED };
+  struct io_uring_probe *pr;
+  unsigned i;
+  int ok;
+
+  pr = (struct io_uring_probe *)calloc(1, sizeof(*pr) + PROBE_OPS * sizeof(struct io_uring_probe_op));
+  if ( pr == NULL )
+    return 0;
+  ok = syscall(__NR_io_uring_register, fd, IORING_REGISTER_PROBE, pr, PROBE_OPS) == 0;
+  for (i=0; ok && i < sizeof(need); i++)
+    if ( need[i] > pr->last_op || !(pr->ops[need[i]].flags & IO_URING_OP_SUPPORTED) )
+      ok = 0;
+  free(pr);
+  return ok;
+}
+
+static int ring_setup(Ring *r, unsigned entries)
+{
+  struct io_uring_params prm;
+  uint8_t *sq, *cq;
+
+  memset(r, 0, sizeof(*r));
+  memset(&prm, 0, sizeof(prm));
+  r->fd = (int) syscall(__NR_io_uring_setup, entries, &prm);
+  if ( r->fd < 0 )
+    return 0;
+  if ( !ring_ops_supported(r->fd) )
+    goto fail_fd;
+
+  r->sq_sz = prm.sq_off.array + prm.sq_entries * sizeof(unsigned);
+  r->cq_sz = prm.cq_off.cqes + prm.cq_entries * sizeof(struct io_uring_cqe);
+  if ( prm.features & IORING_FEAT_SINGLE_MMAP )
+  {
+    if ( r->cq_sz > r->sq_sz )
+      r->sq_sz = r->cq_sz;
+    r->cq_sz = 0;
+  }
+
+  r->sq_ptr = mmap(NULL, r->sq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                   r->fd, IORING_OFF_SQ_RING);
+  if ( r->sq_ptr == MAP_FAILED )
+    goto fail_fd;
+
+  if ( r->cq_sz == 0 )
+    r->cq_ptr = r->sq_ptr;
+  else
+  {
+    r->cq_ptr = mmap(NULL, r->cq_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                     r->fd, IORING_OFF_CQ_RING);
+    if ( r->cq_ptr == MAP_FAILED )
+      goto fail_sq;
+  }
+
+  r->sqes_sz = prm.sq_entries * sizeof(struct io_uring_sqe);
+  r->sqes = mmap(NULL, r->sqes_sz, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_POPULATE,
+                 r->fd, IORING_OFF_SQES);
+  if ( r->sqes == MAP_FAILED )
+    goto fail_cq;
+
+  sq = (uint8_t *)r->sq_ptr;
+  cq = (uint8_t *)r->cq_ptr;
+  r->sq_head  = (unsigned *)(sq + prm.sq_off.head);
+  r->sq_tail  = (unsigned *)(sq + prm.sq_off.tail);
+  r->sq_mask  = (unsigned *)(sq + prm.sq_off.ring_mask);
+  r->sq_array = (unsigned *)(sq + prm.sq_off.array);
+  r->cq_head  = (unsigned *)(cq + prm.cq_off.head);
+  r->cq_tail  = (unsigned *)(cq + prm.cq_off.tail);
+  r->cq_mask  = (unsigned *)(cq + prm.cq_off.ring_mask);
+  r->cqes     = (struct io_uring_cqe *)(cq + prm.cq_off.cqes);
+  return 1;
+
+fail_cq:
+  if ( r->cq_sz )
+    munmap(r->cq_ptr, r->cq_sz);
+fail_sq:
+  munmap(r->sq_ptr, r->sq_sz);
+fail_fd:
+  close(r->fd);
+  return 0;
+}
+
+static void ring_teardown(Ring *r)
+{
+  munmap(r->sqes, r->sqes_sz);
+  if ( r->cq_sz )
+    munmap(r->cq_ptr, r->cq_sz);
+  munmap(r->sq_ptr, r->sq_sz);
+  close(r->fd);
+}
+
+static void ring_register(Ring *r, Pipe *p)
+{
+  struct iovec iov[2*FILEPIPE_MAX_DEPTH];
+  unsigned i;
+
+  for (i=0; i < p->depth; i++)
+  {
+    iov[2*i].iov_base = p->slots[i].in;
+    iov[2*i].iov_len = p->inChunk;
+    iov[2*i+1].iov_base = p->slots[i].out;
+    iov[2*i+1].iov_len = p->outChunk;
+  }
+  /* May fail if RLIMIT_MEMLOCK is small; plain reads/writes still work */
+  r->fixed = syscall(__NR_io_uring_register, r->fd, IORING_REGISTER_BUFFERS,
+                     iov, 2*p->depth) == 0;
+}
+
+static void ring_queue(Ring *r, Pipe *p, Slot *s, int isWrite)
+{
+  unsigned tail = *r->sq_tail;
+  unsigned idx = tail & *r->sq_mask;
+  struct io_uring_sqe *sqe = &r->sqes[idx];
+  unsigned sidx = (unsigned)(s - p->slots);
+
+  memset(sqe, 0, sizeof(*sqe));
+  if ( isWrite )
+  {
+    sqe->opcode = r->fixed ? IORING_OP_WRITE_FIXED : IORING_OP_WRITE;
+    sqe->fd = p->outfd;
+    sqe->addr = (uint64_t)(uintptr_t)(s->out + s->outDone);
+    sqe->len = (uint32_t)(s->outLen - s->outDone);
+    sqe->off = s->chunk * p->outChunk + s->outDone;
+    sqe->buf_index = (uint16_t)(2*sidx + 1);
+    sqe->user_data = sidx | UD_WRITE;
+  }
+  else
+  {
+    sqe->opcode = r->fixed ? IORING_OP_READ_FIXED : IORING_OP_READ;
+    sqe->fd = p->infd;
+    sqe->addr = (uint64_t)(uintptr_t)(s->in + s->inDone);
+    sqe->len = (uint32_t)(s->inLen - s->inDone);
+    sqe->off = s->chunk * p->inChunk + s->inDone;
+    sqe->buf_index = (uint16_t)(2*sidx);
+    sqe->user_data = sidx;
+  }
+  r->sq_array[idx] = idx;
+  __atomic_store_n(r->sq_tail, tail+1, __ATOMIC_RELEASE);
+  r->queued++;
+  r->inflight++;
+}
+
+static void ring_start_reads(Ring *r, Pipe *p)
+{
+  while ( p->nextRead < p->nchunks && slot_for(p, p->nextRead)->state == SLOT_FREE )
+  {
+    Slot *s = slot_for(p, p->nextRead);
+    slot_begin_read(p, s, p->nextRead++);
+    ring_queue(r, p, s, 0);
+  }
+}
+
+static int ring_enter(Ring *r, unsigned minComplete)
+{
+  int rv;
+  do
+  {
+    rv = (int) syscall(__NR_io_uring_enter, r->fd, r->queued, minComplete,
+                       minComplete ? IORING_ENTER_GETEVENTS : 0, NULL, 0);
+  }
+  while ( rv < 0 && errno == EINTR );
+  if ( rv < 0 )
+    return 0;
+  r->queued -= (unsigned)rv;
+  return 1;
+}
+
+static void ring_reap(Ring *r, Pipe *p)
+{
+  unsigned head = *r->cq_head;
+
+  while ( head != __atomic_load_n(r->cq_tail, __ATOMIC_ACQUIRE) )
+  {
+    struct io_uring_cqe *cqe = &r->cqes[head & *r->cq_mask];
+    Slot *s = &p->slots[cqe->user_data & ~UD_WRITE];
+    int isWrite = (cqe->user_data & UD_WRITE) != 0;
+    int res = cqe->res;
+
+    head++;
+    __atomic_store_n(r->cq_head, head, __ATOMIC_RELEASE);
+    r->inflight--;
+
+    if ( res < 0 )
+      p->rc = MC_IO_ERROR;
+    else if ( res == 0 )
+    {
+      /* Unexpected EOF: the input file shrank under us */
+      p->rc = MC_BAD_LENGTH;
+    }
+    if ( p->rc != MC_OK )
+      continue;
+
+    if ( isWrite )
+    {
+      s->outDone += (size_t)res;
+      if ( s->outDone < s->outLen )
+        ring_queue(r, p, s, 1);
+      else
+      {
+        s->state = SLOT_FREE;
+        p->written++;
+      }
+    }
+    else
+    {
+      s->inDone += (size_t)res;
+      if ( s->inDone < s->inLen )
+        ring_queue(r, p, s, 0);
+      else
+        s->state = SLOT_READY;
+    }
+  }
+  if ( p->rc == MC_OK )
+    ring_start_reads(r, p);
+}
+
+static int run_uring(Pipe *p)
+{
+  Ring r;
+
+  if ( !ring_setup(&r, 2*p->depth) )
+    return 0;
+  ring_register(&r, p);
+  lastMode = "io_uring";
+
+  ring_start_reads(&r, p);
+  while ( p->rc == MC_OK && p->written < p->nchunks )
+  {
+    if ( p->nextXform < p->nchunks && slot_for(p, p->nextXform)->state == SLOT_READY )
+    {
+      /* Hand new I/O to the kernel before burning CPU on this chunk */
+      if ( r.queued && !ring_enter(&r, 0) )
+        p->rc = MC_IO_ERROR;
+      else
+      {
+        Slot *s = slot_for(p, p->nextXform++);
+        p->rc = slot_transform(p, s);
+        if ( p->rc == MC_OK && s->outLen == 0 )
+        {
+          /* Nothing to write; a zero-length write would look like an error */
+          s->state = SLOT_FREE;
+          p->written++;
+        }
+        else if ( p->rc == MC_OK )
+          ring_queue(&r, p, s, 1);
+      }
+    }
+    else if ( !ring_enter(&r, 1) )
+      p->rc = MC_IO_ERROR;
+    ring_reap(&r, p);
+  }
+
+  /* On error, wait for whatever the kernel still owns before
+     the buffers go away */
+  while ( r.inflight > 0 && ring_enter(&r, 1) )
+    ring_reap(&r, p);
+
+  ring_teardown(&r);
+  return 1;
+}
+
+#else
+
+static int run_uring(Pipe *p)
+{
+  (void)p;
+  return 0;
+}
+
+#endif /* HAVE_IO_URING */
+
+/* Thread engine ---------------------------------- */
+
+typedef struct
+{
+  Pipe *p;
+  pthread_mutex_t lock;
+  pthread_cond_t cond;
+  int stop;
+}
+  ThreadCtl;
+
+static MCResult pread_full(int fd, uint8_t *buf, size_t len, uint64_t off)
+{
+  while ( len > 0 )
+  {
+    ssize_t n = pread(fd, buf, len, (off_t)off);
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n < 0 )
+      return MC_IO_ERROR;
+    if ( n == 0 )
+      return MC_BAD_LENGTH;  /* The input file shrank under us */
+    buf += n;
+    len -= (size_t)n;
+    off += (uint64_t)n;
+  }
+  return MC_OK;
+}
+
+static MCResult pwrite_full(int fd, const uint8_t *buf, size_t len, uint64_t off)
+{
+  while ( len > 0 )
+  {
+    ssize_t n = pwrite(fd, buf, len, (off_t)off);
+    if ( n < 0 && errno == EINTR )
+      continue;
+    if ( n <= 0 )
+      return MC_IO_ERROR;
+    buf += n;
+    len -= (size_t)n;
+    off += (uint64_t)n;
+  }
+  return MC_OK;
+}
+
+static void *io_thread(void *varg)
+{
+  ThreadCtl *tc = (ThreadCtl *)varg;
+  Pipe *p = tc->p;
+
+  pthread_mutex_lock(&tc->lock);
+  while ( !tc->stop && p->written < p->nchunks )
+  {
+    Slot *s = NULL;
+    unsigned i;
+    MCResult rc;
+
+    /* Writes first: they release slots for further reads */
+    for (i=0; i < p->depth; i++)
+      if ( p->slots[i].state == SLOT_WRITING )
+      {
+        s = &p->slots[i];
+        break;
+      }
+
+    if ( s != NULL )
+    {
+      pthread_mutex_unlock(&tc->lock);
+      rc = pwrite_full(p->outfd, s->out, s->outLen, s->chunk * p->outChunk);
+      pthread_mutex_lock(&tc->lock);
+      s->state = SLOT_FREE;
+      p->written++;
+    }
+    else if ( p->nextRead < p->nchunks && slot_for(p, p->nextRead)->state == SLOT_FREE )
+    {
+      s = slot_for(p, p->nextRead);
+      slot_begin_read(p, s, p->nextRead++);
+      pthread_mutex_unlock(&tc->lock);
+      rc = pread_full(p->infd, s->in, s->inLen, s->chunk * p->inChunk);
+      pthread_mutex_lock(&tc->lock);
+      s->state = SLOT_READY;
+    }
+    else
+    {
+      pthread_cond_wait(&tc->cond, &tc->lock);
+      continue;
+    }
+
+    if ( rc != MC_OK && p->rc == MC_OK )
+    {
+      p->rc = rc;
+      tc->stop = 1;
+    }
+    pthread_cond_broadcast(&tc->cond);
+  }
+  pthread_mutex_unlock(&tc->lock);
+  return NULL;
+}
+
+static int run_thread(Pipe *p)
+{
+  ThreadCtl tc;
+  pthread_t tid;
+
+  tc.p = p;
+  tc.stop = 0;
+  pthread_mutex_init(&tc.lock, NULL);
+  pthread_cond_init(&tc.cond, NULL);
+  if ( pthread_create(&tid, NULL, io_thread, &tc) != 0 )
+    return 0;
+  lastMode = "thread";
+
+  pthread_mutex_lock(&tc.lock);
+  while ( !tc.stop && p->nextXform < p->nchunks )
+  {
+    Slot *s = slot_for(p, p->nextXform);
+    MCResult rc;
+
+    if ( s->state != SLOT_READY )
+    {
+      pthread_cond_wait(&tc.cond, &tc.lock);
+      continue;
+    }
+    pthread_mutex_unlock(&tc.lock);
+    rc = slot_transform(p, s);
+    pthread_mutex_lock(&tc.lock);
+    if ( rc != MC_OK )
+    {
+      if ( p->rc == MC_OK )
+        p->rc = rc;
+      tc.stop = 1;
+    }
+    p->nextXform++;
+    pthread_cond_broadcast(&tc.cond);
+  }
+  pthread_mutex_unlock(&tc.lock);
+
+  pthread_join(tid, NULL);
+  pthread_cond_destroy(&tc.cond);
+  pthread_mutex_destroy(&tc.lock);
+  return 1;
+}
+
+/* ---------------------------------------------- */
+
+MCResult FilePipe_Run(int infd, int outfd,
+    size_t inChunk, size_t outChunk, unsigned depth, int ioMode,
+    FilePipe_fn fn, void *arg)
+{
+  Pipe *p;
+  struct stat st;
+  uint8_t *bufs;
+  size_t inSz, outSz;
+  unsigned i;
+  MCResult rc;
+
+  if ( depth == 0 )
+    depth = FILEPIPE_DEFAULT_DEPTH;
+  if ( depth > FILEPIPE_MAX_DEPTH || inChunk == 0 || outChunk == 0
+       || inChunk > 0x7FFFF000 || outChunk > 0x7FFFF000 )
+    return MC_BAD_PARAMS;
+  if ( fstat(infd, &st) != 0 || !S_ISREG(st.st_mode) )
+    return MC_BAD_PARAMS;
+
+  p = (Pipe *)calloc(1, sizeof(Pipe));
+  if ( p == NULL )
+    return MC_BAD_PARAMS;
+
+  inSz = (inChunk + BUF_ALIGN - 1) & ~(size_t)(BUF_ALIGN-1);
+  outSz = (outChunk + BUF_ALIGN - 1) & ~(size_t)(BUF_ALIGN-1);
+  if ( posix_memalign((void **)&bufs, BUF_ALIGN, depth * (inSz + outSz)) != 0 )
+  {
+    free(p);
+    return MC_BAD_PARAMS;
+  }
+
+  p->infd = infd;
+  p->outfd = outfd;
+  p->inChunk = inChunk;
+  p->outChunk = outChunk;
+  p->depth = depth;
+  p->insize = (uint64_t)st.st_size;
+  p->nchunks = (p->insize + inChunk - 1) / inChunk;
+  p->fn = fn;
+  p->arg = arg;
+  p->rc = MC_OK;
+  for (i=0; i < depth; i++)
+  {
+    p->slots[i].in = bufs + i * (inSz + outSz);
+    p->slots[i].out = p->slots[i].in + inSz;
+    p->slots[i].state = SLOT_FREE;
+  }
+
+  if ( ioMode == FILEPIPE_IO_THREAD || !run_uring(p) )
+  {
+    if ( !run_thread(p) )
+      p->rc = MC_BAD_PARAMS;
+  }
+
+  rc = p->rc;
+  free(bufs);
+  free(p);
+  return rc;
+}
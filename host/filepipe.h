@@ -0,0 +1,60 @@
+#ifndef FILEPIPE_H
+#define FILEPIPE_H
+/*
+ * Overlapped read/transform/write pipeline for bulk file processing,
+ * from minicrypt library host tools
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * The input file is split into fixed-size chunks. Chunk i is read from
+ * offset i*inChunk, passed to the transform callback, and the result is
+ * written at offset i*outChunk in the output file. Up to 'depth' chunks
+ * are in flight at once, so the next chunks are being read and the
+ * previous ones written while the callback runs.
+ *
+ * I/O is done with io_uring where the kernel allows it (5.6 or later,
+ * which has the plain read and write ops), using buffers registered
+ * once at startup. Otherwise a single I/O thread does pread()/pwrite()
+ * on the same buffers. Either way, all buffers are
+ * allocated in FilePipe_Run() and no allocation happens per chunk.
+ */
+
+#include "minicrypt.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef MCResult (*FilePipe_fn)(void *arg, const uint8_t *in, size_t inLen,
+                                uint8_t *out, size_t *outLen);
+/* Transforms one chunk. On entry *outLen is the size of the 'out'
+ * buffer (outChunk); on exit it must hold the number of bytes to write.
+ * Only the last chunk may produce less than outChunk bytes.
+ * Always called from the thread which called FilePipe_Run(), in chunk order.
+ */
+
+#define FILEPIPE_DEFAULT_DEPTH  4
+#define FILEPIPE_MAX_DEPTH      64
+
+#define FILEPIPE_IO_AUTO        0  /* io_uring if available, else thread */
+#define FILEPIPE_IO_THREAD      1  /* Always use the pread/pwrite thread */
+
+extern MCResult FilePipe_Run(int infd, int outfd,
+    size_t inChunk, size_t outChunk, unsigned depth, int ioMode,
+    FilePipe_fn fn, void *arg);
+/* Processes the whole of 'infd' (which must be a regular file) into 'outfd'.
+ * Returns MC_BAD_PARAMS if the files or sizes are unusable, MC_IO_ERROR
+ * if a read or write fails, MC_BAD_LENGTH if the input file shrinks while
+ * being read, or the first error returned by 'fn'.
+ */
+
+extern const char *FilePipe_LastIOMode(void);
+/* Returns "io_uring" or "thread" according to what the last call used */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* FILEPIPE_H */
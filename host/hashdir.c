@@ -0,0 +1,99 @@
+/*
+ * SHA-256 of every file in directory trees, from minicrypt library host tools
+ *
+ * Usage: hashdir [-j threads] [-t] <dir|file>...
+ *
+ * Prints "<hash>  <path>" for every regular file, in the layout of
+ * sha256sum (so the output can be checked with sha256sum -c), and in
+ * the same order on every run; see dirhash.h. With -t, the number of
+ * files, bytes and throughput are printed on stderr at the end.
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "dirhash.h"
+#include "workpool.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+typedef struct
+{
+  uint64_t files, bytes;
+  int failed;
+}
+  Totals;
+
+static void print_entry(void *arg, const DirHash_entry *e)
+{
+  Totals *t = (Totals *)arg;
+  int i;
+
+  if ( e->err != 0 )
+  {
+    fprintf(stderr, "hashdir: %s: %s\n", e->path, strerror(e->err));
+    t->failed = 1;
+    return;
+  }
+  for (i=0; i < SHA256MINI_HASHLEN; i++)
+    printf("%02x", e->hash[i]);
+  printf("  %s\n", e->path);
+  t->files++;
+  t->bytes += e->size;
+}
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+int main(int argc, char **argv)
+{
+  Totals t;
+  unsigned nthreads = WorkPool_DefaultThreads();
+  int opt, timing = 0, i;
+  double start = now();
+
+  while ( (opt = getopt(argc, argv, "j:t")) != -1 )
+  {
+    switch (opt)
+    {
+      case 'j': nthreads = (unsigned) atoi(optarg); break;
+      case 't': timing = 1; break;
+      default: optind = argc + 1;
+    }
+  }
+  if ( optind >= argc || nthreads == 0 )
+  {
+    fprintf(stderr, "Usage: hashdir [-j threads] [-t] <dir|file>...\n");
+    return 2;
+  }
+
+  memset(&t, 0, sizeof(t));
+  for (i=optind; i < argc; i++)
+  {
+    int rc = DirHash_Run(argv[i], nthreads, print_entry, &t);
+    if ( rc != 0 )
+    {
+      fprintf(stderr, "hashdir: %s: %s\n", argv[i], strerror(rc));
+      t.failed = 1;
+    }
+  }
+
+  if ( timing )
+  {
+    double secs = now() - start;
+    fprintf(stderr, "%llu files, %llu bytes in %.3f s: %.0f files/s, %.1f MB/s, %u threads\n",
+            (unsigned long long)t.files, (unsigned long long)t.bytes, secs,
+            secs > 0 ? t.files / secs : 0.0, secs > 0 ? t.bytes / secs / 1e6 : 0.0,
+            nthreads);
+  }
+  return t.failed;
+}
@@ -0,0 +1,338 @@
+/*
+ * sha256sum-compatible file hashing, from minicrypt library host tools
+ *
+ * Usage: mcsha256sum [-j threads] [-t] [files...]
+ *        mcsha256sum -c [-j threads] [-t] [checkfiles...]
+ *
+ * Prints "<hash>  <name>" for each file, in the order given, as sha256sum
+ * does; each line is printed as soon as that file and all those before
+ * it are done. No files or "-" means standard input. With -c, reads such lines
+ * and reports "<name>: OK" or "<name>: FAILED" for each, exiting with 1
+ * if any failed. With -t, the size, time and throughput for each file and
+ * the total are printed on stderr.
+ *
+ * Regular files are mapped into memory with MADV_SEQUENTIAL, so the
+ * kernel reads ahead while hashing; pipes and the like are read in large
+ * page-aligned blocks instead. Files are spread across threads, one per
+ * CPU by default.
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "sha2_mini.h"
+#include "workpool.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define READ_SIZE  (1024*1024)
+#define READ_ALIGN 4096
+#define MMAP_MIN   (64*1024)   /* Smaller files are quicker to just read */
+
+typedef struct
+{
+  const char *name;
+  uint8_t expect[SHA256MINI_HASHLEN];  /* For -c */
+  uint8_t hash[SHA256MINI_HASHLEN];
+  uint64_t bytes;
+  double seconds;
+  int err;                             /* errno, or 0 */
+}
+  FileJob;
+
+typedef struct
+{
+  FileJob *files;
+  size_t nfiles;
+  uint8_t **bufs;                      /* One read buffer per thread */
+  int check, timing;
+
+  pthread_mutex_t lock;                /* Protects the rest */
+  uint8_t *done;
+  size_t next;                         /* Next file to report */
+  uint64_t total;
+  int failed;
+}
+  Batch;
+
+static double now(void)
+{
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static int hash_read(int fd, uint8_t *buf, SHA256Mini_ctx *ctx, uint64_t *bytes)
+{
+  for (;;)
+  {
+    ssize_t n = read(fd, buf, READ_SIZE);
+    if ( n == 0 )
+      return 0;
+    if ( n < 0 )
+    {
+      if ( errno == EINTR )
+        continue;
+      return errno;
+    }
+    SHA256Mini_Update(ctx, buf, (size_t)n);
+    *bytes += (uint64_t)n;
+  }
+}
+
+static int hash_mapped(int fd, size_t len, SHA256Mini_ctx *ctx, uint64_t *bytes)
+{
+  void *map = mmap(NULL, len, PROT_READ, MAP_PRIVATE, fd, 0);
+
+  if ( map == MAP_FAILED )
+    return errno;
+  madvise(map, len, MADV_SEQUENTIAL);
+  SHA256Mini_Update(ctx, map, len);
+  munmap(map, len);
+  *bytes = len;
+  return 0;
+}
+
+static void report(Batch *b, const FileJob *f)
+{
+  if ( f->err != 0 )
+  {
+    fprintf(stderr, "mcsha256sum: %s: %s\n", f->name, strerror(f->err));
+    if ( b->check )
+      printf("%s: FAILED open or read\n", f->name);
+    b->failed = 1;
+    return;
+  }
+  b->total += f->bytes;
+  if ( b->check )
+  {
+    int ok = (memcmp(f->hash, f->expect, SHA256MINI_HASHLEN) == 0);
+    printf("%s: %s\n", f->name, ok ? "OK" : "FAILED");
+    if ( !ok )
+      b->failed = 1;
+  }
+  else
+  {
+    int j;
+    for (j=0; j < SHA256MINI_HASHLEN; j++)
+      printf("%02x", f->hash[j]);
+    printf("  %s\n", f->name);
+  }
+  if ( b->timing )
+    fprintf(stderr, "%s: %llu bytes in %.3f s, %.1f MB/s\n", f->name,
+            (unsigned long long)f->bytes, f->seconds,
+            f->seconds > 0 ? f->bytes / f->seconds / 1e6 : 0.0);
+}
+
+/* Marks a file done, and reports all those now ready in order */
+static void finish(Batch *b, size_t item)
+{
+  pthread_mutex_lock(&b->lock);
+  b->done[item] = 1;
+  if ( b->next == item )
+  {
+    while ( b->next < b->nfiles && b->done[b->next] )
+      report(b, &b->files[b->next++]);
+    fflush(stdout);
+  }
+  pthread_mutex_unlock(&b->lock);
+}
+
+static void hash_file(void *arg, size_t item, unsigned worker)
+{
+  Batch *b = (Batch *)arg;
+  FileJob *f = &b->files[item];
+  SHA256Mini_ctx ctx;
+  struct stat st;
+  double start = now();
+  int fd;
+
+  if ( strcmp(f->name, "-") == 0 )
+    fd = STDIN_FILENO;
+  else
+    fd = open(f->name, O_RDONLY);
+  if ( fd < 0 )
+  {
+    f->err = errno;
+    finish(b, item);
+    return;
+  }
+
+  SHA256Mini_Init(&ctx);
+  f->bytes = 0;
+  if ( fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size >= MMAP_MIN
+       && (uint64_t)st.st_size == (size_t)st.st_size )
+    f->err = hash_mapped(fd, (size_t)st.st_size, &ctx, &f->bytes);
+  else
+    f->err = hash_read(fd, b->bufs[worker], &ctx, &f->bytes);
+  if ( fd != STDIN_FILENO )
+    close(fd);
+
+  SHA256Mini_Final(&ctx, f->hash);
+  f->seconds = now() - start;
+  finish(b, item);
+}
+
+static int parse_hex(const char *hex, uint8_t *out)
+{
+  int i;
+  for (i=0; i < SHA256MINI_HASHLEN; i++)
+  {
+    unsigned v;
+    if ( sscanf(hex + 2*i, "%2x", &v) != 1 )
+      return 0;
+    out[i] = (uint8_t)v;
+  }
+  return 1;
+}
+
+/* Appends the jobs listed in a -c file. Lines are "<64 hex>  <name>",
+   or "<64 hex> *<name>" for binary mode, which is the same here. */
+static int read_checkfile(const char *name, FileJob **files, size_t *nfiles)
+{
+  FILE *fp = strcmp(name, "-") ? fopen(name, "r") : stdin;
+  char line[4096];
+  int bad = 0;
+
+  if ( fp == NULL )
+  {
+    perror(name);
+    return -1;
+  }
+  while ( fgets(line, sizeof(line), fp) != NULL )
+  {
+    size_t len = strcspn(line, "\r\n");
+    FileJob *f, *grown;
+
+    line[len] = 0;
+    if ( len < 2*SHA256MINI_HASHLEN + 2 || line[2*SHA256MINI_HASHLEN] != ' '
+         || (line[2*SHA256MINI_HASHLEN+1] != ' ' && line[2*SHA256MINI_HASHLEN+1] != '*') )
+    {
+      bad++;
+      continue;
+    }
+    grown = realloc(*files, (*nfiles + 1) * sizeof(FileJob));
+    if ( grown == NULL )
+    {
+      /* *files is still valid, and left for the caller */
+      fprintf(stderr, "mcsha256sum: out of memory\n");
+      if ( fp != stdin )
+        fclose(fp);
+      return -1;
+    }
+    *files = grown;
+    f = &(*files)[*nfiles];
+    memset(f, 0, sizeof(*f));
+    if ( !parse_hex(line, f->expect) || (f->name = strdup(line + 2*SHA256MINI_HASHLEN + 2)) == NULL )
+    {
+      bad++;
+      continue;
+    }
+    (*nfiles)++;
+  }
+  if ( fp != stdin )
+    fclose(fp);
+  if ( bad )
+    fprintf(stderr, "mcsha256sum: %s: %d improperly formatted lines\n", name, bad);
+  return 0;
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "Usage: mcsha256sum [-c] [-j threads] [-t] [files...]\n"
+                  "  -c  check hashes listed in the files\n"
+                  "  -j  number of threads (default: one per CPU)\n"
+                  "  -t  print throughput on stderr\n");
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  static const char *const stdin_name[] = { "-" };
+  const char *const *names;
+  FileJob *files = NULL;
+  size_t nfiles = 0, nnames, i;
+  unsigned nthreads = WorkPool_DefaultThreads();
+  int opt, check = 0, timing = 0;
+  double start;
+  Batch b;
+
+  while ( (opt = getopt(argc, argv, "cj:t")) != -1 )
+  {
+    switch (opt)
+    {
+      case 'c': check = 1; break;
+      case 'j': nthreads = (unsigned) atoi(optarg); break;
+      case 't': timing = 1; break;
+      default: usage();
+    }
+  }
+  if ( nthreads == 0 )
+    usage();
+  names = (optind < argc) ? (const char *const *)argv + optind : stdin_name;
+  nnames = (optind < argc) ? (size_t)(argc - optind) : 1;
+
+  if ( check )
+  {
+    for (i=0; i < nnames; i++)
+      if ( read_checkfile(names[i], &files, &nfiles) != 0 )
+        return 1;
+  }
+  else
+  {
+    files = calloc(nnames, sizeof(FileJob));
+    if ( files == NULL )
+      return 1;
+    for (i=0; i < nnames; i++)
+      files[i].name = names[i];
+    nfiles = nnames;
+  }
+
+  if ( nthreads > nfiles )
+    nthreads = (nfiles > 0) ? (unsigned)nfiles : 1;
+  memset(&b, 0, sizeof(b));
+  b.files = files;
+  b.nfiles = nfiles;
+  b.check = check;
+  b.timing = timing;
+  b.done = calloc(nfiles ? nfiles : 1, 1);
+  b.bufs = b.done ? calloc(nthreads, sizeof(uint8_t *)) : NULL;
+  for (i=0; b.bufs != NULL && i < nthreads; i++)
+    if ( posix_memalign((void **)&b.bufs[i], READ_ALIGN, READ_SIZE) != 0 )
+    {
+      while ( i > 0 )
+        free(b.bufs[--i]);
+      free(b.bufs);
+      b.bufs = NULL;
+    }
+  if ( b.bufs == NULL )
+  {
+    free(b.done);
+    fprintf(stderr, "mcsha256sum: out of memory\n");
+    return 1;
+  }
+
+  start = now();
+  pthread_mutex_init(&b.lock, NULL);
+  WorkPool_Run(nfiles, nthreads, hash_file, &b);
+  pthread_mutex_destroy(&b.lock);
+
+  if ( timing )
+  {
+    double secs = now() - start;
+    fprintf(stderr, "total: %lu files, %llu bytes in %.3f s, %.1f MB/s, %u threads\n",
+            (unsigned long)nfiles, (unsigned long long)b.total, secs,
+            secs > 0 ? b.total / secs / 1e6 : 0.0, nthreads);
+  }
+  return b.failed;
+}
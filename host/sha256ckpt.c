@@ -0,0 +1,141 @@
+/*
+ * Incremental SHA-256 of a growing file, from minicrypt library host tools
+ *
+ * Usage: sha256ckpt [-r] <file> <checkpointfile>
+ *
+ * Prints the SHA-256 of <file> in the same format as sha256sum. The hash
+ * state at the end of the file is saved in <checkpointfile> (see
+ * SHA256Mini_Export), and the next run only reads what has been appended
+ * since. The file is assumed to be append-only: if it has been changed
+ * rather than appended to, the checkpoint gives the wrong answer, so
+ * use -r to ignore the checkpoint and hash from the start. A file
+ * which has shrunk is always hashed from the start.
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "sha2_mini.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+
+#define READ_SIZE (1024*1024)
+
+static int load_checkpoint(const char *name, SHA256Mini_ctx *ctx)
+{
+  uint8_t buf[SHA256MINI_EXPORT_MAXLEN + 1];
+  size_t n;
+  FILE *f = fopen(name, "rb");
+
+  if ( f == NULL )
+    return 0;
+  n = fread(buf, 1, sizeof(buf), f);
+  fclose(f);
+  if ( SHA256Mini_Import(ctx, buf, n) != MC_OK )
+  {
+    fprintf(stderr, "sha256ckpt: %s: not a valid checkpoint, ignoring it\n", name);
+    return 0;
+  }
+  return 1;
+}
+
+/* Written to a temporary file and renamed, so a crash never leaves a
+   half-written checkpoint */
+static int save_checkpoint(const char *name, const SHA256Mini_ctx *ctx)
+{
+  uint8_t buf[SHA256MINI_EXPORT_MAXLEN];
+  size_t n = SHA256Mini_Export(ctx, buf);
+  char *tmp = malloc(strlen(name) + 8);
+  int fd, ok;
+
+  if ( tmp == NULL )
+    return 0;
+  sprintf(tmp, "%s.new", name);
+  fd = open(tmp, O_WRONLY|O_CREAT|O_TRUNC, 0644);
+  ok = ( fd >= 0 && write(fd, buf, n) == (ssize_t)n && fsync(fd) == 0 );
+  if ( fd >= 0 && close(fd) != 0 )
+    ok = 0;
+  if ( ok && rename(tmp, name) != 0 )
+    ok = 0;
+  if ( !ok )
+  {
+    perror(tmp);
+    unlink(tmp);
+  }
+  free(tmp);
+  return ok;
+}
+
+int main(int argc, char **argv)
+{
+  SHA256Mini_ctx ctx, fin;
+  uint8_t digest[SHA256MINI_HASHLEN];
+  uint8_t *buf;
+  struct stat st;
+  int opt, fd, i, rehash = 0;
+  ssize_t n;
+
+  while ( (opt = getopt(argc, argv, "r")) != -1 )
+  {
+    if ( opt == 'r' )
+      rehash = 1;
+    else
+    {
+      fprintf(stderr, "Usage: sha256ckpt [-r] <file> <checkpointfile>\n");
+      return 2;
+    }
+  }
+  if ( argc - optind != 2 )
+  {
+    fprintf(stderr, "Usage: sha256ckpt [-r] <file> <checkpointfile>\n");
+    return 2;
+  }
+
+  fd = open(argv[optind], O_RDONLY);
+  if ( fd < 0 || fstat(fd, &st) != 0 )
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+
+  if ( rehash || !load_checkpoint(argv[optind+1], &ctx)
+       || (off_t)ctx.count > st.st_size )
+    SHA256Mini_Init(&ctx);
+
+  buf = malloc(READ_SIZE);
+  if ( buf == NULL || lseek(fd, (off_t)ctx.count, SEEK_SET) < 0 )
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+  while ( (n = read(fd, buf, READ_SIZE)) != 0 )
+  {
+    if ( n < 0 )
+    {
+      if ( errno == EINTR )
+        continue;
+      perror(argv[optind]);
+      return 1;
+    }
+    SHA256Mini_Update(&ctx, buf, (size_t)n);
+  }
+  close(fd);
+  free(buf);
+
+  if ( !save_checkpoint(argv[optind+1], &ctx) )
+    return 1;
+
+  fin = ctx;
+  SHA256Mini_Final(&fin, digest);
+  for (i=0; i < SHA256MINI_HASHLEN; i++)
+    printf("%02x", digest[i]);
+  printf("  %s\n", argv[optind]);
+  return 0;
+}
@@ -0,0 +1,171 @@
+/*
+ * Parallel SHA-256 tree hash of a file, from minicrypt library host tools
+ *
+ * Usage: treehash [-l leafKB] [-f fanout] [-j threads] [-p leafindex] <file>
+ *
+ * Prints the tree root (see sha2tree_mini.h) for the file, in the same
+ * layout as sha256sum. With -p, also prints the hash of the given leaf
+ * and its proof, one hash per line, from the bottom of the tree up.
+ * The file is mapped into memory and its leaves are hashed on a
+ * work-stealing pool with one thread per CPU by default.
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "sha2tree_mini.h"
+#include "workpool.h"
+
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define TREEHASH_DEFAULT_LEAF_KB 1024
+#define TREEHASH_DEFAULT_FANOUT  16
+
+typedef struct
+{
+  const uint8_t *data;
+  size_t len;
+  size_t leafsize;
+  uint8_t *hashes;
+}
+  Job;
+
+static void hash_leaf(void *arg, size_t item, unsigned worker)
+{
+  const Job *j = (const Job *)arg;
+  size_t off = item * j->leafsize;
+  size_t n = (j->len - off < j->leafsize) ? j->len - off : j->leafsize;
+
+  (void)worker;
+  SHA256TreeMini_Leaf(j->data + off, n, j->hashes + item * SHA256MINI_HASHLEN);
+}
+
+static void print_hash(const uint8_t *h)
+{
+  int i;
+  for (i=0; i < SHA256MINI_HASHLEN; i++)
+    printf("%02x", h[i]);
+}
+
+static void usage(void)
+{
+  fprintf(stderr, "Usage: treehash [-l leafKB] [-f fanout] [-j threads] [-p leafindex] <file>\n"
+                  "  -l  leaf size in KB (default %d)\n"
+                  "  -f  hashes per interior node, %d to %d (default %d)\n"
+                  "  -j  number of threads (default: one per CPU)\n"
+                  "  -p  also print the proof for this leaf\n",
+                  TREEHASH_DEFAULT_LEAF_KB, SHA256TREEMINI_MIN_FANOUT,
+                  SHA256TREEMINI_MAX_FANOUT, TREEHASH_DEFAULT_FANOUT);
+  exit(2);
+}
+
+int main(int argc, char **argv)
+{
+  Job job;
+  struct stat st;
+  uint8_t root[SHA256MINI_HASHLEN], leaf[SHA256MINI_HASHLEN];
+  uint8_t *proof = NULL;
+  size_t nleaves, nproof = 0, i;
+  unsigned fanout = TREEHASH_DEFAULT_FANOUT;
+  unsigned nthreads = WorkPool_DefaultThreads();
+  long proofIndex = -1;
+  void *map = NULL;
+  int opt, fd;
+  MCResult rc;
+
+  job.leafsize = (size_t)TREEHASH_DEFAULT_LEAF_KB * 1024;
+  while ( (opt = getopt(argc, argv, "l:f:j:p:")) != -1 )
+  {
+    switch (opt)
+    {
+      case 'l': job.leafsize = (size_t) atol(optarg) * 1024; break;
+      case 'f': fanout = (unsigned) atoi(optarg); break;
+      case 'j': nthreads = (unsigned) atoi(optarg); break;
+      case 'p': proofIndex = atol(optarg); break;
+      default: usage();
+    }
+  }
+  if ( argc - optind != 1 || job.leafsize == 0 || nthreads == 0
+       || fanout < SHA256TREEMINI_MIN_FANOUT || fanout > SHA256TREEMINI_MAX_FANOUT )
+    usage();
+
+  fd = open(argv[optind], O_RDONLY);
+  if ( fd < 0 || fstat(fd, &st) != 0 )
+  {
+    perror(argv[optind]);
+    return 1;
+  }
+  job.len = (size_t)st.st_size;
+  if ( job.len > 0 )
+  {
+    map = mmap(NULL, job.len, PROT_READ, MAP_PRIVATE, fd, 0);
+    if ( map == MAP_FAILED )
+    {
+      perror(argv[optind]);
+      return 1;
+    }
+    /* Each thread reads forward through its own part of the file */
+    madvise(map, job.len, MADV_SEQUENTIAL);
+  }
+  close(fd);
+  job.data = (const uint8_t *)map;
+
+  nleaves = SHA256TreeMini_LeafCount(job.len, job.leafsize);
+  if ( proofIndex >= 0 && (size_t)proofIndex >= nleaves )
+  {
+    fprintf(stderr, "treehash: leaf %ld out of range, file has %lu leaves\n",
+            proofIndex, (unsigned long)nleaves);
+    return 2;
+  }
+  job.hashes = malloc(nleaves * SHA256MINI_HASHLEN);
+  if ( proofIndex >= 0 )
+    /* Never more than nleaves-1 hashes: each one is merged away by a node */
+    proof = malloc(nleaves * SHA256MINI_HASHLEN);
+  if ( job.hashes == NULL || (proofIndex >= 0 && proof == NULL) )
+  {
+    fprintf(stderr, "treehash: out of memory\n");
+    return 1;
+  }
+
+  WorkPool_Run(nleaves, nthreads, hash_leaf, &job);
+  if ( map != NULL )
+    munmap(map, job.len);
+
+  if ( proofIndex >= 0 )
+  {
+    memcpy(leaf, job.hashes + (size_t)proofIndex * SHA256MINI_HASHLEN, sizeof(leaf));
+    rc = SHA256TreeMini_Proof(job.hashes, nleaves, fanout, (size_t)proofIndex,
+                              proof, &nproof, root);
+  }
+  else
+    rc = SHA256TreeMini_Root(job.hashes, nleaves, fanout, root);
+  if ( rc != MC_OK )
+  {
+    fprintf(stderr, "treehash: failed (error %d)\n", rc);
+    return 1;
+  }
+
+  print_hash(root);
+  printf("  %s\n", argv[optind]);
+  if ( proofIndex >= 0 )
+  {
+    printf("leaf %ld of %lu: ", proofIndex, (unsigned long)nleaves);
+    print_hash(leaf);
+    printf("\n");
+    for (i=0; i < nproof; i++)
+    {
+      print_hash(proof + i * SHA256MINI_HASHLEN);
+      printf("\n");
+    }
+  }
+  free(job.hashes);
+  free(proof);
+  return 0;
+}
@@ -0,0 +1,154 @@
+/*
+ * Work-stealing thread pool from minicrypt library host tools
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "workpool.h"
+
+#include <pthread.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+/* Padded to a cache line each, so threads taking items from their own
+   range do not slow each other down */
+typedef struct
+{
+  pthread_mutex_t lock;
+  size_t next, end;
+  pthread_t thread;
+  struct Pool *pool;
+  unsigned index;
+}
+  __attribute__((aligned(64))) Worker;
+
+typedef struct Pool
+{
+  Worker *workers;
+  unsigned nthreads;
+  WorkPool_fn fn;
+  void *arg;
+}
+  Pool;
+
+unsigned WorkPool_DefaultThreads(void)
+{
+  long n = sysconf(_SC_NPROCESSORS_ONLN);
+
+  if ( n < 1 )
+    return 1;
+  return (n > WORKPOOL_MAX_THREADS) ? WORKPOOL_MAX_THREADS : (unsigned)n;
+}
+
+static int take(Worker *w, size_t *item)
+{
+  int got = 0;
+
+  pthread_mutex_lock(&w->lock);
+  if ( w->next < w->end )
+  {
+    *item = w->next++;
+    got = 1;
+  }
+  pthread_mutex_unlock(&w->lock);
+  return got;
+}
+
+/* Moves the back half of some other worker's range (all of it, if only
+   one item is left) to w. Returns 0 if there was nothing to steal. */
+static int steal(Worker *w)
+{
+  Pool *p = w->pool;
+  unsigned i;
+
+  for (i=1; i < p->nthreads; i++)
+  {
+    Worker *v = &p->workers[(w->index + i) % p->nthreads];
+    size_t lo, hi;
+
+    pthread_mutex_lock(&v->lock);
+    hi = v->end;
+    lo = v->next + (v->end - v->next) / 2;
+    if ( v->next < v->end )
+      v->end = lo;
+    pthread_mutex_unlock(&v->lock);
+
+    if ( lo < hi )
+    {
+      pthread_mutex_lock(&w->lock);
+      w->next = lo;
+      w->end = hi;
+      pthread_mutex_unlock(&w->lock);
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static void *worker_main(void *pv)
+{
+  Worker *w = (Worker *)pv;
+  size_t item;
+
+  do
+  {
+    while ( take(w, &item) )
+      w->pool->fn(w->pool->arg, item, w->index);
+  }
+  while ( steal(w) );
+  return NULL;
+}
+
+void WorkPool_Run(size_t nitems, unsigned nthreads, WorkPool_fn fn, void *arg)
+{
+  Pool pool;
+  unsigned i, started;
+
+  if ( nthreads < 1 )
+    nthreads = 1;
+  if ( nthreads > WORKPOOL_MAX_THREADS )
+    nthreads = WORKPOOL_MAX_THREADS;
+  if ( nthreads > nitems )
+    nthreads = (nitems > 0) ? (unsigned)nitems : 1;
+
+  pool.workers = NULL;
+  if ( nthreads > 1 && posix_memalign((void **)&pool.workers, 64,
+                                      nthreads * sizeof(Worker)) != 0 )
+    pool.workers = NULL;
+  if ( pool.workers == NULL )
+  {
+    size_t item;
+    for (item=0; item < nitems; item++)
+      fn(arg, item, 0);
+    return;
+  }
+
+  pool.nthreads = nthreads;
+  pool.fn = fn;
+  pool.arg = arg;
+  for (i=0; i < nthreads; i++)
+  {
+    Worker *w = &pool.workers[i];
+    pthread_mutex_init(&w->lock, NULL);
+    w->next = nitems * i / nthreads;
+    w->end = nitems * (i+1) / nthreads;
+    w->pool = &pool;
+    w->index = i;
+  }
+
+  /* Any thread which fails to start just leaves its range to be stolen */
+  for (started=1; started < nthreads; started++)
+    if ( pthread_create(&pool.workers[started].thread, NULL, worker_main,
+                        &pool.workers[started]) != 0 )
+      break;
+
+  worker_main(&pool.workers[0]);
+  for (i=1; i < started; i++)
+    pthread_join(pool.workers[i].thread, NULL);
+
+  for (i=0; i < nthreads; i++)
+    pthread_mutex_destroy(&pool.workers[i].lock);
+  free(pool.workers);
+}
@@ -0,0 +1,41 @@
+#ifndef WORKPOOL_H
+#define WORKPOOL_H
+/*
+ * Work-stealing thread pool for independent items,
+ * from minicrypt library host tools
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * Items 0..nitems-1 are split into one contiguous range per thread.
+ * Each thread works forward through its own range; one which runs out
+ * takes the back half of another thread's remaining range. So neighbouring
+ * items tend to run on the same thread in order (good for sequential reads),
+ * while uneven item costs still keep every thread busy to the end.
+ */
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define WORKPOOL_MAX_THREADS 256
+
+typedef void (*WorkPool_fn)(void *arg, size_t item, unsigned worker);
+/* Processes one item. 'worker' is the calling thread's number, below
+ * the 'nthreads' passed to WorkPool_Run, for indexing per-thread state. */
+
+extern unsigned WorkPool_DefaultThreads(void);
+/* Returns the number of online CPUs (at least 1, at most WORKPOOL_MAX_THREADS) */
+
+extern void WorkPool_Run(size_t nitems, unsigned nthreads, WorkPool_fn fn, void *arg);
+/* Calls fn once for each item, and returns when all are done. The calling
+ * thread is worker 0. If threads cannot be created, fewer are used. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* WORKPOOL_H */
@@ -0,0 +1,57 @@
+# Generates src/testvectors/mpibarrett.inc: Barrett reduction test vectors
+#
+# Each vector gives a modulus N (as a 256-bit UInt_Mini), a double-width
+# x < 2^(64k) where N has k 32-bit digits, and x mod N.
+
+import random
+
+random.seed(0x62617272)
+
+P256_ORDER = 0xFFFFFFFF00000000FFFFFFFFFFFFFFFFBCE6FAADA7179E84F3B9CAC2FC632551
+F25519 = (1 << 255) - 19
+
+def toC(val, nWords):
+    assert( 0 <= val < (1 << (nWords*32)) )
+    return "{ {" + (",".join(["0x%08X" % ((val >> (i*32)) & 0xFFFFFFFF) for i in range(nWords)])) + "} }"
+
+def digits(N):
+    return (N.bit_length() + 31) // 32
+
+MODULI = [
+    3,
+    0xFFFFFFFF,
+    (1 << 32) + 1,
+    random.getrandbits(70) | (1 << 69),
+    (1 << 128) - 159,
+    random.getrandbits(200) | (1 << 199),
+    P256_ORDER,
+    F25519,
+    (1 << 256) - 1,
+    (1 << 224) + 7,
+]
+
+def inputs(N):
+    top = 1 << (64 * digits(N))
+    yield 0
+    yield N - 1
+    yield N
+    yield (N - 1) * (N - 1)
+    yield top - 1
+    yield N * random.randrange(top // N) + N - 1
+    for i in range(4):
+        yield random.randrange(top)
+
+def main(filename):
+    count = 0
+    with open(filename, "w") as fout:
+        fout.write("/* AUTOGENERATED by python-models/mpibarrettvectors.py - do not edit */\n")
+        for N in MODULI:
+            for x in inputs(N):
+                fout.write("  {\n")
+                fout.write(",\n".join(["    " + v for v in (toC(N, 8), toC(x, 16), toC(x % N, 8))]))
+                fout.write("\n  },\n\n")
+                count += 1
+    print("Wrote", filename, "(", count, "vectors )")
+
+if __name__ == '__main__':
+    main("../src/testvectors/mpibarrett.inc")
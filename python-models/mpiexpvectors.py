@@ -0,0 +1,53 @@
+# Generates src/testvectors/mpiexp.inc: modular exponentiation test vectors
+#
+# Each vector gives an odd modulus N of n 32-bit digits, a base < N, an
+# exponent of en digits, and base^exp mod N.
+
+import random
+
+random.seed(0x6d657870)
+
+P256 = 2**256 - 2**224 + 2**192 + 2**96 - 1
+
+def odd(bits):
+    return random.getrandbits(bits) | (1 << (bits-1)) | 1
+
+def vectors():
+    # (n, N, en, base, exp)
+    yield (1, 0xFFFFFFFB, 1, 2, 0)
+    yield (1, 0xFFFFFFFB, 1, 0, 5)
+    yield (1, 0xFFFFFFFB, 1, 3, 1)
+    yield (1, 0xFFFFFFFB, 2, 7, random.getrandbits(64))
+    yield (8, P256, 8, random.randrange(P256), P256 - 2)    # Inverse
+    yield (8, P256, 8, P256 - 1, random.getrandbits(256))
+    N = odd(17*32 - 9)
+    yield (17, N, 3, random.randrange(N), random.getrandbits(70))
+    yield (17, N, 17, random.randrange(N), random.getrandbits(17*32))
+    N = odd(1024)
+    yield (32, N, 32, random.randrange(N), random.getrandbits(1024))
+    yield (32, N, 1, random.randrange(N), 65537)
+    N = odd(2048)
+    yield (64, N, 64, random.randrange(N), random.getrandbits(2048))
+    yield (64, N, 1, random.randrange(N), 65537)
+    yield (64, N, 1, random.randrange(N), 3)
+    N = odd(4096)
+    yield (128, N, 1, random.randrange(N), 65537)
+
+def toC(val, nWords):
+    assert( 0 <= val < (1 << (nWords*32)) )
+    return "{" + (",".join(["0x%08X" % ((val >> (i*32)) & 0xFFFFFFFF) for i in range(nWords)])) + "}"
+
+def main(filename):
+    count = 0
+    with open(filename, "w") as fout:
+        fout.write("/* AUTOGENERATED by python-models/mpiexpvectors.py - do not edit */\n")
+        for (n, N, en, base, exp) in vectors():
+            fout.write("  {\n    %d, %d,\n" % (n, en))
+            fout.write(",\n".join(["    " + toC(v, w) for (v, w) in
+                ((N, n), (base, n), (exp, en), (pow(base, exp, N), n))]))
+            fout.write("\n  },\n\n")
+            count += 1
+    print("Wrote", filename, "(", count, "vectors )")
+
+if __name__ == '__main__':
+    main("../src/testvectors/mpiexp.inc")
@@ -0,0 +1,56 @@
+# Generates src/testvectors/mpimont.inc: Montgomery context test vectors
+#
+# Each vector gives an odd modulus N of n 32-bit digits, two values a,b < N,
+# and a*b mod N.
+
+import random
+
+random.seed(0x6d6f6e74)
+
+P256 = 2**256 - 2**224 + 2**192 + 2**96 - 1
+F25519 = (1 << 255) - 19
+
+def odd(bits):
+    return random.getrandbits(bits) | (1 << (bits-1)) | 1
+
+# (n digits, N)
+MODULI = [
+    (1, 3),
+    (1, 0xFFFFFFFB),
+    (2, (1 << 64) - 59),
+    (5, odd(128)),          # Top digit is zero
+    (8, P256),
+    (8, F25519),
+    (8, (1 << 256) - 1),
+    (17, odd(17*32 - 5)),
+    (32, odd(1000)),
+    (64, odd(2048)),
+    (96, odd(3072)),
+    (128, odd(4096)),
+]
+
+def toC(val, nWords):
+    assert( 0 <= val < (1 << (nWords*32)) )
+    return "{" + (",".join(["0x%08X" % ((val >> (i*32)) & 0xFFFFFFFF) for i in range(nWords)])) + "}"
+
+def operands(N):
+    yield (0, random.randrange(N))
+    yield (1, N-1)
+    yield (N-1, N-1)
+    for i in range(3):
+        yield (random.randrange(N), random.randrange(N))
+
+def main(filename):
+    count = 0
+    with open(filename, "w") as fout:
+        fout.write("/* AUTOGENERATED by python-models/mpimontvectors.py - do not edit */\n")
+        for (n, N) in MODULI:
+            for (a, b) in operands(N):
+                fout.write("  {\n    %d,\n" % n)
+                fout.write(",\n".join(["    " + toC(v, n) for v in (N, a, b, (a*b) % N)]))
+                fout.write("\n  },\n\n")
+                count += 1
+    print("Wrote", filename, "(", count, "vectors )")
+
+if __name__ == '__main__':
+    main("../src/testvectors/mpimont.inc")
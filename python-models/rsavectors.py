@@ -0,0 +1,186 @@
+# Generates src/testvectors/rsa.inc: RSA signature verification test vectors
+#
+# Keys are generated here from a fixed seed, and signed with the plain
+# Python PKCS#1 v1.5 and PSS (RFC 8017) encodings below. Each vector
+# gives a public key, a SHA-256 hash, a signature, the scheme and salt
+# length to verify with, and whether verification should succeed.
+#
+# Usage: python3 rsavectors.py [pemdir]
+#   With pemdir, also writes each public key, hash and signature there,
+#   so they can be cross-checked with 'openssl pkeyutl -verify'.
+
+import hashlib, random, sys, os
+
+random.seed(0x72736131)
+
+# Primes ----------------------------------------------
+
+def is_probable_prime(n):
+    if n < 2:
+        return False
+    for p in (2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37):
+        if n % p == 0:
+            return n == p
+    d, s = n - 1, 0
+    while d % 2 == 0:
+        d, s = d // 2, s + 1
+    for i in range(40):
+        x = pow(random.randrange(2, n - 1), d, n)
+        if x == 1 or x == n - 1:
+            continue
+        for r in range(s - 1):
+            x = pow(x, 2, n)
+            if x == n - 1:
+                break
+        else:
+            return False
+    return True
+
+def gen_prime(bits, e):
+    while True:
+        p = random.getrandbits(bits) | (3 << (bits - 2)) | 1
+        if p % e != 1 and is_probable_prime(p):
+            return p
+
+def gen_key(bits, e):
+    while True:
+        p = gen_prime((bits + 1) // 2, e)
+        q = gen_prime(bits // 2, e)
+        n = p * q
+        if n.bit_length() == bits and p != q:
+            d = pow(e, -1, (p - 1) * (q - 1))
+            return (n, e, d)
+
+# Encodings -------------------------------------------
+
+SHA256_DIGESTINFO = bytes.fromhex("3031300d060960864801650304020105000420")
+
+def i2osp(x, length):
+    return x.to_bytes(length, "big")
+
+def emsa_pkcs1(mhash, k):
+    t = SHA256_DIGESTINFO + mhash
+    return b"\x00\x01" + b"\xff" * (k - len(t) - 3) + b"\x00" + t
+
+def mgf1(seed, length):
+    out = b""
+    counter = 0
+    while len(out) < length:
+        out += hashlib.sha256(seed + i2osp(counter, 4)).digest()
+        counter += 1
+    return out[:length]
+
+def emsa_pss(mhash, salt, embits):
+    emlen = (embits + 7) // 8
+    h = hashlib.sha256(b"\x00" * 8 + mhash + salt).digest()
+    db = b"\x00" * (emlen - len(salt) - 34) + b"\x01" + salt
+    masked = bytearray(a ^ b for (a, b) in zip(db, mgf1(h, len(db))))
+    masked[0] &= 0xFF >> (8 * emlen - embits)
+    return bytes(masked) + h + b"\xbc"
+
+def sign(key, em):
+    (n, e, d) = key
+    k = (n.bit_length() + 7) // 8
+    return i2osp(pow(int.from_bytes(em, "big"), d, n), k)
+
+# Vectors ---------------------------------------------
+
+PKCS1 = "RSAMINI_TV_PKCS1"
+PSS = "RSAMINI_TV_PSS"
+
+def vectors():
+    keys = [
+        gen_key(2048, 65537),
+        gen_key(3072, 65537),
+        gen_key(4096, 65537),
+        gen_key(2049, 65537),   # Top byte of the PSS encoding is zero
+        gen_key(2048, 3),       # Not the fast path
+    ]
+    for (ki, key) in enumerate(keys):
+        (n, e, d) = key
+        k = (n.bit_length() + 7) // 8
+        mhash = hashlib.sha256(b"message %d" % ki).digest()
+        other = hashlib.sha256(b"other message").digest()
+
+        sig = sign(key, emsa_pkcs1(mhash, k))
+        yield (key, mhash, sig, PKCS1, 0, True)
+        yield (key, other, sig, PKCS1, 0, False)
+        bad = bytearray(sig)
+        bad[k // 2] ^= 0x10
+        yield (key, mhash, bytes(bad), PKCS1, 0, False)
+        yield (key, mhash, i2osp(n, k), PKCS1, 0, False)        # sig >= n
+        yield (key, mhash, sig[1:], PKCS1, 0, False)            # Wrong length
+
+        salt = random.randbytes(32)
+        sig = sign(key, emsa_pss(mhash, salt, n.bit_length() - 1))
+        yield (key, mhash, sig, PSS, 32, True)
+        yield (key, mhash, sig, PSS, -1, True)
+        yield (key, mhash, sig, PSS, 20, False)
+        yield (key, other, sig, PSS, 32, False)
+        yield (key, mhash, sig, PKCS1, 0, False)
+
+        if ki == 0:
+            sig = sign(key, emsa_pss(mhash, b"", n.bit_length() - 1))
+            yield (key, mhash, sig, PSS, 0, True)
+            yield (key, mhash, sig, PSS, -1, True)
+            salt = random.randbytes(222 - 34)                  # Largest possible
+            sig = sign(key, emsa_pss(mhash, salt, n.bit_length() - 1))
+            yield (key, mhash, sig, PSS, len(salt), True)
+            yield (key, mhash, sig, PSS, -1, True)
+            # PKCS#1 v1.5 with a SHA-1 DigestInfo around the same bytes
+            t = bytes.fromhex("3021300906052b0e03021a05000414") + mhash[:20]
+            em = b"\x00\x01" + b"\xff" * (k - len(t) - 3) + b"\x00" + t
+            yield (key, mhash, sign(key, em), PKCS1, 0, False)
+
+def cbytes(b, indent="      "):
+    lines = []
+    for i in range(0, len(b), 16):
+        lines.append(indent + ", ".join("0x%02x" % x for x in b[i:i+16]))
+    return "{\n" + ",\n".join(lines) + "\n    }"
+
+def der_len(n):
+    if n < 128:
+        return bytes([n])
+    b = n.to_bytes((n.bit_length() + 7) // 8, "big")
+    return bytes([0x80 | len(b)]) + b
+
+def der_int(x):
+    b = x.to_bytes(x.bit_length() // 8 + 1, "big")
+    return b"\x02" + der_len(len(b)) + b
+
+def der_seq(b):
+    return b"\x30" + der_len(len(b)) + b
+
+def pem_pubkey(n, e):
+    import base64
+    rsakey = der_seq(der_int(n) + der_int(e))
+    algid = der_seq(bytes.fromhex("06092a864886f70d0101010500"))
+    spki = der_seq(algid + b"\x03" + der_len(len(rsakey) + 1) + b"\x00" + rsakey)
+    b64 = base64.b64encode(spki).decode()
+    return ("-----BEGIN PUBLIC KEY-----\n" +
+            "\n".join(b64[i:i+64] for i in range(0, len(b64), 64)) +
+            "\n-----END PUBLIC KEY-----\n")
+
+def main(filename, pemdir=None):
+    count = 0
+    with open(filename, "w") as fout:
+        fout.write("/* AUTOGENERATED by python-models/rsavectors.py - do not edit */\n")
+        for (key, mhash, sig, scheme, saltlen, ok) in vectors():
+            (n, e, d) = key
+            k = (n.bit_length() + 7) // 8
+            fout.write("  {\n    %d,\n    %s,\n    %d,\n" % (k, cbytes(i2osp(n, k)), e))
+            fout.write("    %s,\n" % cbytes(mhash))
+            fout.write("    %s, %d,\n" % (scheme, saltlen))
+            fout.write("    %d,\n    %s,\n" % (len(sig), cbytes(sig)))
+            fout.write("    %s\n  },\n\n" % ("MC_OK" if ok else "MC_VERIFY_FAILED"))
+            if pemdir is not None:
+                base = os.path.join(pemdir, "tv%02d" % count)
+                open(base + ".pem", "w").write(pem_pubkey(n, e))
+                open(base + ".hash", "wb").write(mhash)
+                open(base + ".sig", "wb").write(sig)
+                open(base + ".txt", "w").write("%s %d %d\n" % (scheme, saltlen, ok))
+            count += 1
+    print("Wrote", filename, "(", count, "vectors )")
+
+if __name__ == '__main__':
+    main("../src/testvectors/rsa.inc", sys.argv[1] if len(sys.argv) > 1 else None)
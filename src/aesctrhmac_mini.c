@@ -0,0 +1,271 @@
+/*
+ *
+ * AES-CTR + HMAC-SHA256 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "aesctrhmac_mini.h"
+
+#include <string.h>
+
+#define SLICE 64   /* One SHA-256 block, four AES blocks */
+#define MIN_TAGLEN 16
+
+void AESCTRHMACMini_Init(AESCTRHMACMini_ctx *ctx, const uint8_t *enckey, int enckeylen,
+                         const uint8_t *mackey, size_t mackeylen)
+{
+  AESMini_Init(&ctx->aes, enckey, enckeylen);
+  HMACSHA256Mini_SetKey(&ctx->mac, mackey, mackeylen);
+}
+
+/* XORs up to SLICE bytes with the keystream, advancing the counter */
+static void ctr_slice(AESCTRHMACMini_ctx *ctx, uint8_t *ctr,
+                      const uint8_t *in, uint8_t *out, size_t n)
+{
+  uint8_t ks[SLICE];
+  size_t i;
+  int j;
+
+  for (i=0; i < n; i += AESMINI_BLOCK_SIZE)
+  {
+    AESMini_ECB_Encrypt(&ctx->aes, ctr, ks + i);
+    for (j=AESMINI_BLOCK_SIZE-1; j >= 0 && ++ctr[j] == 0; j--)
+      ;
+  }
+  for (i=0; i < n; i++)
+    out[i] = in[i] ^ ks[i];
+}
+
+/* The MAC input is IV || ciphertext, so its 64-byte blocks start 16
+   bytes before each slice. Feeding it up to 48 bytes into the slice
+   keeps HMACSHA256Mini_Update on whole blocks, which it compresses
+   straight from the buffer without copying. */
+
+static size_t mac_edge(size_t off, size_t len)
+{
+  size_t end = off + SLICE - AESCTRHMACMINI_IVLEN;
+  return (end < len) ? end : len;
+}
+
+void AESCTRHMACMini_Seal(AESCTRHMACMini_ctx *ctx, const uint8_t *iv,
+                         const uint8_t *plain, size_t len,
+                         uint8_t *cipher, uint8_t *tag)
+{
+  HMACSHA256Mini_ctx hc;
+  uint8_t ctr[AESCTRHMACMINI_IVLEN];
+  size_t off, fed = 0, end;
+
+  memcpy(ctr, iv, sizeof(ctr));
+  HMACSHA256Mini_Init(&hc, &ctx->mac);
+  HMACSHA256Mini_Update(&hc, iv, AESCTRHMACMINI_IVLEN);
+
+  for (off=0; off < len; off += SLICE)
+  {
+    size_t n = (len - off < SLICE) ? len - off : SLICE;
+
+    ctr_slice(ctx, ctr, plain + off, cipher + off, n);
+    end = (off + n == len) ? len : mac_edge(off, len);
+    HMACSHA256Mini_Update(&hc, cipher + fed, end - fed);
+    fed = end;
+  }
+  HMACSHA256Mini_Final(&hc, tag);
+  memset(ctr, 0, sizeof(ctr));
+}
+
+MCResult AESCTRHMACMini_Open(AESCTRHMACMini_ctx *ctx, const uint8_t *iv,
+                             const uint8_t *cipher, size_t len,
+                             const uint8_t *tag, size_t taglen,
+                             uint8_t *plain)
+{
+  HMACSHA256Mini_ctx hc;
+  uint8_t ctr[AESCTRHMACMINI_IVLEN];
+  uint8_t mac[AESCTRHMACMINI_TAGLEN];
+  uint8_t checkByte = 0;
+  size_t off, fed, end, i;
+
+  if ( taglen < MIN_TAGLEN || taglen > AESCTRHMACMINI_TAGLEN )
+    return MC_BAD_LENGTH;
+
+  memcpy(ctr, iv, sizeof(ctr));
+  HMACSHA256Mini_Init(&hc, &ctx->mac);
+  HMACSHA256Mini_Update(&hc, iv, AESCTRHMACMINI_IVLEN);
+  fed = mac_edge(0, len);
+  HMACSHA256Mini_Update(&hc, cipher, fed);
+
+  /* Here the MAC runs one block ahead, so the ciphertext has been
+     read before an in-place decrypt overwrites it */
+  for (off=0; off < len; off += SLICE)
+  {
+    size_t n = (len - off < SLICE) ? len - off : SLICE;
+
+    end = mac_edge(off + SLICE, len);
+    HMACSHA256Mini_Update(&hc, cipher + fed, end - fed);
+    fed = end;
+    ctr_slice(ctx, ctr, cipher + off, plain + off, n);
+  }
+  HMACSHA256Mini_Final(&hc, mac);
+  memset(ctr, 0, sizeof(ctr));
+
+  for (i=0; i < taglen; i++)
+    checkByte |= (mac[i] ^ tag[i]);
+  if ( checkByte != 0 )
+  {
+    memset(plain, 0, len);
+    return MC_VERIFY_FAILED;
+  }
+  return MC_OK;
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* NIST SP 800-38A F.5.1 (CTR-AES128.Encrypt); the tag is from Python's
+   hmac module, keyed with bytes 0..31 */
+
+static const uint8_t sp800_key[16] =
+{
+  0x2b, 0x7e, 0x15, 0x16, 0x28, 0xae, 0xd2, 0xa6,
+  0xab, 0xf7, 0x15, 0x88, 0x09, 0xcf, 0x4f, 0x3c
+};
+
+static const uint8_t sp800_iv[16] =
+{
+  0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7,
+  0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+};
+
+static const uint8_t sp800_plain[64] =
+{
+  0x6b, 0xc1, 0xbe, 0xe2, 0x2e, 0x40, 0x9f, 0x96, 0xe9, 0x3d, 0x7e, 0x11, 0x73, 0x93, 0x17, 0x2a,
+  0xae, 0x2d, 0x8a, 0x57, 0x1e, 0x03, 0xac, 0x9c, 0x9e, 0xb7, 0x6f, 0xac, 0x45, 0xaf, 0x8e, 0x51,
+  0x30, 0xc8, 0x1c, 0x46, 0xa3, 0x5c, 0xe4, 0x11, 0xe5, 0xfb, 0xc1, 0x19, 0x1a, 0x0a, 0x52, 0xef,
+  0xf6, 0x9f, 0x24, 0x45, 0xdf, 0x4f, 0x9b, 0x17, 0xad, 0x2b, 0x41, 0x7b, 0xe6, 0x6c, 0x37, 0x10
+};
+
+static const uint8_t sp800_cipher[64] =
+{
+  0x87, 0x4d, 0x61, 0x91, 0xb6, 0x20, 0xe3, 0x26, 0x1b, 0xef, 0x68, 0x64, 0x99, 0x0d, 0xb6, 0xce,
+  0x98, 0x06, 0xf6, 0x6b, 0x79, 0x70, 0xfd, 0xff, 0x86, 0x17, 0x18, 0x7b, 0xb9, 0xff, 0xfd, 0xff,
+  0x5a, 0xe4, 0xdf, 0x3e, 0xdb, 0xd5, 0xd3, 0x5e, 0x5b, 0x4f, 0x09, 0x02, 0x0d, 0xb0, 0x3e, 0xab,
+  0x1e, 0x03, 0x1d, 0xda, 0x2f, 0xbe, 0x03, 0xd1, 0x79, 0x21, 0x70, 0xa0, 0xf3, 0x00, 0x9c, 0xee
+};
+
+static const uint8_t sp800_tag[32] =
+{
+  0xbd, 0xae, 0xde, 0xbf, 0x9a, 0x5f, 0x9f, 0x11, 0x9c, 0x90, 0xec, 0x73, 0x28, 0x20, 0xf9, 0xaa,
+  0x08, 0x0d, 0xa0, 0x78, 0x35, 0xea, 0x00, 0x21, 0x8b, 0x02, 0xb9, 0x92, 0x21, 0xbf, 0x94, 0x72
+};
+
+/* Two-pass reference: whole-message CTR, then HMAC over IV || ciphertext */
+static void seal_twopass(AESCTRHMACMini_ctx *ctx, const uint8_t *iv,
+                         const uint8_t *plain, size_t len, uint8_t *cipher, uint8_t *tag)
+{
+  HMACSHA256Mini_ctx hc;
+  uint8_t ctr[16], ks[16];
+  size_t i;
+  int j;
+
+  memcpy(ctr, iv, 16);
+  for (i=0; i < len; i++)
+  {
+    if ( (i & 15) == 0 )
+    {
+      AESMini_ECB_Encrypt(&ctx->aes, ctr, ks);
+      for (j=15; j >= 0 && ++ctr[j] == 0; j--)
+        ;
+    }
+    cipher[i] = plain[i] ^ ks[i & 15];
+  }
+  HMACSHA256Mini_Init(&hc, &ctx->mac);
+  HMACSHA256Mini_Update(&hc, iv, 16);
+  HMACSHA256Mini_Update(&hc, cipher, len);
+  HMACSHA256Mini_Final(&hc, tag);
+}
+
+#define MAXLEN 300
+
+static int test_lengths(void)
+{
+  static uint8_t plain[MAXLEN], ref[MAXLEN], buf[MAXLEN];
+  AESCTRHMACMini_ctx ctx;
+  uint8_t iv[16], key[32], tag[32], reftag[32];
+  size_t len, i;
+  int errs = 0;
+
+  for (i=0; i < sizeof(key); i++)
+    key[i] = (uint8_t)(i * 7 + 1);
+  for (i=0; i < MAXLEN; i++)
+    plain[i] = (uint8_t)(i * 13);
+  /* Counter wraps from all-ones within the first slice */
+  memset(iv, 0xFF, sizeof(iv));
+  iv[15] = 0xFE;
+
+  AESCTRHMACMini_Init(&ctx, key, AESMINI_256BIT_KEY, key, 20);
+  for (len=0; len <= MAXLEN; len++)
+  {
+    seal_twopass(&ctx, iv, plain, len, ref, reftag);
+
+    memcpy(buf, plain, len);
+    AESCTRHMACMini_Seal(&ctx, iv, buf, len, buf, tag);
+    if ( memcmp(buf, ref, len) != 0 || memcmp(tag, reftag, 32) != 0 )
+    {
+      printf("Seal length %d failed\n", (int)len);
+      errs++;
+      continue;
+    }
+    if ( AESCTRHMACMini_Open(&ctx, iv, buf, len, tag, 16, buf) != MC_OK
+         || memcmp(buf, plain, len) != 0 )
+    {
+      printf("Open length %d failed\n", (int)len);
+      errs++;
+      continue;
+    }
+    if ( len > 0 )
+    {
+      ref[len / 2] ^= 0x40;
+      if ( AESCTRHMACMini_Open(&ctx, iv, ref, len, reftag, 32, buf) != MC_VERIFY_FAILED
+           || buf[0] != 0 || buf[len-1] != 0 )
+      {
+        printf("Tamper length %d not detected\n", (int)len);
+        errs++;
+      }
+    }
+  }
+  return errs;
+}
+
+int main(void)
+{
+  AESCTRHMACMini_ctx ctx;
+  uint8_t mackey[32], cipher[64], plain[64], tag[32];
+  int i, errs = 0;
+
+  for (i=0; i < 32; i++)
+    mackey[i] = (uint8_t)i;
+  AESCTRHMACMini_Init(&ctx, sp800_key, AESMINI_128BIT_KEY, mackey, sizeof(mackey));
+  AESCTRHMACMini_Seal(&ctx, sp800_iv, sp800_plain, 64, cipher, tag);
+  if ( memcmp(cipher, sp800_cipher, 64) != 0 || memcmp(tag, sp800_tag, 32) != 0 )
+  {
+    printf("SP 800-38A seal failed\n");
+    errs++;
+  }
+  if ( AESCTRHMACMini_Open(&ctx, sp800_iv, sp800_cipher, 64, sp800_tag, 32, plain) != MC_OK
+       || memcmp(plain, sp800_plain, 64) != 0 )
+  {
+    printf("SP 800-38A open failed\n");
+    errs++;
+  }
+  if ( AESCTRHMACMini_Open(&ctx, sp800_iv, sp800_cipher, 64, sp800_tag, 15, plain) != MC_BAD_LENGTH )
+    errs++;
+
+  errs += test_lengths();
+  printf("%d errors out of %d\n", errs, 3 + MAXLEN + 1);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
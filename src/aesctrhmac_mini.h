@@ -0,0 +1,61 @@
+#ifndef AESCTRHMAC_MINI_H
+#define AESCTRHMAC_MINI_H
+/*
+ * AES-CTR with HMAC-SHA256 (encrypt-then-MAC) from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * The data is encrypted with AES in counter mode, the 16-byte IV being
+ * the first counter block (incremented as one 128-bit big-endian number),
+ * and the tag is HMAC-SHA256(mackey, IV || ciphertext).
+ *
+ * Both directions are done in one pass: each 64-byte slice is encrypted
+ * and then MACed while it is still in L1 cache, rather than running
+ * over the whole message twice. The IV must never be reused with the
+ * same key, and the two keys must be independent.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "aes_mini.h"
+#include "hmac_mini.h"
+
+typedef struct
+{
+  AESMini_ctx aes;
+  HMACSHA256Mini_key mac;
+}
+  AESCTRHMACMini_ctx;
+
+#define AESCTRHMACMINI_IVLEN   AESMINI_BLOCK_SIZE
+#define AESCTRHMACMINI_TAGLEN  HMACSHA256MINI_MACLEN
+
+extern void AESCTRHMACMini_Init(AESCTRHMACMini_ctx *ctx, const uint8_t *enckey, int enckeylen,
+                                const uint8_t *mackey, size_t mackeylen);
+/* enckeylen is AESMINI_128BIT_KEY etc; mackey may be any length */
+
+extern void AESCTRHMACMini_Seal(AESCTRHMACMini_ctx *ctx, const uint8_t *iv,
+                                const uint8_t *plain, size_t len,
+                                uint8_t *cipher, uint8_t *tag);
+/* Encrypts 'len' bytes and writes the AESCTRHMACMINI_TAGLEN byte tag.
+ * 'cipher' may be the same as 'plain'. */
+
+extern MCResult AESCTRHMACMini_Open(AESCTRHMACMini_ctx *ctx, const uint8_t *iv,
+                                    const uint8_t *cipher, size_t len,
+                                    const uint8_t *tag, size_t taglen,
+                                    uint8_t *plain);
+/* Checks the (possibly truncated) tag and decrypts. If the tag is wrong,
+ * returns MC_VERIFY_FAILED and 'plain' is zeroed. Returns MC_BAD_LENGTH if
+ * taglen is under 16 or over AESCTRHMACMINI_TAGLEN. 'plain' may be the
+ * same as 'cipher'. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AESCTRHMAC_MINI_H */
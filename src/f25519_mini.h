@@ -17,6 +17,33 @@
 extern "C" {
 #endif
 
+/*
+ * Build options: where the compiler has 'unsigned __int128' (GCC and
+ * clang on 64-bit targets), field elements are five 51-bit limbs,
+ * multiplied with 64x64->128 products and reduced with a single fold of
+ * the top half times 19. Elsewhere, or if F25519MINI_32BIT is defined,
+ * they are nine 29-bit digits using only 32-bit arithmetic.
+ *
+ * Elements are kept fully reduced either way, so results are identical.
+ */
+#if !defined(F25519MINI_32BIT) && defined(__SIZEOF_INT128__)
+#define F25519MINI_51BIT
+#endif
+
+#ifdef F25519MINI_51BIT
+
+#define F25519MINI_DIGITS 5
+#define F25519MINI_BITS  51
+#define F25519MINI_BITMASK 0x7ffffffffffffULL
+
+typedef struct
+{
+  uint64_t digits[F25519MINI_DIGITS];
+}
+  F25519_Mini;
+
+#else
+
 #define F25519MINI_DIGITS 9
 #define F25519MINI_BITS  29
 #define F25519MINI_BITMASK 0x1fffffff
@@ -27,6 +54,8 @@ typedef struct
 }
   F25519_Mini;
 
+#endif
+
 
 #define F25519MINI_MSGSIZE	32
 extern MCResult F25519_set_mini(F25519_Mini *res, const uint8_t *bytes, size_t len);
@@ -67,6 +96,13 @@ extern const F25519_Mini F25519_P_mini_; /* 2^255-19 */
 extern int F25519_cmp_mini_(const F25519_Mini *a, const F25519_Mini *b);
 /* Compares a to b; returns -1 if a < b, 0 if a==b, 1 if a > b */
 
+#ifdef F25519MINI_51BIT
+
+extern void F25519_reduce_mini_ (F25519_Mini *res);
+/* Reduces value mod 2^255-19, for limbs of up to 63 bits. Constant-time. */
+
+#else
+
 extern void F25519_reduce_mini_ (F25519_Mini *res);
 /* Reduces value mod 2^255-19; current implementation is by repeated subtraction. */
 
@@ -75,6 +111,20 @@ extern int32_t F25519_sub_core_mini_ (F25519_Mini *res, const F25519_Mini *s1, c
 
 #endif
 
+/* The test vectors hold elements as nine 29-bit digits, whichever
+ * form the library is built with */
+typedef struct
+{
+  int32_t digits[9];
+}
+  F25519Digits29_Mini;
+
+extern MCResult F25519_from29_mini_(F25519_Mini *res, const F25519Digits29_Mini *d);
+/* Sets res from nine 29-bit digits. Returns F25519_set_mini's result,
+ * e.g. if the value isn't fully reduced */
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
@@ -10,6 +10,82 @@
 #define MPIMINI_INTERNAL_API
 #include "f25519_mini.h"
 
+#ifdef F25519MINI_51BIT
+
+typedef unsigned __int128 U128;
+
+/* Carries r[0..4] into res, folding the carry out of the top limb back
+   into the bottom one as 2^255 = 19. With fully reduced inputs (limbs
+   below 2^51) each r[i] is under 5*19*2^102 < 2^109, and stays below
+   2^110 with the carry added. */
+static void carry_reduce(F25519_Mini *res, U128 *r)
+{
+  uint64_t *d = res->digits;
+  uint64_t c;
+  int i;
+
+  for (i=0; i<F25519MINI_DIGITS-1; i++)
+  {
+    r[i+1] += (uint64_t)(r[i] >> F25519MINI_BITS);
+    d[i] = (uint64_t)r[i] & F25519MINI_BITMASK;
+  }
+  d[4] = (uint64_t)r[4] & F25519MINI_BITMASK;
+  c = (uint64_t)(r[4] >> F25519MINI_BITS);
+
+  /* c = r[4] >> 51 is under 2^59, so 19*c + d[0] fits in 64 bits */
+  d[0] += 19 * c;
+  F25519_reduce_mini_(res);
+}
+
+void F25519_mul3_mini(F25519_Mini *res, const F25519_Mini *s1, const F25519_Mini *s2)
+{
+  const uint64_t *a = s1->digits, *b = s2->digits;
+  uint64_t b19[F25519MINI_DIGITS];
+  U128 r[F25519MINI_DIGITS];
+  int i;
+
+  /* Products of limbs i and j with i+j >= 5 land at 2^255 * 2^(51(i+j-5)),
+     so fold them down straight away by taking 19*b[j] */
+  for (i=1; i<F25519MINI_DIGITS; i++)
+    b19[i] = 19 * b[i];
+
+  r[0] = (U128)a[0]*b[0] + (U128)a[1]*b19[4] + (U128)a[2]*b19[3] + (U128)a[3]*b19[2] + (U128)a[4]*b19[1];
+  r[1] = (U128)a[0]*b[1] + (U128)a[1]*b[0]   + (U128)a[2]*b19[4] + (U128)a[3]*b19[3] + (U128)a[4]*b19[2];
+  r[2] = (U128)a[0]*b[2] + (U128)a[1]*b[1]   + (U128)a[2]*b[0]   + (U128)a[3]*b19[4] + (U128)a[4]*b19[3];
+  r[3] = (U128)a[0]*b[3] + (U128)a[1]*b[2]   + (U128)a[2]*b[1]   + (U128)a[3]*b[0]   + (U128)a[4]*b19[4];
+  r[4] = (U128)a[0]*b[4] + (U128)a[1]*b[3]   + (U128)a[2]*b[2]   + (U128)a[3]*b[1]   + (U128)a[4]*b[0];
+
+  carry_reduce(res, r);
+}
+
+void F25519_sqr_mini(F25519_Mini *res, const F25519_Mini *s)
+{
+  const uint64_t *a = s->digits;
+  uint64_t a2_0 = 2*a[0], a2_1 = 2*a[1];
+  uint64_t a19_3 = 19*a[3], a19_4 = 19*a[4];
+  U128 r[F25519MINI_DIGITS];
+
+  r[0] = (U128)a[0]*a[0] + (U128)a2_1*a19_4      + (U128)(2*a[2])*a19_3;
+  r[1] = (U128)a2_0*a[1] + (U128)(2*a[2])*a19_4 + (U128)a[3]*a19_3;
+  r[2] = (U128)a2_0*a[2] + (U128)a[1]*a[1]      + (U128)(2*a[3])*a19_4;
+  r[3] = (U128)a2_0*a[3] + (U128)a2_1*a[2]      + (U128)a[4]*a19_4;
+  r[4] = (U128)a2_0*a[4] + (U128)a2_1*a[3]      + (U128)a[2]*a[2];
+
+  carry_reduce(res, r);
+}
+
+void F25519_mulK_mini(F25519_Mini *res, const F25519_Mini *s1, uint32_t s2)
+{
+  U128 r[F25519MINI_DIGITS];
+  int i;
+
+  for (i=0; i<F25519MINI_DIGITS; i++)
+    r[i] = (U128)s1->digits[i] * s2;
+  carry_reduce(res, r);
+}
+
+#else
+
 #define USE_64BIT 0
 
 #if USE_64BIT
@@ -190,6 +266,8 @@ void F25519_mulK_mini(F25519_Mini *res, const F25519_Mini *s1, uint32_t s2)
   F25519_mul3_mini(res, s1, &s2l);
 }
 
+#endif /* F25519MINI_51BIT */
+
 /* Test harness ======================================================= */
 #ifdef TEST_HARNESS
 
@@ -198,9 +276,9 @@ void F25519_mulK_mini(F25519_Mini *res, const F25519_Mini *s1, uint32_t s2)
 
 typedef struct
 {
-  F25519_Mini a;
-  F25519_Mini b;
-  F25519_Mini res;
+  F25519Digits29_Mini a;
+  F25519Digits29_Mini b;
+  F25519Digits29_Mini res;
 }
   F25519Mul_TV;
   
@@ -219,30 +297,39 @@ int main(void)
   for (i=0; i < mul_tvs_count; i++)
   {
     const F25519Mul_TV *tv = &mul_tvs[i];
-    F25519_Mini res;
-   	
-    F25519_mul3_mini(&res, &tv->a, &tv->b);
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    F25519_Mini a, b, expect, res;
+
+    if ( F25519_from29_mini_(&a, &tv->a) != MC_OK
+         || F25519_from29_mini_(&b, &tv->b) != MC_OK
+         || F25519_from29_mini_(&expect, &tv->res) != MC_OK )
+    {
+      printf("Test #%d: bad vector\n", i);
+      errs ++;
+      continue;
+    }
+
+    F25519_mul3_mini(&res, &a, &b);
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (1)\n", i);
       errs ++;
       continue;
     }
     
-    F25519_copy_mini(&res, &tv->a);
-    F25519_mul3_mini(&res, &res, &tv->b);
+    F25519_copy_mini(&res, &a);
+    F25519_mul3_mini(&res, &res, &b);
 
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (2)\n", i);
       errs ++;
       continue;
     }
 
-    F25519_copy_mini(&res, &tv->b);
-    F25519_mul3_mini(&res, &tv->a, &res);
+    F25519_copy_mini(&res, &b);
+    F25519_mul3_mini(&res, &a, &res);
 
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (3)\n", i);
       errs ++;
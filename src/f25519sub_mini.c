@@ -10,6 +10,20 @@
 #define MPIMINI_INTERNAL_API
 #include "f25519_mini.h"
 
+#ifdef F25519MINI_51BIT
+
+void F25519_sub3_mini(F25519_Mini *res, const F25519_Mini *s1, const F25519_Mini *s2)
+{
+  int i;
+
+  /* s1 + 2p - s2, which can't go negative in any limb */
+  for (i=0; i<F25519MINI_DIGITS; i++)
+    res->digits[i] = s1->digits[i] + 2*F25519_P_mini_.digits[i] - s2->digits[i];
+  F25519_reduce_mini_(res);
+}
+
+#else
+
 void F25519_sub3_mini(F25519_Mini *res, const F25519_Mini *s1, const F25519_Mini *s2)
 {
   F25519_Mini minusS2;
@@ -18,6 +32,8 @@ void F25519_sub3_mini(F25519_Mini *res, const F25519_Mini *s1, const F25519_Mini
   F25519_add3_mini(res, s1, &minusS2);
 }
 
+#endif
+
 /* Test harness ======================================================= */
 #ifdef TEST_HARNESS
 
@@ -26,9 +42,9 @@ void F25519_sub3_mini(F25519_Mini *res, const F25519_Mini *s1, const F25519_Mini
 
 typedef struct
 {
-  F25519_Mini a;
-  F25519_Mini b;
-  F25519_Mini res;
+  F25519Digits29_Mini a;
+  F25519Digits29_Mini b;
+  F25519Digits29_Mini res;
 }
   F25519Sub_TV;
   
@@ -47,30 +63,39 @@ int main(void)
   for (i=0; i < sub_tvs_count; i++)
   {
     const F25519Sub_TV *tv = &sub_tvs[i];
-    F25519_Mini res;
-   	
-    F25519_sub3_mini(&res, &tv->a, &tv->b);
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    F25519_Mini a, b, expect, res;
+
+    if ( F25519_from29_mini_(&a, &tv->a) != MC_OK
+         || F25519_from29_mini_(&b, &tv->b) != MC_OK
+         || F25519_from29_mini_(&expect, &tv->res) != MC_OK )
+    {
+      printf("Test #%d: bad vector\n", i);
+      errs ++;
+      continue;
+    }
+
+    F25519_sub3_mini(&res, &a, &b);
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (1)\n", i);
       errs ++;
       continue;
     }
     
-    F25519_copy_mini(&res, &tv->a);
-    F25519_sub3_mini(&res, &res, &tv->b);
+    F25519_copy_mini(&res, &a);
+    F25519_sub3_mini(&res, &res, &b);
 
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (2)\n", i);
       errs ++;
       continue;
     }
 
-    F25519_copy_mini(&res, &tv->b);
-    F25519_sub3_mini(&res, &tv->a, &res);
+    F25519_copy_mini(&res, &b);
+    F25519_sub3_mini(&res, &a, &res);
 
-    if ( !F25519_equal_mini(&res, &tv->res) )
+    if ( !F25519_equal_mini(&res, &expect) )
     {
       printf("Test #%d failed (3)\n", i);
       errs ++;
@@ -10,6 +10,108 @@
 #define MPIMINI_INTERNAL_API
 #include "f25519_mini.h"
 
+#ifdef F25519MINI_51BIT
+
+const F25519_Mini F25519_P_mini_ =
+{
+  { 0x7ffffffffffedULL, 0x7ffffffffffffULL, 0x7ffffffffffffULL,
+    0x7ffffffffffffULL, 0x7ffffffffffffULL
+  }
+};
+
+/* One pass of carries, with the carry out of the top limb folded back in
+ * as 2^255 = 19. Afterwards every limb but the bottom one is < 2^51. */
+static void carry_pass(uint64_t *d)
+{
+  uint64_t c = 0;
+  int i;
+
+  for (i=0; i<F25519MINI_DIGITS; i++)
+  {
+    d[i] += c;
+    c = d[i] >> F25519MINI_BITS;
+    d[i] &= F25519MINI_BITMASK;
+  }
+  d[0] += 19 * c;
+}
+
+void F25519_reduce_mini_ (F25519_Mini *res)
+{
+  uint64_t *d = res->digits;
+  uint64_t q;
+  int i;
+
+  /* Two passes leave the value below 2^255, i.e. below 2p */
+  carry_pass(d);
+  carry_pass(d);
+
+  /* q = 1 if value >= p, i.e. if value+19 reaches 2^255. Then adding
+   * 19q and dropping bit 255 subtracts qp. */
+  q = (d[0] + 19) >> F25519MINI_BITS;
+  for (i=1; i<F25519MINI_DIGITS; i++)
+    q = (d[i] + q) >> F25519MINI_BITS;
+
+  d[0] += 19 * q;
+  for (i=0; i<F25519MINI_DIGITS-1; i++)
+  {
+    d[i+1] += d[i] >> F25519MINI_BITS;
+    d[i] &= F25519MINI_BITMASK;
+  }
+  d[i] &= F25519MINI_BITMASK;
+}
+
+MCResult F25519_set_mini(F25519_Mini *res, const uint8_t *bytes, size_t len)
+{
+  uint64_t w[4] = { 0, 0, 0, 0 };
+  size_t i;
+
+  if ( len > F25519MINI_MSGSIZE )
+    return MC_BAD_LENGTH;
+
+  for (i=0; i < len; i++)
+    w[i/8] |= (uint64_t)bytes[i] << (8*(i%8));
+
+  /* Bit 255 is left in the top limb, and so rejected below */
+  res->digits[0] = w[0] & F25519MINI_BITMASK;
+  res->digits[1] = ((w[0] >> 51) | (w[1] << 13)) & F25519MINI_BITMASK;
+  res->digits[2] = ((w[1] >> 38) | (w[2] << 26)) & F25519MINI_BITMASK;
+  res->digits[3] = ((w[2] >> 25) | (w[3] << 39)) & F25519MINI_BITMASK;
+  res->digits[4] = w[3] >> 12;
+
+  if (F25519_cmp_mini_(res, &F25519_P_mini_) >= 0)
+    return MC_BAD_PARAMS;
+  return MC_OK;
+}
+
+void F25519_setK_mini(F25519_Mini *res, uint32_t n)
+{
+  int i;
+  res->digits[0] = n;
+  for (i=1; i < F25519MINI_DIGITS; i++)
+    res->digits[i] = 0;
+}
+
+MCResult F25519_get_mini(uint8_t *bytes, size_t len, const F25519_Mini *s)
+{
+  const uint64_t *d = s->digits;
+  uint64_t w[4];
+  size_t i;
+
+  if ( len != F25519MINI_MSGSIZE )
+    return MC_BAD_LENGTH;
+
+  w[0] = d[0] | (d[1] << 51);
+  w[1] = (d[1] >> 13) | (d[2] << 38);
+  w[2] = (d[2] >> 26) | (d[3] << 25);
+  w[3] = (d[3] >> 39) | (d[4] << 12);
+  for (i=0; i < len; i++)
+    bytes[i] = (uint8_t)(w[i/8] >> (8*(i%8)));
+
+  return MC_OK;
+}
+
+#else
+
 const F25519_Mini F25519_P_mini_ = 
 {
   { 0x1fffffed, 0x1fffffff, 0x1fffffff, 0x1fffffff,
@@ -41,31 +143,6 @@ void F25519_reduce_mini_ (F25519_Mini *res)
   }
 }
 
-void F25519_copy_mini(F25519_Mini *res, const F25519_Mini *s)
-{
-  if (res != s)
-    *res = *s;
-}
-
-int F25519_cmp_mini_(const F25519_Mini *a, const F25519_Mini *b)
-{
-  int i;
-  for (i=F25519MINI_DIGITS; i-- > 0; )
-  {
-    if ( a->digits[i] < b->digits[i] )
-      return -1;
-    if ( a->digits[i] > b->digits[i] )
-      return 1;
-  }
-  return 0;
-
-}
-
-int F25519_equal_mini(const F25519_Mini *a, const F25519_Mini *b)
-{
-  return F25519_cmp_mini_(a,b) == 0;
-}
-
 MCResult F25519_set_mini(F25519_Mini *res, const uint8_t *bytes, size_t len)
 {
   int bitpos, digit;
@@ -131,3 +208,42 @@ MCResult F25519_get_mini(uint8_t *bytes, size_t len, const F25519_Mini *s)
   
   return MC_OK;
 }
+
+#endif /* F25519MINI_51BIT */
+
+void F25519_copy_mini(F25519_Mini *res, const F25519_Mini *s)
+{
+  if (res != s)
+    *res = *s;
+}
+
+int F25519_cmp_mini_(const F25519_Mini *a, const F25519_Mini *b)
+{
+  int i;
+  for (i=F25519MINI_DIGITS; i-- > 0; )
+  {
+    if ( a->digits[i] < b->digits[i] )
+      return -1;
+    if ( a->digits[i] > b->digits[i] )
+      return 1;
+  }
+  return 0;
+
+}
+
+int F25519_equal_mini(const F25519_Mini *a, const F25519_Mini *b)
+{
+  return F25519_cmp_mini_(a,b) == 0;
+}
+
+MCResult F25519_from29_mini_(F25519_Mini *res, const F25519Digits29_Mini *d)
+{
+  uint8_t bytes[F25519MINI_MSGSIZE];
+  int i;
+
+  for (i=0; i < F25519MINI_MSGSIZE; i++)
+    bytes[i] = 0;
+  for (i=0; i < 8*F25519MINI_MSGSIZE; i++)
+    bytes[i/8] |= (uint8_t)(((d->digits[i/29] >> (i%29)) & 1) << (i%8));
+  return F25519_set_mini(res, bytes, sizeof(bytes));
+}
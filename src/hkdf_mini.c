@@ -0,0 +1,424 @@
+/*
+ *
+ * HKDF-SHA256 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define SHA2MINI_INTERNAL_API
+#include "hkdf_mini.h"
+
+#include <string.h>
+
+#define HASHLEN SHA256MINI_HASHLEN
+
+void HKDFMini_Extract(HKDFMini_ctx *ctx, const uint8_t *salt, size_t saltlen,
+                      const uint8_t *ikm, size_t ikmlen)
+{
+  HMACSHA256Mini_key saltkey;
+  uint8_t prk[HASHLEN];
+
+  /* An empty salt is the same HMAC key as HASHLEN zeros */
+  HMACSHA256Mini_SetKey(&saltkey, salt, saltlen);
+  HMACSHA256Mini(&saltkey, ikm, ikmlen, prk);
+  HMACSHA256Mini_SetKey(&ctx->prk, prk, sizeof(prk));
+  memset(prk, 0, sizeof(prk));
+}
+
+void HKDFMini_SetPRK(HKDFMini_ctx *ctx, const uint8_t *prk, size_t prklen)
+{
+  HMACSHA256Mini_SetKey(&ctx->prk, prk, prklen);
+}
+
+MCResult HKDFMini_Expand(const HKDFMini_ctx *ctx, const uint8_t *info, size_t infolen,
+                         uint8_t *okm, size_t okmlen)
+{
+  uint8_t T[HASHLEN];
+  uint8_t ctr = 1;
+  size_t n;
+
+  if ( okmlen > HKDFMINI_MAX_OKM )
+    return MC_BAD_LENGTH;
+
+  for ( ; okmlen > 0; okm += n, okmlen -= n, ctr++ )
+  {
+    HMACSHA256Mini_ctx hc;
+
+    HMACSHA256Mini_Init(&hc, &ctx->prk);
+    if ( ctr > 1 )
+      HMACSHA256Mini_Update(&hc, T, sizeof(T));
+    HMACSHA256Mini_Update(&hc, info, infolen);
+    HMACSHA256Mini_Update(&hc, &ctr, 1);
+    HMACSHA256Mini_Final(&hc, T);
+
+    n = (okmlen < HASHLEN) ? okmlen : HASHLEN;
+    memcpy(okm, T, n);
+  }
+  memset(T, 0, sizeof(T));
+  return MC_OK;
+}
+
+/* Batched expand ---------------------------------
+
+   Block r of every output is computed at the same time: the inner hash
+   of T(r-1) | info | r is fed to the lanes from the cached inner state,
+   followed by the outer hash from the cached outer state. Labels long
+   enough to need more than two inner blocks are done one at a time. */
+
+#define LANES SHA256MINI_MAX_LANES
+#define MAX_INFO_LANES (2*64 - 9 - HASHLEN - 1)
+
+typedef struct
+{
+  uint32_t H[8];
+  uint8_t blk[2][64];
+  unsigned nb;
+  unsigned idx;  /* Index into outs[] */
+}
+  Job;
+
+static void put_BE32(const uint32_t *words, uint8_t *bytes, unsigned nwords)
+{
+  while ( nwords-- > 0 )
+  {
+    uint32_t w = *words++;
+    bytes[0] = (uint8_t)(w >> 24);
+    bytes[1] = (uint8_t)(w >> 16);
+    bytes[2] = (uint8_t)(w >> 8);
+    bytes[3] = (uint8_t)w;
+    bytes += 4;
+  }
+}
+
+static void pad_blocks(uint8_t *blk, size_t len, size_t prefix, unsigned nb)
+/* Pads a message of len bytes, already in blk, which follows 'prefix'
+ * bytes already hashed, to fill nb blocks */
+{
+  size_t nbits = (prefix + len) << 3;
+  uint8_t *p = blk + 64*nb - 1;
+
+  memset(blk + len, 0, 64*nb - len);
+  blk[len] = 0x80;
+  while ( nbits > 0 )
+  {
+    *p-- = (uint8_t)(nbits & 0xFF);
+    nbits >>= 8;
+  }
+}
+
+static void expand_group(const HKDFMini_ctx *ctx, const HKDFMini_output **outs, unsigned count)
+{
+  Job jobs[LANES];
+  uint32_t *hp[LANES];
+  const uint8_t *mp[LANES];
+  uint8_t T[LANES][HASHLEN];
+  unsigned r, i, n, n2;
+
+  for (r=1; ; r++)
+  {
+    /* Inner hashes */
+    n = n2 = 0;
+    for (i=0; i < count; i++)
+    {
+      const HKDFMini_output *o = outs[i];
+      Job *j = &jobs[n];
+      size_t len = 0;
+
+      if ( o->okmlen <= (size_t)(r-1) * HASHLEN )
+        continue;
+
+      if ( r > 1 )
+      {
+        memcpy(j->blk[0], T[i], HASHLEN);
+        len = HASHLEN;
+      }
+      if ( o->infolen > 0 )
+        memcpy(j->blk[0] + len, o->info, o->infolen);
+      len += o->infolen;
+      j->blk[0][len++] = (uint8_t)r;
+      j->nb = (len + 9 > 64) ? 2 : 1;
+      pad_blocks(j->blk[0], len, 64, j->nb);
+
+      memcpy(j->H, ctx->prk.iH, sizeof(j->H));
+      j->idx = i;
+      hp[n] = j->H;
+      mp[n] = j->blk[0];
+      n++;
+    }
+    if ( n == 0 )
+      break;
+    SHA256Mini_compress_lanes_(hp, mp, n);
+
+    for (i=0; i < n; i++)
+      if ( jobs[i].nb == 2 )
+      {
+        hp[n2] = jobs[i].H;
+        mp[n2] = jobs[i].blk[1];
+        n2++;
+      }
+    if ( n2 > 0 )
+      SHA256Mini_compress_lanes_(hp, mp, n2);
+
+    /* Outer hashes */
+    for (i=0; i < n; i++)
+    {
+      Job *j = &jobs[i];
+      put_BE32(j->H, j->blk[0], 8);
+      pad_blocks(j->blk[0], HASHLEN, 64, 1);
+      memcpy(j->H, ctx->prk.oH, sizeof(j->H));
+      hp[i] = j->H;
+      mp[i] = j->blk[0];
+    }
+    SHA256Mini_compress_lanes_(hp, mp, n);
+
+    /* Write out T(r), and keep it for the next round */
+    for (i=0; i < n; i++)
+    {
+      const HKDFMini_output *o = outs[jobs[i].idx];
+      size_t off = (size_t)(r-1) * HASHLEN;
+      size_t len = o->okmlen - off;
+
+      put_BE32(jobs[i].H, T[jobs[i].idx], 8);
+      memcpy(o->okm + off, T[jobs[i].idx], (len < HASHLEN) ? len : HASHLEN);
+    }
+  }
+
+  memset(T, 0, sizeof(T));
+  memset(jobs, 0, sizeof(jobs));
+}
+
+MCResult HKDFMini_ExpandMulti(const HKDFMini_ctx *ctx, const HKDFMini_output *outs,
+                              size_t count)
+{
+  const HKDFMini_output *group[LANES];
+  unsigned n = 0;
+  size_t i;
+
+  for (i=0; i < count; i++)
+    if ( outs[i].okmlen > HKDFMINI_MAX_OKM )
+      return MC_BAD_LENGTH;
+
+  for (i=0; i < count; i++)
+  {
+    if ( outs[i].infolen > MAX_INFO_LANES )
+      HKDFMini_Expand(ctx, outs[i].info, outs[i].infolen, outs[i].okm, outs[i].okmlen);
+    else
+    {
+      group[n++] = &outs[i];
+      if ( n == LANES )
+      {
+        expand_group(ctx, group, n);
+        n = 0;
+      }
+    }
+  }
+  if ( n > 0 )
+    expand_group(ctx, group, n);
+  return MC_OK;
+}
+
+MCResult HKDFMini(const uint8_t *salt, size_t saltlen,
+                  const uint8_t *ikm, size_t ikmlen,
+                  const uint8_t *info, size_t infolen,
+                  uint8_t *okm, size_t okmlen)
+{
+  HKDFMini_ctx ctx;
+  MCResult rc;
+
+  HKDFMini_Extract(&ctx, salt, saltlen, ikm, ikmlen);
+  rc = HKDFMini_Expand(&ctx, info, infolen, okm, okmlen);
+  memset(&ctx, 0, sizeof(ctx));
+  return rc;
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* From RFC 5869, appendix A.1-A.3 */
+
+typedef struct
+{
+  size_t ikmlen;
+  uint8_t ikm[80];
+  size_t saltlen;
+  uint8_t salt[80];
+  size_t infolen;
+  uint8_t info[80];
+  size_t okmlen;
+  uint8_t okm[82];
+}
+  HKDF_TV;
+
+static const HKDF_TV hkdf_tvs[] =
+{
+  {
+    22,
+    {
+      0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+      0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+    },
+    13,
+    {
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c
+    },
+    10,
+    {
+      0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9
+    },
+    42,
+    {
+      0x3c, 0xb2, 0x5f, 0x25, 0xfa, 0xac, 0xd5, 0x7a, 0x90, 0x43, 0x4f, 0x64, 0xd0, 0x36, 0x2f, 0x2a,
+      0x2d, 0x2d, 0x0a, 0x90, 0xcf, 0x1a, 0x5a, 0x4c, 0x5d, 0xb0, 0x2d, 0x56, 0xec, 0xc4, 0xc5, 0xbf,
+      0x34, 0x00, 0x72, 0x08, 0xd5, 0xb8, 0x87, 0x18, 0x58, 0x65
+    }
+  },
+
+  {
+    80,
+    {
+      0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f,
+      0x10, 0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x1b, 0x1c, 0x1d, 0x1e, 0x1f,
+      0x20, 0x21, 0x22, 0x23, 0x24, 0x25, 0x26, 0x27, 0x28, 0x29, 0x2a, 0x2b, 0x2c, 0x2d, 0x2e, 0x2f,
+      0x30, 0x31, 0x32, 0x33, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x3b, 0x3c, 0x3d, 0x3e, 0x3f,
+      0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49, 0x4a, 0x4b, 0x4c, 0x4d, 0x4e, 0x4f
+    },
+    80,
+    {
+      0x60, 0x61, 0x62, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69, 0x6a, 0x6b, 0x6c, 0x6d, 0x6e, 0x6f,
+      0x70, 0x71, 0x72, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x7b, 0x7c, 0x7d, 0x7e, 0x7f,
+      0x80, 0x81, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89, 0x8a, 0x8b, 0x8c, 0x8d, 0x8e, 0x8f,
+      0x90, 0x91, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0x9b, 0x9c, 0x9d, 0x9e, 0x9f,
+      0xa0, 0xa1, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xab, 0xac, 0xad, 0xae, 0xaf
+    },
+    80,
+    {
+      0xb0, 0xb1, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xbb, 0xbc, 0xbd, 0xbe, 0xbf,
+      0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xcb, 0xcc, 0xcd, 0xce, 0xcf,
+      0xd0, 0xd1, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xdb, 0xdc, 0xdd, 0xde, 0xdf,
+      0xe0, 0xe1, 0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xeb, 0xec, 0xed, 0xee, 0xef,
+      0xf0, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8, 0xf9, 0xfa, 0xfb, 0xfc, 0xfd, 0xfe, 0xff
+    },
+    82,
+    {
+      0xb1, 0x1e, 0x39, 0x8d, 0xc8, 0x03, 0x27, 0xa1, 0xc8, 0xe7, 0xf7, 0x8c, 0x59, 0x6a, 0x49, 0x34,
+      0x4f, 0x01, 0x2e, 0xda, 0x2d, 0x4e, 0xfa, 0xd8, 0xa0, 0x50, 0xcc, 0x4c, 0x19, 0xaf, 0xa9, 0x7c,
+      0x59, 0x04, 0x5a, 0x99, 0xca, 0xc7, 0x82, 0x72, 0x71, 0xcb, 0x41, 0xc6, 0x5e, 0x59, 0x0e, 0x09,
+      0xda, 0x32, 0x75, 0x60, 0x0c, 0x2f, 0x09, 0xb8, 0x36, 0x77, 0x93, 0xa9, 0xac, 0xa3, 0xdb, 0x71,
+      0xcc, 0x30, 0xc5, 0x81, 0x79, 0xec, 0x3e, 0x87, 0xc1, 0x4c, 0x01, 0xd5, 0xc1, 0xf3, 0x43, 0x4f,
+      0x1d, 0x87
+    }
+  },
+
+  {
+    22,
+    {
+      0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+      0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b
+    },
+    0,
+    {
+      0
+    },
+    0,
+    {
+      0
+    },
+    42,
+    {
+      0x8d, 0xa4, 0xe7, 0x75, 0xa5, 0x63, 0xc1, 0x8f, 0x71, 0x5f, 0x80, 0x2a, 0x06, 0x3c, 0x5a, 0x31,
+      0xb8, 0xa1, 0x1f, 0x5c, 0x5e, 0xe1, 0x87, 0x9e, 0xc3, 0x45, 0x4e, 0x5f, 0x3c, 0x73, 0x8d, 0x2d,
+      0x9d, 0x20, 0x13, 0x95, 0xfa, 0xa4, 0xb6, 0x1a, 0x96, 0xc8
+    }
+  },
+};
+
+static const int hkdf_tvs_count = sizeof(hkdf_tvs) / sizeof(HKDF_TV);
+
+/* Compares the batched expand against one-at-a-time */
+static int test_multi(void)
+{
+  static const size_t infolens[] = { 0, 5, 20, 31, 32, 54, 55, 86, 87, 200, 13, 1 };
+  static const size_t okmlens[] = { 32, 16, 42, 64, 100, 32, 33, 65, 32, 70, 0, 300 };
+  enum { NOUT = sizeof(infolens) / sizeof(infolens[0]) };
+  static uint8_t info[200];
+  static uint8_t okm[NOUT][300], ref[300];
+  HKDFMini_output outs[NOUT];
+  HKDFMini_ctx ctx;
+  int i, errs = 0;
+
+  for (i=0; i < (int)sizeof(info); i++)
+    info[i] = (uint8_t)(i * 7 + 3);
+  HKDFMini_Extract(&ctx, info, 16, info + 50, 32);
+
+  for (i=0; i < NOUT; i++)
+  {
+    outs[i].info = info + i;
+    outs[i].infolen = infolens[i];
+    outs[i].okm = okm[i];
+    outs[i].okmlen = okmlens[i];
+  }
+
+  if ( HKDFMini_ExpandMulti(&ctx, outs, NOUT) != MC_OK )
+    return 1;
+  for (i=0; i < NOUT; i++)
+  {
+    HKDFMini_Expand(&ctx, outs[i].info, outs[i].infolen, ref, outs[i].okmlen);
+    if ( memcmp(ref, okm[i], outs[i].okmlen) != 0 )
+    {
+      printf("Batch output #%d failed\n", i);
+      errs++;
+    }
+  }
+
+  outs[0].okmlen = HKDFMINI_MAX_OKM + 1;
+  if ( HKDFMini_ExpandMulti(&ctx, outs, NOUT) != MC_BAD_LENGTH )
+    errs++;
+  return errs;
+}
+
+int main(void)
+{
+  int i, errs;
+  
+  errs = 0;
+  for (i=0; i < hkdf_tvs_count; i++)
+  {
+    const HKDF_TV *tv = &hkdf_tvs[i];
+    HKDFMini_ctx ctx;
+    HKDFMini_output out;
+    uint8_t okm[82];
+    
+    if ( HKDFMini(tv->salt, tv->saltlen, tv->ikm, tv->ikmlen, tv->info, tv->infolen,
+                  okm, tv->okmlen) != MC_OK
+         || memcmp(okm, tv->okm, tv->okmlen) != 0 )
+    {
+      printf("Test #%d failed (1)\n", i);
+      errs++;
+      continue;
+    }
+
+    memset(okm, 0, sizeof(okm));
+    HKDFMini_Extract(&ctx, tv->salt, tv->saltlen, tv->ikm, tv->ikmlen);
+    out.info = tv->info;
+    out.infolen = tv->infolen;
+    out.okm = okm;
+    out.okmlen = tv->okmlen;
+    if ( HKDFMini_ExpandMulti(&ctx, &out, 1) != MC_OK
+         || memcmp(okm, tv->okm, tv->okmlen) != 0 )
+    {
+      printf("Test #%d failed (2)\n", i);
+      errs++;
+      continue;
+    }
+  }
+  
+  errs += test_multi();
+  printf("%d errors out of %d\n", errs, hkdf_tvs_count + 1);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
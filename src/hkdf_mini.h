@@ -0,0 +1,64 @@
+#ifndef HKDF_MINI_H
+#define HKDF_MINI_H
+/*
+ * HKDF-SHA256 (RFC 5869) implementation from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "hmac_mini.h"
+
+typedef struct
+{
+  HMACSHA256Mini_key prk;  /* PRK, already set up as a HMAC key */
+}
+  HKDFMini_ctx;
+
+#define HKDFMINI_MAX_OKM  (255 * HMACSHA256MINI_MACLEN)
+
+typedef struct
+{
+  const uint8_t *info;
+  size_t infolen;
+  uint8_t *okm;
+  size_t okmlen;
+}
+  HKDFMini_output;
+
+extern void HKDFMini_Extract(HKDFMini_ctx *ctx, const uint8_t *salt, size_t saltlen,
+                             const uint8_t *ikm, size_t ikmlen);
+/* Sets up ctx from input keying material. 'salt' may be NULL if saltlen is 0 */
+
+extern void HKDFMini_SetPRK(HKDFMini_ctx *ctx, const uint8_t *prk, size_t prklen);
+/* Sets up ctx from an existing pseudorandom key, for Expand only */
+
+extern MCResult HKDFMini_Expand(const HKDFMini_ctx *ctx, const uint8_t *info, size_t infolen,
+                                uint8_t *okm, size_t okmlen);
+/* Derives okmlen bytes of output keying material for the given label.
+ * Returns MC_BAD_LENGTH if okmlen > HKDFMINI_MAX_OKM */
+
+extern MCResult HKDFMini_ExpandMulti(const HKDFMini_ctx *ctx, const HKDFMini_output *outs,
+                                     size_t count);
+/* As HKDFMini_Expand for each of outs[0..count-1]. The derivations are
+ * independent, so several are run at once through the multi-lane SHA-256
+ * code where possible. Returns MC_BAD_LENGTH (with no output written) if
+ * any okmlen is too long. */
+
+extern MCResult HKDFMini(const uint8_t *salt, size_t saltlen,
+                         const uint8_t *ikm, size_t ikmlen,
+                         const uint8_t *info, size_t infolen,
+                         uint8_t *okm, size_t okmlen);
+/* One-shot Extract and Expand */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HKDF_MINI_H */
@@ -0,0 +1,336 @@
+/*
+ *
+ * HMAC-SHA256 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "hmac_mini.h"
+
+#include <string.h>
+
+#define BLOCKSIZE 64
+#define MIN_TAGLEN 16
+
+static void pad_state(uint32_t *H, const uint8_t *k0, uint8_t pad)
+{
+  SHA256Mini_ctx c;
+  uint8_t blk[BLOCKSIZE];
+  unsigned i;
+
+  for (i=0; i < BLOCKSIZE; i++)
+    blk[i] = k0[i] ^ pad;
+
+  SHA256Mini_Init(&c);
+  SHA256Mini_Update(&c, blk, BLOCKSIZE);
+  for (i=0; i < 8; i++)
+    H[i] = c.H[i];
+  memset(blk, 0, sizeof(blk));
+}
+
+void HMACSHA256Mini_SetKey(HMACSHA256Mini_key *k, const uint8_t *key, size_t keylen)
+{
+  uint8_t k0[BLOCKSIZE];
+
+  memset(k0, 0, sizeof(k0));
+  if ( keylen > BLOCKSIZE )
+    SHA256Mini(key, keylen, k0);
+  else
+    memcpy(k0, key, keylen);
+
+  pad_state(k->iH, k0, 0x36);
+  pad_state(k->oH, k0, 0x5C);
+  memset(k0, 0, sizeof(k0));
+}
+
+void HMACSHA256Mini_Init(HMACSHA256Mini_ctx *ctx, const HMACSHA256Mini_key *k)
+{
+  memcpy(ctx->inner.H, k->iH, sizeof(k->iH));
+  ctx->inner.count = BLOCKSIZE;
+  memcpy(ctx->oH, k->oH, sizeof(k->oH));
+}
+
+void HMACSHA256Mini_Update(HMACSHA256Mini_ctx *ctx, const void *msg, size_t msglen)
+{
+  SHA256Mini_Update(&ctx->inner, msg, msglen);
+}
+
+void HMACSHA256Mini_Final(HMACSHA256Mini_ctx *ctx, uint8_t *out32)
+{
+  uint8_t ihash[SHA256MINI_HASHLEN];
+
+  SHA256Mini_Final(&ctx->inner, ihash);
+
+  /* Reuse the inner context for the outer hash */
+  memcpy(ctx->inner.H, ctx->oH, sizeof(ctx->oH));
+  ctx->inner.count = BLOCKSIZE;
+  SHA256Mini_Update(&ctx->inner, ihash, sizeof(ihash));
+  SHA256Mini_Final(&ctx->inner, out32);
+  memset(ihash, 0, sizeof(ihash));
+}
+
+void HMACSHA256Mini(const HMACSHA256Mini_key *k, const void *msg, size_t msglen,
+                    uint8_t *out32)
+{
+  HMACSHA256Mini_ctx ctx;
+
+  HMACSHA256Mini_Init(&ctx, k);
+  HMACSHA256Mini_Update(&ctx, msg, msglen);
+  HMACSHA256Mini_Final(&ctx, out32);
+  memset(&ctx, 0, sizeof(ctx));
+}
+
+MCResult HMACSHA256Mini_Verify(const HMACSHA256Mini_key *k, const void *msg, size_t msglen,
+                               const uint8_t *tag, size_t taglen)
+{
+  uint8_t mac[HMACSHA256MINI_MACLEN];
+  uint8_t checkByte = 0;
+  size_t i;
+
+  if ( taglen < MIN_TAGLEN || taglen > sizeof(mac) )
+    return MC_BAD_LENGTH;
+
+  HMACSHA256Mini(k, msg, msglen, mac);
+  for (i=0; i < taglen; i++)
+    checkByte |= (mac[i] ^ tag[i]);
+  memset(mac, 0, sizeof(mac));
+
+  return (checkByte == 0) ? MC_OK : MC_VERIFY_FAILED;
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* From RFC 4231 */
+
+typedef struct
+{
+  size_t keylen;
+  uint8_t key[131];
+  size_t msglen;
+  uint8_t msg[152];
+  uint8_t mac[HMACSHA256MINI_MACLEN];
+}
+  HMAC_TV;
+
+static const HMAC_TV hmac_tvs[] =
+{
+  {
+    20,
+    {
+      0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b, 0x0b,
+      0x0b, 0x0b, 0x0b, 0x0b
+    },
+    8,
+    {
+      0x48, 0x69, 0x20, 0x54, 0x68, 0x65, 0x72, 0x65
+    },
+    {
+      0xb0, 0x34, 0x4c, 0x61, 0xd8, 0xdb, 0x38, 0x53,
+      0x5c, 0xa8, 0xaf, 0xce, 0xaf, 0x0b, 0xf1, 0x2b,
+      0x88, 0x1d, 0xc2, 0x00, 0xc9, 0x83, 0x3d, 0xa7,
+      0x26, 0xe9, 0x37, 0x6c, 0x2e, 0x32, 0xcf, 0xf7
+    }
+  },
+
+  {
+    4,
+    {
+      0x4a, 0x65, 0x66, 0x65
+    },
+    28,
+    {
+      0x77, 0x68, 0x61, 0x74, 0x20, 0x64, 0x6f, 0x20, 0x79, 0x61, 0x20, 0x77, 0x61, 0x6e, 0x74, 0x20,
+      0x66, 0x6f, 0x72, 0x20, 0x6e, 0x6f, 0x74, 0x68, 0x69, 0x6e, 0x67, 0x3f
+    },
+    {
+      0x5b, 0xdc, 0xc1, 0x46, 0xbf, 0x60, 0x75, 0x4e,
+      0x6a, 0x04, 0x24, 0x26, 0x08, 0x95, 0x75, 0xc7,
+      0x5a, 0x00, 0x3f, 0x08, 0x9d, 0x27, 0x39, 0x83,
+      0x9d, 0xec, 0x58, 0xb9, 0x64, 0xec, 0x38, 0x43
+    }
+  },
+
+  {
+    20,
+    {
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa
+    },
+    50,
+    {
+      0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd,
+      0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd,
+      0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd, 0xdd,
+      0xdd, 0xdd
+    },
+    {
+      0x77, 0x3e, 0xa9, 0x1e, 0x36, 0x80, 0x0e, 0x46,
+      0x85, 0x4d, 0xb8, 0xeb, 0xd0, 0x91, 0x81, 0xa7,
+      0x29, 0x59, 0x09, 0x8b, 0x3e, 0xf8, 0xc1, 0x22,
+      0xd9, 0x63, 0x55, 0x14, 0xce, 0xd5, 0x65, 0xfe
+    }
+  },
+
+  {
+    25,
+    {
+      0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08, 0x09, 0x0a, 0x0b, 0x0c, 0x0d, 0x0e, 0x0f, 0x10,
+      0x11, 0x12, 0x13, 0x14, 0x15, 0x16, 0x17, 0x18, 0x19
+    },
+    50,
+    {
+      0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd,
+      0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd,
+      0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd, 0xcd,
+      0xcd, 0xcd
+    },
+    {
+      0x82, 0x55, 0x8a, 0x38, 0x9a, 0x44, 0x3c, 0x0e,
+      0xa4, 0xcc, 0x81, 0x98, 0x99, 0xf2, 0x08, 0x3a,
+      0x85, 0xf0, 0xfa, 0xa3, 0xe5, 0x78, 0xf8, 0x07,
+      0x7a, 0x2e, 0x3f, 0xf4, 0x67, 0x29, 0x66, 0x5b
+    }
+  },
+
+  {
+    20,
+    {
+      0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c, 0x0c,
+      0x0c, 0x0c, 0x0c, 0x0c
+    },
+    20,
+    {
+      0x54, 0x65, 0x73, 0x74, 0x20, 0x57, 0x69, 0x74, 0x68, 0x20, 0x54, 0x72, 0x75, 0x6e, 0x63, 0x61,
+      0x74, 0x69, 0x6f, 0x6e
+    },
+    {
+      0xa3, 0xb6, 0x16, 0x74, 0x73, 0x10, 0x0e, 0xe0,
+      0x6e, 0x0c, 0x79, 0x6c, 0x29, 0x55, 0x55, 0x2b,
+      0xfa, 0x6f, 0x7c, 0x0a, 0x6a, 0x8a, 0xef, 0x8b,
+      0x93, 0xf8, 0x60, 0xaa, 0xb0, 0xcd, 0x20, 0xc5
+    }
+  },
+
+  {
+    131,
+    {
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa
+    },
+    54,
+    {
+      0x54, 0x65, 0x73, 0x74, 0x20, 0x55, 0x73, 0x69, 0x6e, 0x67, 0x20, 0x4c, 0x61, 0x72, 0x67, 0x65,
+      0x72, 0x20, 0x54, 0x68, 0x61, 0x6e, 0x20, 0x42, 0x6c, 0x6f, 0x63, 0x6b, 0x2d, 0x53, 0x69, 0x7a,
+      0x65, 0x20, 0x4b, 0x65, 0x79, 0x20, 0x2d, 0x20, 0x48, 0x61, 0x73, 0x68, 0x20, 0x4b, 0x65, 0x79,
+      0x20, 0x46, 0x69, 0x72, 0x73, 0x74
+    },
+    {
+      0x60, 0xe4, 0x31, 0x59, 0x1e, 0xe0, 0xb6, 0x7f,
+      0x0d, 0x8a, 0x26, 0xaa, 0xcb, 0xf5, 0xb7, 0x7f,
+      0x8e, 0x0b, 0xc6, 0x21, 0x37, 0x28, 0xc5, 0x14,
+      0x05, 0x46, 0x04, 0x0f, 0x0e, 0xe3, 0x7f, 0x54
+    }
+  },
+
+  {
+    131,
+    {
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa, 0xaa,
+      0xaa, 0xaa, 0xaa
+    },
+    152,
+    {
+      0x54, 0x68, 0x69, 0x73, 0x20, 0x69, 0x73, 0x20, 0x61, 0x20, 0x74, 0x65, 0x73, 0x74, 0x20, 0x75,
+      0x73, 0x69, 0x6e, 0x67, 0x20, 0x61, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x72, 0x20, 0x74, 0x68,
+      0x61, 0x6e, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x2d, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x6b, 0x65,
+      0x79, 0x20, 0x61, 0x6e, 0x64, 0x20, 0x61, 0x20, 0x6c, 0x61, 0x72, 0x67, 0x65, 0x72, 0x20, 0x74,
+      0x68, 0x61, 0x6e, 0x20, 0x62, 0x6c, 0x6f, 0x63, 0x6b, 0x2d, 0x73, 0x69, 0x7a, 0x65, 0x20, 0x64,
+      0x61, 0x74, 0x61, 0x2e, 0x20, 0x54, 0x68, 0x65, 0x20, 0x6b, 0x65, 0x79, 0x20, 0x6e, 0x65, 0x65,
+      0x64, 0x73, 0x20, 0x74, 0x6f, 0x20, 0x62, 0x65, 0x20, 0x68, 0x61, 0x73, 0x68, 0x65, 0x64, 0x20,
+      0x62, 0x65, 0x66, 0x6f, 0x72, 0x65, 0x20, 0x62, 0x65, 0x69, 0x6e, 0x67, 0x20, 0x75, 0x73, 0x65,
+      0x64, 0x20, 0x62, 0x79, 0x20, 0x74, 0x68, 0x65, 0x20, 0x48, 0x4d, 0x41, 0x43, 0x20, 0x61, 0x6c,
+      0x67, 0x6f, 0x72, 0x69, 0x74, 0x68, 0x6d, 0x2e
+    },
+    {
+      0x9b, 0x09, 0xff, 0xa7, 0x1b, 0x94, 0x2f, 0xcb,
+      0x27, 0x63, 0x5f, 0xbc, 0xd5, 0xb0, 0xe9, 0x44,
+      0xbf, 0xdc, 0x63, 0x64, 0x4f, 0x07, 0x13, 0x93,
+      0x8a, 0x7f, 0x51, 0x53, 0x5c, 0x3a, 0x35, 0xe2
+    }
+  },
+};
+
+static const int hmac_tvs_count = sizeof(hmac_tvs) / sizeof(HMAC_TV);
+
+int main(void)
+{
+  int i, errs;
+  
+  errs = 0;
+  for (i=0; i < hmac_tvs_count; i++)
+  {
+    const HMAC_TV *tv = &hmac_tvs[i];
+    HMACSHA256Mini_key k;
+    HMACSHA256Mini_ctx ctx;
+    uint8_t mac[HMACSHA256MINI_MACLEN], bad[HMACSHA256MINI_MACLEN];
+    
+    HMACSHA256Mini_SetKey(&k, tv->key, tv->keylen);
+    HMACSHA256Mini(&k, tv->msg, tv->msglen, mac);
+    if ( memcmp(mac, tv->mac, sizeof(mac)) != 0 )
+    {
+      printf("Test #%d failed (1)\n", i);
+      errs++;
+      continue;
+    }
+
+    /* Incremental, with the key reused */
+    HMACSHA256Mini_Init(&ctx, &k);
+    HMACSHA256Mini_Update(&ctx, tv->msg, 3);
+    HMACSHA256Mini_Update(&ctx, tv->msg + 3, tv->msglen - 3);
+    HMACSHA256Mini_Final(&ctx, mac);
+    if ( memcmp(mac, tv->mac, sizeof(mac)) != 0 )
+    {
+      printf("Test #%d failed (2)\n", i);
+      errs++;
+      continue;
+    }
+
+    memcpy(bad, tv->mac, sizeof(bad));
+    bad[15] ^= 0x01;
+    if ( HMACSHA256Mini_Verify(&k, tv->msg, tv->msglen, tv->mac, sizeof(mac)) != MC_OK
+         || HMACSHA256Mini_Verify(&k, tv->msg, tv->msglen, tv->mac, 16) != MC_OK
+         || HMACSHA256Mini_Verify(&k, tv->msg, tv->msglen, bad, sizeof(bad)) != MC_VERIFY_FAILED
+         || HMACSHA256Mini_Verify(&k, tv->msg, tv->msglen, tv->mac, 0) != MC_BAD_LENGTH
+         || HMACSHA256Mini_Verify(&k, tv->msg, tv->msglen, tv->mac, 15) != MC_BAD_LENGTH
+       )
+    {
+      printf("Test #%d failed (3)\n", i);
+      errs++;
+      continue;
+    }
+  }
+  
+  printf("%d errors out of %d\n", errs, hmac_tvs_count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,60 @@
+#ifndef HMAC_MINI_H
+#define HMAC_MINI_H
+/*
+ * HMAC-SHA256 implementation from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * The key is processed once into a HMACSHA256Mini_key, which holds the
+ * SHA-256 state after the inner and outer padded key blocks. Each MAC
+ * then starts from those states instead of re-hashing the key blocks.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "sha2_mini.h"
+
+typedef struct
+{
+  uint32_t iH[8];  /* State after (key ^ ipad) */
+  uint32_t oH[8];  /* State after (key ^ opad) */
+}
+  HMACSHA256Mini_key;
+
+typedef struct
+{
+  SHA256Mini_ctx inner;
+  uint32_t oH[8];
+}
+  HMACSHA256Mini_ctx;
+
+#define HMACSHA256MINI_MACLEN SHA256MINI_HASHLEN
+
+extern void HMACSHA256Mini_SetKey(HMACSHA256Mini_key *k, const uint8_t *key, size_t keylen);
+/* Prepares a key of any length for use */
+
+extern void HMACSHA256Mini_Init(HMACSHA256Mini_ctx *ctx, const HMACSHA256Mini_key *k);
+extern void HMACSHA256Mini_Update(HMACSHA256Mini_ctx *ctx, const void *msg, size_t msglen);
+extern void HMACSHA256Mini_Final(HMACSHA256Mini_ctx *ctx, uint8_t *out32);
+/* Incremental MAC computation. The key may be reused once Init has been called */
+
+extern void HMACSHA256Mini(const HMACSHA256Mini_key *k, const void *msg, size_t msglen,
+                           uint8_t *out32);
+/* One-shot MAC computation */
+
+extern MCResult HMACSHA256Mini_Verify(const HMACSHA256Mini_key *k, const void *msg, size_t msglen,
+                                      const uint8_t *tag, size_t taglen);
+/* Checks a (possibly truncated) tag, in constant time. Returns MC_VERIFY_FAILED
+ * if it doesn't match, or MC_BAD_LENGTH if taglen is under 16 or more than
+ * HMACSHA256MINI_MACLEN. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HMAC_MINI_H */
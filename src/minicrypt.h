@@ -21,6 +21,7 @@ typedef int MCResult;
 #define MC_BAD_PARAMS       3   /* Parameters are illegal for this algorithm */
 #define MC_UNIMPLEMENTED    4   /* Feature is not (yet) implemented */ 
 #define MC_RANDOM_FAIL      5   /* Failed to generate random number */
+#define MC_IO_ERROR         6   /* Read or write failed (host tools only) */
 
 /* Random generation callback: must be supplied by user for certain algorithms */
 extern MCResult MC_GetRandom(uint8_t *buffer, size_t length);
@@ -1,7 +1,7 @@
 #ifndef MPI_MINI_H
 #define MPI_MINI_H
 /*
- * Multiprecision-integer and prime-field operationsfrom minicrypt library
+ * Multiprecision-integer and prime-field operations from minicrypt library
  *
  * https://github.com/IanHarvey/minicrypt
  *
@@ -25,6 +25,17 @@ extern "C" {
  * are /unsigned/. Subtraction can therefore return a carry value: for its 
  * intended use in constructing prime field arithmetic primitives, this is not
  * a problem.
+ *
+ * Build option: defining MPIMINI_64BIT selects an implementation which
+ * works on pairs of digits as 64-bit limbs, using the compiler's
+ * 'unsigned __int128' for 64x64->128 multiplies and carry propagation.
+ * This is much faster on 64-bit hosts. Values are still stored as
+ * 32-bit digits, least-significant first, so the API and results are
+ * identical in both builds.
+ *
+ * Defining MPIMINI_X86_ACCEL adds x86-64 MULX/ADX versions of the
+ * multiply kernels, which are used if CPUID reports BMI2 and ADX. This
+ * needs x86cpu_mini.c to be linked in.
  */
 
 typedef struct
@@ -42,6 +53,9 @@ typedef struct
 extern void mpimul_mini ( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b );
 /* Multiply two numbers to give double-sized result */
 
+extern void mpisqr_mini ( ULong_Mini *res, const UInt_Mini *a );
+/* Squares a number to give double-sized result. Faster than mpimul_mini(res, a, a) */
+
 extern uint32_t mpiadd_mini( UInt_Mini *res, const UInt_Mini *a, const UInt_Mini *b );
 /* Returns carry-out from top digit (0 or 1) */
 
@@ -64,11 +78,46 @@ extern void mpisetval_mini( UInt_Mini *res, uint32_t val);
  */
 #ifdef MPIMINI_INTERNAL_API
 
+#ifdef MPIMINI_64BIT
+#if !defined(__SIZEOF_INT128__)
+#error "MPIMINI_64BIT needs a compiler with unsigned __int128"
+#endif
+#if (MPIMINI_DIGITS & 1) != 0
+#error "MPIMINI_64BIT needs an even number of digits"
+#endif
+
+#define MPIMINI_LIMBS (MPIMINI_DIGITS/2)
+typedef unsigned __int128 mpi_dlimb_mini_;
+
+static inline uint64_t mpi_getlimb_mini_( const uint32_t *d, int i )
+{
+  return ((uint64_t)d[2*i+1] << 32) | d[2*i];
+}
+/* Returns 64-bit limb i, made from digits 2i and 2i+1 */
+
+static inline void mpi_setlimb_mini_( uint32_t *d, int i, uint64_t v )
+{
+  d[2*i] = (uint32_t)v;
+  d[2*i+1] = (uint32_t)(v >> 32);
+}
+/* Stores 64-bit limb i into digits 2i and 2i+1 */
+
+#endif /* MPIMINI_64BIT */
+
 extern uint32_t mpi_mulrow_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB);
 /* Multiplies a row srcB[0..DIGITS-1] by word sA, and adds it into dst[0..DIGITS]
  * Returns the carry out of the top digit (i.e. will need to be added into dst[DIGITS+1]).
  */ 
 
+extern uint32_t mpi_mulrow_n_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB, int n);
+/* As mpi_mulrow_mini_, for a row srcB[0..n-1] of any length n >= 1: adds
+ * sA*srcB into dst[0..n] and returns the carry out of dst[n].
+ */
+
+extern int mpi_mulaccel_mini_(void);
+/* Returns nonzero if mpimul_mini is using the MULX/ADX kernels
+ * (only possible when built with MPIMINI_X86_ACCEL) */
+
 #endif
 
 #ifdef __cplusplus
@@ -1,15 +1,36 @@
 /*
  *
- * MPI subtract from Minicrypt library
+ * MPI add from Minicrypt library
  *
  * This program is placed into the public domain
  * by its author, Ian Harvey.
  * Note there is NO WARRANTY of any kind.
  */
 
+#define MPIMINI_INTERNAL_API
 #include "mpi_mini.h"
 
 
+#ifdef MPIMINI_64BIT
+
+uint32_t mpiadd_mini( UInt_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+{
+    int i;
+    uint64_t carry = 0;
+
+    for (i=0; i<MPIMINI_LIMBS; i++)
+    {
+      mpi_dlimb_mini_ r = (mpi_dlimb_mini_)mpi_getlimb_mini_(a->digits, i)
+                          + mpi_getlimb_mini_(b->digits, i) + carry;
+      mpi_setlimb_mini_(res->digits, i, (uint64_t)r);
+      carry = (uint64_t)(r >> 64);
+    }
+
+    return (uint32_t)carry;
+}
+
+#else /* 32-bit digits */
+
 uint32_t mpiadd_mini( UInt_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
 {
     int i;
@@ -28,6 +49,8 @@ uint32_t mpiadd_mini( UInt_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
     return carry;
 }
 
+#endif /* MPIMINI_64BIT */
+
 /* Test harness ======================================================= */
 #ifdef TEST_HARNESS
 
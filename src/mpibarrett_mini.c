@@ -0,0 +1,213 @@
+/*
+ *
+ * Barrett modular reduction from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpibarrett_mini.h"
+
+/* r = a - b over n digits; returns 0xFFFFFFFF if it borrowed, else 0 */
+static uint32_t sub_n( uint32_t *r, const uint32_t *a, const uint32_t *b, int n )
+{
+  uint32_t borrow = 0;
+  int i;
+
+  for (i=0; i<n; i++)
+  {
+    uint64_t t = (uint64_t)a[i] - b[i] - borrow;
+    r[i] = (uint32_t)t;
+    borrow = (uint32_t)(t >> 32) & 1;
+  }
+  return 0 - borrow;
+}
+
+MCResult mpibarrett_init_mini( MPIBarrett_Mini *ctx, const UInt_Mini *N )
+{
+  uint32_t r[MPIMINI_DIGITS+1], d[MPIMINI_DIGITS+1];
+  int i, k, bit;
+
+  for (k=MPIMINI_DIGITS; k > 0 && N->digits[k-1] == 0; k--)
+    ;
+  if ( k == 0 )
+    return MC_BAD_PARAMS;
+  for (i=0; i<k-1 && N->digits[i] == 0; i++)
+    ;
+  if ( i == k-1 && N->digits[k-1] == 1 )
+    return MC_BAD_PARAMS;  /* mu would be b^(k+1), one digit too long */
+
+  ctx->k = k;
+  for (i=0; i<=MPIMINI_DIGITS; i++)
+  {
+    ctx->N[i] = (i < k) ? N->digits[i] : 0;
+    ctx->mu[i] = 0;
+    r[i] = 0;
+  }
+
+  /* Long division of b^2k by N, a bit at a time. The remainder stays
+   * below N, so 2r+1 always fits in k+1 digits, and mu < b^(k+1) as N
+   * is more than b^(k-1).
+   */
+  for (bit = 64*k; bit >= 0; bit--)
+  {
+    uint32_t carry = (bit == 64*k) ? 1 : 0;
+    for (i=0; i<=k; i++)
+    {
+      uint32_t t = r[i];
+      r[i] = (t << 1) | carry;
+      carry = t >> 31;
+    }
+    if ( sub_n(d, r, ctx->N, k+1) == 0 )
+    {
+      for (i=0; i<=k; i++)
+        r[i] = d[i];
+      ctx->mu[bit >> 5] |= 1u << (bit & 31);
+    }
+  }
+  return MC_OK;
+}
+
+void mpibarrett_reduce_mini( const MPIBarrett_Mini *ctx, UInt_Mini *res, const ULong_Mini *x )
+{
+  uint32_t t[2*MPIMINI_DIGITS+2];
+  uint32_t r2[MPIMINI_DIGITS+2];
+  uint32_t r[MPIMINI_DIGITS+1], d[MPIMINI_DIGITS+1];
+  const uint32_t *q1 = &x->digits[ctx->k - 1];   /* floor(x / b^(k-1)), k+1 digits */
+  const uint32_t *q3;
+  int k = ctx->k;
+  int i, j;
+
+  /* q3 = floor(q1 * mu / b^(k+1)). Only products landing in digit k-1
+   * or above are added; the ones dropped add up to less than b^(k+1),
+   * so this q3 is at most one below the exact one. Each row's top digit
+   * is zero on entry, so the carries out can be ignored.
+   */
+  for (i=0; i < 2*k+2; i++)
+    t[i] = 0;
+  for (i=0; i <= k; i++)
+  {
+    j = (i < k-1) ? k-1-i : 0;
+    mpi_mulrow_n_mini_(&t[i+j], q1[i], &ctx->mu[j], k+1-j);
+  }
+  q3 = &t[k+1];
+
+  /* r2 = q3 * N mod b^(k+1); anything above digit k is dropped */
+  for (i=0; i < k+2; i++)
+    r2[i] = 0;
+  for (i=0; i <= k; i++)
+    mpi_mulrow_n_mini_(&r2[i], q3[i], ctx->N, k+1-i);
+
+  /* r = x - q3*N mod b^(k+1), which is now less than 4N */
+  sub_n(r, x->digits, r2, k+1);
+  for (j=0; j < 3; j++)
+  {
+    uint32_t keep = sub_n(d, r, ctx->N, k+1);
+    for (i=0; i <= k; i++)
+      r[i] = (r[i] & keep) | (d[i] & ~keep);
+  }
+
+  for (i=0; i < MPIMINI_DIGITS; i++)
+    res->digits[i] = (i < k) ? r[i] : 0;
+}
+
+void mpibarrett_mulmod_mini( const MPIBarrett_Mini *ctx, UInt_Mini *res,
+                             const UInt_Mini *a, const UInt_Mini *b )
+{
+  ULong_Mini p;
+
+  mpimul_mini(&p, a, b);
+  mpibarrett_reduce_mini(ctx, res, &p);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+  UInt_Mini N;
+  ULong_Mini x;
+  UInt_Mini res;
+}
+  MpiBarrett_TV;
+
+static const MpiBarrett_TV barrett_tvs[] =
+{
+#include "testvectors/mpibarrett.inc"
+};
+
+static const int barrett_tvs_count = sizeof(barrett_tvs) / sizeof(MpiBarrett_TV);
+
+static int test_params(void)
+{
+  MPIBarrett_Mini ctx;
+  UInt_Mini N;
+  int errs = 0;
+
+  mpisetval_mini(&N, 0);
+  if ( mpibarrett_init_mini(&ctx, &N) != MC_BAD_PARAMS )
+    errs++;
+  mpisetval_mini(&N, 1);
+  if ( mpibarrett_init_mini(&ctx, &N) != MC_BAD_PARAMS )
+    errs++;
+  N.digits[0] = 0;
+  N.digits[3] = 1;
+  if ( mpibarrett_init_mini(&ctx, &N) != MC_BAD_PARAMS )
+    errs++;
+  N.digits[0] = 2;
+  if ( mpibarrett_init_mini(&ctx, &N) != MC_OK )
+    errs++;
+  if ( errs )
+    printf("Parameter checks failed\n");
+  return errs;
+}
+
+int main(void)
+{
+  MPIBarrett_Mini ctx;
+  int i, errs;
+
+  errs = test_params();
+  for (i=0; i < barrett_tvs_count; i++)
+  {
+    const MpiBarrett_TV *tv = &barrett_tvs[i];
+    UInt_Mini res, one, nm1;
+
+    if ( mpibarrett_init_mini(&ctx, &tv->N) != MC_OK )
+    {
+      printf("Test #%d: init failed\n", i);
+      errs ++;
+      continue;
+    }
+
+    mpibarrett_reduce_mini(&ctx, &res, &tv->x);
+    if ( memcmp(&res, &tv->res, sizeof(res)) != 0 )
+    {
+      printf("Test #%d failed\n", i);
+      errs ++;
+      continue;
+    }
+
+    /* res * 1 = res, and (N-1)^2 = 1 mod N */
+    mpisetval_mini(&one, 1);
+    mpibarrett_mulmod_mini(&ctx, &res, &res, &one);
+    mpisub_mini(&nm1, &tv->N, &one);
+    mpibarrett_mulmod_mini(&ctx, &nm1, &nm1, &nm1);
+    if ( memcmp(&res, &tv->res, sizeof(res)) != 0
+         || memcmp(&nm1, &one, sizeof(one)) != 0 )
+    {
+      printf("Test #%d failed (mulmod)\n", i);
+      errs ++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, barrett_tvs_count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,56 @@
+#ifndef MPIBARRETT_MINI_H
+#define MPIBARRETT_MINI_H
+/*
+ * Barrett modular reduction from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "mpi_mini.h"
+
+/*
+ * A context holds a fixed modulus N (a UInt_Mini with k significant
+ * digits) and mu = floor(b^2k / N), where b = 2^32. Reducing a
+ * double-width value then takes two truncated multiplies and at most
+ * three subtractions of N, with no division and no conversion into or
+ * out of a special form. This suits values which arrive in normal form
+ * and are reduced only once; for long chains of multiplications,
+ * Montgomery form (mpimont_mini.h) is cheaper.
+ *
+ * Reduction runs in time which depends only on k. Setting up a context
+ * is not constant-time, but the modulus is usually public.
+ */
+
+typedef struct
+{
+  int k;                              /* Digits in N; N[k-1] is nonzero */
+  uint32_t N[MPIMINI_DIGITS+1];       /* N[k..] are zero */
+  uint32_t mu[MPIMINI_DIGITS+1];      /* floor(b^2k / N), k+1 digits */
+}
+  MPIBarrett_Mini;
+
+extern MCResult mpibarrett_init_mini( MPIBarrett_Mini *ctx, const UInt_Mini *N );
+/* Sets up a context for modulus N. Returns MC_BAD_PARAMS if N is zero or
+ * an exact power of b (including 1); those are better handled by masking. */
+
+extern void mpibarrett_reduce_mini( const MPIBarrett_Mini *ctx, UInt_Mini *res, const ULong_Mini *x );
+/* res = x mod N. x must be less than b^2k, which is true for any
+ * product of two values less than N. */
+
+extern void mpibarrett_mulmod_mini( const MPIBarrett_Mini *ctx, UInt_Mini *res,
+                                    const UInt_Mini *a, const UInt_Mini *b );
+/* res = a*b mod N, for a, b < N. res may be the same as a or b. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
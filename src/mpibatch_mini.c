@@ -0,0 +1,472 @@
+/*
+ *
+ * Batched modular multiplication from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpibatch_mini.h"
+
+#include <string.h>
+
+#if defined(MPIMINI_X86_ACCEL) && defined(__GNUC__) && defined(__x86_64__)
+# include "x86cpu_mini.h"
+# include <immintrin.h>
+# define MPIMINI_HAVE_X86 1
+#else
+# define MPIMINI_HAVE_X86 0
+#endif
+
+#define LIMBS MPIBATCH_MINI_LIMBS
+#define LANES MPIBATCH_MINI_LANES
+#define MASK28 0x0FFFFFFFu
+
+/* Kernels -----------------------------------------
+
+   A kernel of width NL does lanes lane..lane+NL-1, holding limb j of
+   those lanes in one VT. MUL multiplies the low 32 bits of each 64-bit
+   element to give a 64-bit result.
+
+   Word-by-word Montgomery with 28-bit limbs: each step adds a[i]*b and
+   m*N, which clears the bottom limb, and shifts down a limb. A limb of t
+   collects at most 2*LIMBS products of under 2^56 before it is shifted
+   out, so nothing overflows and carries are left until the end. */
+
+#define DEFINE_BATCH_KERNEL(NAME, VT, NL, MUL)                            \
+static void NAME( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res,       \
+                  const MPIBatch_Mini *a, const MPIBatch_Mini *b, int lane ) \
+{                                                                         \
+  VT t[LIMBS], B[LIMBS], N[LIMBS], d[LIMBS];                              \
+  VT zero = {0}, ai, m, c, keep;                                          \
+  int i, j;                                                               \
+                                                                          \
+  for (j=0; j < LIMBS; j++)                                               \
+  {                                                                       \
+    memcpy(&B[j], &b->limb[j][lane], sizeof(VT));                         \
+    N[j] = zero + ctx->N[j];                                              \
+    t[j] = zero;                                                          \
+  }                                                                       \
+                                                                          \
+  for (i=0; i < LIMBS; i++)                                               \
+  {                                                                       \
+    memcpy(&ai, &a->limb[i][lane], sizeof(VT));                           \
+    for (j=0; j < LIMBS; j++)                                             \
+      t[j] += MUL(ai, B[j]);                                              \
+    m = MUL(t[0] & MASK28, zero + ctx->n0inv) & MASK28;                   \
+    for (j=0; j < LIMBS; j++)                                             \
+      t[j] += MUL(m, N[j]);                                               \
+    c = t[0] >> 28;                                                       \
+    for (j=0; j < LIMBS-1; j++)                                           \
+      t[j] = t[j+1];                                                      \
+    t[0] += c;                                                            \
+    t[LIMBS-1] = zero;                                                    \
+  }                                                                       \
+                                                                          \
+  /* Propagate the carries; t is now less than 2N */                      \
+  c = zero;                                                               \
+  for (j=0; j < LIMBS; j++)                                               \
+  {                                                                       \
+    t[j] += c;                                                            \
+    c = t[j] >> 28;                                                       \
+    t[j] &= MASK28;                                                       \
+  }                                                                       \
+                                                                          \
+  /* d = t - N, and keep t if that borrowed */                            \
+  c = zero;                                                               \
+  for (j=0; j < LIMBS; j++)                                               \
+  {                                                                       \
+    d[j] = t[j] - N[j] - c;                                               \
+    c = d[j] >> 63;                                                       \
+    d[j] &= MASK28;                                                       \
+  }                                                                       \
+  keep = zero - c;                                                        \
+  for (j=0; j < LIMBS; j++)                                               \
+  {                                                                       \
+    VT r = (t[j] & keep) | (d[j] & ~keep);                                \
+    memcpy(&res->limb[j][lane], &r, sizeof(VT));                          \
+  }                                                                       \
+}
+
+#define MUL_SCALAR(x, y) ((x) * (y))
+
+DEFINE_BATCH_KERNEL(batch_generic, uint64_t, 1, MUL_SCALAR)
+
+#if MPIMINI_HAVE_X86
+
+typedef uint64_t V4 __attribute__((vector_size(32)));
+typedef uint64_t V8 __attribute__((vector_size(64)));
+
+#define MUL_AVX2(x, y)   ((V4)_mm256_mul_epu32((__m256i)(x), (__m256i)(y)))
+#define MUL_AVX512(x, y) ((V8)_mm512_mul_epu32((__m512i)(x), (__m512i)(y)))
+
+__attribute__((target("avx2")))
+DEFINE_BATCH_KERNEL(batch_avx2, V4, 4, MUL_AVX2)
+
+__attribute__((target("avx512f")))
+DEFINE_BATCH_KERNEL(batch_avx512, V8, 8, MUL_AVX512)
+
+static int cpu_has_avx2(void)
+{
+  return (X86Mini_features() & X86MINI_AVX2) != 0;
+}
+
+static int cpu_has_avx512(void)
+{
+  return (X86Mini_features() & X86MINI_AVX512F) != 0;
+}
+
+#endif /* MPIMINI_HAVE_X86 */
+
+/* Kernel selection ------------------------------- */
+
+typedef struct
+{
+  const char *name;
+  int width;
+  void (*fn)( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res,
+              const MPIBatch_Mini *a, const MPIBatch_Mini *b, int lane );
+  int (*supported)(void);
+}
+  BatchImpl;
+
+static int always(void)
+{
+  return 1;
+}
+
+/* Best first */
+static const BatchImpl impls[] =
+{
+#if MPIMINI_HAVE_X86
+  { "avx512f x8", 8, batch_avx512, cpu_has_avx512 },
+  { "avx2 x4", 4, batch_avx2, cpu_has_avx2 },
+#endif
+  { "generic x1", 1, batch_generic, always },
+  { NULL, 0, NULL, NULL }
+};
+
+static const BatchImpl *batch_impl = NULL;
+
+static const BatchImpl *select_impl(void)
+{
+  /* Racing threads all pick the same entry; the atomics just
+     keep the unsynchronised access well defined */
+  const BatchImpl *bi = __atomic_load_n(&batch_impl, __ATOMIC_RELAXED);
+
+  if ( bi == NULL )
+  {
+    bi = impls;
+    while ( !bi->supported() )
+      bi++;
+    __atomic_store_n(&batch_impl, bi, __ATOMIC_RELAXED);
+  }
+  return bi;
+}
+
+const char *mpibatch_impl_mini_(void)
+{
+  return select_impl()->name;
+}
+
+
+/* API --------------------------------------------- */
+
+/* Bits 28j..28j+27 of a */
+static uint64_t get_limb( const UInt_Mini *a, int j )
+{
+  int d = (28*j) >> 5, s = (28*j) & 31;
+  uint64_t v = a->digits[d] >> s;
+
+  if ( s > 4 && d+1 < MPIMINI_DIGITS )
+    v |= (uint64_t)a->digits[d+1] << (32-s);
+  return v & MASK28;
+}
+
+MCResult mpibatch_init_mini( MPIBatchMont_Mini *ctx, const UInt_Mini *N )
+{
+  UInt_Mini r, d, rr[LANES];
+  uint32_t x, carry, borrow;
+  int i;
+
+  mpisetval_mini(&r, 1);
+  if ( (N->digits[0] & 1) == 0 || mpicmp_mini(N, &r) == 0 )
+    return MC_BAD_PARAMS;
+
+  for (i=0; i < LIMBS; i++)
+    ctx->N[i] = get_limb(N, i);
+
+  /* -N^-1 mod 2^32 by Newton iteration, which is also right mod 2^28 */
+  x = 1;
+  for (i=0; i < 5; i++)
+    x *= 2 - N->digits[0] * x;
+  ctx->n0inv = (0 - x) & MASK28;
+
+  /* R^2 = 2^560 mod N, by doubling 1 */
+  for (i=0; i < 2*28*LIMBS; i++)
+  {
+    carry = mpiadd_mini(&r, &r, &r);
+    borrow = mpisub_mini(&d, &r, N);
+    if ( carry || !borrow )
+      r = d;
+  }
+  for (i=0; i < LANES; i++)
+    rr[i] = r;
+  mpibatch_load_mini(&ctx->RR, rr, LANES);
+  return MC_OK;
+}
+
+void mpibatch_load_mini( MPIBatch_Mini *dst, const UInt_Mini *src, int count )
+{
+  int i, j;
+
+  for (i=0; i < LANES; i++)
+    for (j=0; j < LIMBS; j++)
+      dst->limb[j][i] = (i < count) ? get_limb(&src[i], j) : 0;
+}
+
+void mpibatch_store_mini( UInt_Mini *dst, const MPIBatch_Mini *src, int count )
+{
+  int i, j;
+
+  for (i=0; i < count; i++)
+  {
+    mpisetval_mini(&dst[i], 0);
+    for (j=0; j < LIMBS; j++)
+    {
+      uint64_t v = src->limb[j][i];
+      int d = (28*j) >> 5, s = (28*j) & 31;
+
+      dst[i].digits[d] |= (uint32_t)(v << s);
+      if ( s > 4 && d+1 < MPIMINI_DIGITS )
+        dst[i].digits[d+1] |= (uint32_t)(v >> (32-s));
+    }
+  }
+}
+
+void mpibatch_mul_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res,
+                        const MPIBatch_Mini *a, const MPIBatch_Mini *b )
+{
+  const BatchImpl *bi = select_impl();
+  int lane;
+
+  for (lane=0; lane < LANES; lane += bi->width)
+    bi->fn(ctx, res, a, b, lane);
+}
+
+void mpibatch_to_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res, const MPIBatch_Mini *a )
+{
+  mpibatch_mul_mini(ctx, res, a, &ctx->RR);
+}
+
+void mpibatch_from_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res, const MPIBatch_Mini *a )
+{
+  MPIBatch_Mini one;
+  int i, j;
+
+  for (j=0; j < LIMBS; j++)
+    for (i=0; i < LANES; i++)
+      one.limb[j][i] = (j == 0) ? 1 : 0;
+  mpibatch_mul_mini(ctx, res, a, &one);
+}
+
+void mpibatch_mulmod_mini( const MPIBatchMont_Mini *ctx, UInt_Mini *res,
+                           const UInt_Mini *a, const UInt_Mini *b, size_t count )
+{
+  MPIBatch_Mini ba, bb;
+  int n;
+
+  /* (a*b*R^-1) * R^2 * R^-1 = a*b, without converting a or b */
+  while ( count > 0 )
+  {
+    n = (count < LANES) ? (int)count : LANES;
+    mpibatch_load_mini(&ba, a, n);
+    mpibatch_load_mini(&bb, b, n);
+    mpibatch_mul_mini(ctx, &ba, &ba, &bb);
+    mpibatch_mul_mini(ctx, &ba, &ba, &ctx->RR);
+    mpibatch_store_mini(res, &ba, n);
+    res += n;
+    a += n;
+    b += n;
+    count -= n;
+  }
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include "mpibarrett_mini.h"
+#include "mpimont_mini.h"
+
+#include <stdio.h>
+#include <time.h>
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rnd32(void)
+{
+  /* xorshift32, good enough for picking test values */
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static const UInt_Mini moduli[] =
+{
+  /* P-256, its group order, and 2^255-19 */
+  {{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF }},
+  {{ 0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF }},
+  {{ 0xFFFFFFED, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF }},
+  /* 2^256-1, and some small ones */
+  {{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }},
+  {{ 0x9ABCDEF1, 0x12345678, 0x0000000F, 0, 0, 0, 0, 0 }},
+  {{ 3, 0, 0, 0, 0, 0, 0, 0 }},
+};
+
+static const int moduli_count = sizeof(moduli) / sizeof(UInt_Mini);
+
+/* Random value below N, with some all-ones and zero digits */
+static void rnd_below( UInt_Mini *a, const UInt_Mini *N )
+{
+  MPIBarrett_Mini bctx;
+  ULong_Mini x;
+  uint32_t kind = rnd32() & 7;
+  int i;
+
+  for (i=0; i < 2*MPIMINI_DIGITS; i++)
+    x.digits[i] = (i >= MPIMINI_DIGITS) ? 0 : (kind == 0) ? 0xFFFFFFFF : (kind == 1) ? 0 : rnd32();
+  mpibarrett_init_mini(&bctx, N);
+  mpibarrett_reduce_mini(&bctx, a, &x);
+}
+
+static int test_params(void)
+{
+  MPIBatchMont_Mini ctx;
+  UInt_Mini N;
+  int errs = 0;
+
+  mpisetval_mini(&N, 1);
+  if ( mpibatch_init_mini(&ctx, &N) != MC_BAD_PARAMS )
+    errs++;
+  mpisetval_mini(&N, 0x100);
+  if ( mpibatch_init_mini(&ctx, &N) != MC_BAD_PARAMS )
+    errs++;
+  if ( errs )
+    printf("Parameter checks failed\n");
+  return errs;
+}
+
+static int run_tests(void)
+{
+  static MPIBatchMont_Mini ctx;
+  MPIBarrett_Mini bctx;
+  UInt_Mini a[21], b[21], r[21], ref, back[LANES];
+  MPIBatch_Mini ba, bb;
+  int m, k, i, errs = 0;
+
+  for (m=0; m < moduli_count; m++)
+  {
+    const UInt_Mini *N = &moduli[m];
+
+    mpibatch_init_mini(&ctx, N);
+    mpibarrett_init_mini(&bctx, N);
+
+    for (k=0; k < 20; k++)
+    {
+      /* An odd count, to get a short last batch */
+      for (i=0; i < 21; i++)
+      {
+        rnd_below(&a[i], N);
+        rnd_below(&b[i], N);
+      }
+      mpibatch_mulmod_mini(&ctx, r, a, b, 21);
+      for (i=0; i < 21; i++)
+      {
+        mpibarrett_mulmod_mini(&bctx, &ref, &a[i], &b[i]);
+        if ( memcmp(&r[i], &ref, sizeof(ref)) != 0 )
+        {
+          printf("Modulus #%d, test %d, lane %d failed (mulmod)\n", m, k, i);
+          errs++;
+        }
+      }
+
+      /* Through Montgomery form and back, in place */
+      mpibatch_load_mini(&ba, a, LANES);
+      mpibatch_load_mini(&bb, b, LANES);
+      mpibatch_to_mini(&ctx, &ba, &ba);
+      mpibatch_to_mini(&ctx, &bb, &bb);
+      mpibatch_mul_mini(&ctx, &bb, &ba, &bb);
+      mpibatch_from_mini(&ctx, &ba, &ba);
+      mpibatch_from_mini(&ctx, &bb, &bb);
+      mpibatch_store_mini(back, &ba, LANES);
+      if ( memcmp(back, a, sizeof(back)) != 0 )
+      {
+        printf("Modulus #%d, test %d failed (to/from)\n", m, k);
+        errs++;
+      }
+      mpibatch_store_mini(back, &bb, LANES);
+      if ( memcmp(back, r, sizeof(back)) != 0 )
+      {
+        printf("Modulus #%d, test %d failed (mul)\n", m, k);
+        errs++;
+      }
+    }
+  }
+  return errs;
+}
+
+static void bench(void)
+{
+  static MPIBatchMont_Mini ctx;
+  static MPIMont_Mini mctx;
+  UInt_Mini a[LANES];
+  MPIBatch_Mini ba;
+  clock_t start;
+  int i, count = 200000;
+
+  mpibatch_init_mini(&ctx, &moduli[0]);
+  for (i=0; i < LANES; i++)
+    rnd_below(&a[i], &moduli[0]);
+  mpibatch_load_mini(&ba, a, LANES);
+  start = clock();
+  for (i=0; i < count; i++)
+    mpibatch_mul_mini(&ctx, &ba, &ba, &ba);
+  printf("[%s] %.1f ns per modular multiply", mpibatch_impl_mini_(),
+         (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count / LANES);
+
+  mpimont_init_mini(&mctx, moduli[0].digits, MPIMINI_DIGITS);
+  start = clock();
+  for (i=0; i < count; i++)
+    mpimont_mul_mini(&mctx, a[0].digits, a[0].digits, a[0].digits);
+  printf(", mpimont_mul_mini %.1f ns\n",
+         (double)(clock() - start) * 1e9 / CLOCKS_PER_SEC / count);
+}
+
+int main( int argc, char **argv )
+{
+  const BatchImpl *bi;
+  int errs, kerrs;
+
+  errs = test_params();
+  for (bi=&impls[0]; bi->name != NULL; bi++)
+  {
+    if ( !bi->supported() )
+    {
+      printf("[%s] not supported on this CPU\n", bi->name);
+      continue;
+    }
+    batch_impl = bi;
+    kerrs = run_tests();
+    printf("[%s] %d errors\n", bi->name, kerrs);
+    errs += kerrs;
+    if ( argc > 1 && strcmp(argv[1], "-b") == 0 )
+      bench();
+  }
+
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
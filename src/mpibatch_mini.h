@@ -0,0 +1,98 @@
+#ifndef MPIBATCH_MINI_H
+#define MPIBATCH_MINI_H
+/*
+ * Batched modular multiplication from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "mpi_mini.h"
+
+/*
+ * Montgomery multiplication modulo one odd N < 2^256 for up to eight
+ * independent operand pairs at once.
+ *
+ * An MPIBatch_Mini holds eight values "limb-sliced": limb[j][lane] is
+ * bits 28j..28j+27 of that lane's value, each in a 64-bit word. With the
+ * limbs this short, every partial product sum fits in 64 bits without
+ * propagating carries, so all lanes can be multiplied together with
+ * 32x32->64 vector multiplies (VPMULUDQ). mpibatch_load_mini() and
+ * mpibatch_store_mini() convert between this and UInt_Mini.
+ *
+ * Montgomery form here uses R = 2^280, so it is not interchangeable with
+ * mpimont_mini.h values; use mpibatch_to_mini() and mpibatch_from_mini().
+ *
+ * When built with MPIMINI_X86_ACCEL (and x86cpu_mini.c), AVX-512F does
+ * all eight lanes in one pass and AVX2 does them four at a time,
+ * whichever the CPU supports; otherwise one lane at a time in plain C.
+ * All of them run in time independent of the values.
+ */
+
+#define MPIBATCH_MINI_LANES 8
+#define MPIBATCH_MINI_LIMBS 10      /* 28-bit limbs, 280 bits */
+
+typedef struct
+{
+  uint64_t limb[MPIBATCH_MINI_LIMBS][MPIBATCH_MINI_LANES];
+}
+  MPIBatch_Mini;
+
+typedef struct
+{
+  uint64_t N[MPIBATCH_MINI_LIMBS];
+  uint64_t n0inv;                     /* -N^-1 mod 2^28 */
+  MPIBatch_Mini RR;                   /* R^2 mod N in every lane */
+}
+  MPIBatchMont_Mini;
+
+extern MCResult mpibatch_init_mini( MPIBatchMont_Mini *ctx, const UInt_Mini *N );
+/* Sets up a context for modulus N. Returns MC_BAD_PARAMS if N is even or 1. */
+
+extern void mpibatch_load_mini( MPIBatch_Mini *dst, const UInt_Mini *src, int count );
+/* Transposes src[0..count-1] into lanes 0..count-1 of dst; count is at most
+ * MPIBATCH_MINI_LANES, and any lanes above it are set to zero. */
+
+extern void mpibatch_store_mini( UInt_Mini *dst, const MPIBatch_Mini *src, int count );
+/* Transposes lanes 0..count-1 of src out into dst[0..count-1] */
+
+extern void mpibatch_mul_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res,
+                               const MPIBatch_Mini *a, const MPIBatch_Mini *b );
+/* res = a*b*R^-1 mod N in each lane, for a, b < N. res may be the same as a or b. */
+
+extern void mpibatch_to_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res, const MPIBatch_Mini *a );
+/* res = a*R mod N in each lane, i.e. converts into Montgomery form */
+
+extern void mpibatch_from_mini( const MPIBatchMont_Mini *ctx, MPIBatch_Mini *res, const MPIBatch_Mini *a );
+/* res = a*R^-1 mod N in each lane, i.e. converts out of Montgomery form */
+
+extern void mpibatch_mulmod_mini( const MPIBatchMont_Mini *ctx, UInt_Mini *res,
+                                  const UInt_Mini *a, const UInt_Mini *b, size_t count );
+/* res[i] = a[i]*b[i] mod N for i in 0..count-1, for a[i], b[i] < N. Does
+ * the transposes and conversions itself, eight at a time. */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef MPIMINI_INTERNAL_API
+
+extern const char *mpibatch_impl_mini_(void);
+/* Name of the kernel in use, e.g. "avx512f x8" */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
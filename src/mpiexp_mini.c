@@ -0,0 +1,252 @@
+/*
+ *
+ * Modular exponentiation from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpiexp_mini.h"
+
+#define MAX_DIGITS MPIMONT_MINI_MAX_DIGITS
+#define TABLE_SIZE (1 << MPIEXP_MINI_MAX_WINDOW)
+
+int mpiexp_window_mini_( int expbits )
+{
+  int w;
+
+  /* Roughly where the table setup cost is paid back by fewer multiplies */
+  if ( expbits > 671 )
+    w = 6;
+  else if ( expbits > 239 )
+    w = 5;
+  else if ( expbits > 79 )
+    w = 4;
+  else if ( expbits > 23 )
+    w = 3;
+  else
+    w = 1;
+  return (w > MPIEXP_MINI_MAX_WINDOW) ? MPIEXP_MINI_MAX_WINDOW : w;
+}
+
+static int getbit( const uint32_t *exp, int i )
+{
+  return (exp[i >> 5] >> (i & 31)) & 1;
+}
+
+static void set_one( uint32_t *res, int n )
+{
+  int i;
+
+  res[0] = 1;
+  for (i=1; i<n; i++)
+    res[i] = 0;
+}
+
+/* Sliding window ----------------------------------- */
+
+void mpiexp_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *base,
+                  const uint32_t *exp, int expdigits )
+{
+  uint32_t table[TABLE_SIZE/2][MAX_DIGITS]; /* base^1, base^3, base^5 ... */
+  uint32_t acc[MAX_DIGITS];
+  int n = ctx->n;
+  int i, j, k, w, started;
+
+  i = 32*expdigits - 1;
+  while ( i >= 0 && !getbit(exp, i) )
+    i--;
+  if ( i < 0 )
+  {
+    set_one(res, n);
+    return;
+  }
+
+  w = mpiexp_window_mini_(i+1);
+  mpimont_to_mini(ctx, table[0], base);
+  if ( w > 1 )
+  {
+    mpimont_sqr_mini(ctx, acc, table[0]);
+    for (k=1; k < (1 << (w-1)); k++)
+      mpimont_mul_mini(ctx, table[k], table[k-1], acc);
+  }
+
+  /* i is the top set bit still to do. Each window runs from bit i down
+   * to the lowest set bit j within w bits of it, so its value is odd.
+   */
+  started = 0;
+  while ( i >= 0 )
+  {
+    uint32_t v = 0;
+
+    if ( !getbit(exp, i) )
+    {
+      mpimont_sqr_mini(ctx, acc, acc);
+      i--;
+      continue;
+    }
+
+    j = (i >= w-1) ? i-w+1 : 0;
+    while ( !getbit(exp, j) )
+      j++;
+    for (k=i; k >= j; k--)
+      v = (v << 1) | getbit(exp, k);
+
+    if ( started )
+    {
+      for (k=i; k >= j; k--)
+        mpimont_sqr_mini(ctx, acc, acc);
+      mpimont_mul_mini(ctx, acc, acc, table[v >> 1]);
+    }
+    else
+    {
+      for (k=0; k<n; k++)
+        acc[k] = table[v >> 1][k];
+      started = 1;
+    }
+    i = j-1;
+  }
+
+  mpimont_from_mini(ctx, res, acc);
+}
+
+/* Fixed window, constant-time ---------------------- */
+
+/* Returns bits pos..pos+w-1 of exp; bits above the top digit are zero.
+ * Only the bit positions affect the timing, not their values. */
+static uint32_t getbits( const uint32_t *exp, int expdigits, int pos, int w )
+{
+  uint32_t v = 0;
+  int k;
+
+  for (k=w-1; k >= 0; k--)
+  {
+    v <<= 1;
+    if ( pos+k < 32*expdigits )
+      v |= getbit(exp, pos+k);
+  }
+  return v;
+}
+
+/* res = table[v], reading every entry */
+static void select_entry( uint32_t *res, const uint32_t table[][MAX_DIGITS],
+                          int size, uint32_t v, int n )
+{
+  int i, k;
+
+  for (i=0; i<n; i++)
+    res[i] = 0;
+  for (k=0; k<size; k++)
+  {
+    uint32_t d = (uint32_t)k ^ v;
+    uint32_t mask = ((d | (0 - d)) >> 31) - 1;  /* All-ones if k == v */
+    for (i=0; i<n; i++)
+      res[i] |= table[k][i] & mask;
+  }
+}
+
+void mpiexp_ct_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *base,
+                     const uint32_t *exp, int expdigits )
+{
+  uint32_t table[TABLE_SIZE][MAX_DIGITS]; /* base^0, base^1, base^2 ... */
+  uint32_t acc[MAX_DIGITS], t[MAX_DIGITS];
+  int n = ctx->n;
+  int nbits = 32*expdigits;
+  int k, w, size, pos;
+
+  if ( nbits <= 0 )
+  {
+    set_one(res, n);
+    return;
+  }
+
+  w = mpiexp_window_mini_(nbits);
+  size = 1 << w;
+  mpimont_from_mini(ctx, table[0], ctx->RR);   /* R mod N, i.e. 1 */
+  mpimont_to_mini(ctx, table[1], base);
+  for (k=2; k < size; k++)
+    mpimont_mul_mini(ctx, table[k], table[k-1], table[1]);
+
+  pos = ((nbits + w - 1) / w - 1) * w;
+  select_entry(acc, (const uint32_t (*)[MAX_DIGITS])table, size,
+               getbits(exp, expdigits, pos, w), n);
+  for (pos -= w; pos >= 0; pos -= w)
+  {
+    for (k=0; k<w; k++)
+      mpimont_sqr_mini(ctx, acc, acc);
+    select_entry(t, (const uint32_t (*)[MAX_DIGITS])table, size,
+                 getbits(exp, expdigits, pos, w), n);
+    mpimont_mul_mini(ctx, acc, acc, t);
+  }
+
+  mpimont_from_mini(ctx, res, acc);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+  int n;
+  int en;
+  uint32_t N[MAX_DIGITS];
+  uint32_t base[MAX_DIGITS];
+  uint32_t exp[MAX_DIGITS];
+  uint32_t res[MAX_DIGITS];
+}
+  MpiExp_TV;
+
+static const MpiExp_TV exp_tvs[] =
+{
+#include "testvectors/mpiexp.inc"
+};
+
+static const int exp_tvs_count = sizeof(exp_tvs) / sizeof(MpiExp_TV);
+
+int main(void)
+{
+  static MPIMont_Mini ctx;
+  int i, errs;
+
+  errs = 0;
+  for (i=0; i < exp_tvs_count; i++)
+  {
+    const MpiExp_TV *tv = &exp_tvs[i];
+    size_t len = tv->n * sizeof(uint32_t);
+    uint32_t r[MAX_DIGITS];
+
+    if ( mpimont_init_mini(&ctx, tv->N, tv->n) != MC_OK )
+    {
+      printf("Test #%d: init failed\n", i);
+      errs++;
+      continue;
+    }
+
+    mpiexp_mini(&ctx, r, tv->base, tv->exp, tv->en);
+    if ( memcmp(r, tv->res, len) != 0 )
+    {
+      printf("Test #%d failed (sliding)\n", i);
+      errs++;
+      continue;
+    }
+
+    /* In place, this time */
+    memcpy(r, tv->base, len);
+    mpiexp_ct_mini(&ctx, r, r, tv->exp, tv->en);
+    if ( memcmp(r, tv->res, len) != 0 )
+    {
+      printf("Test #%d failed (fixed)\n", i);
+      errs++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, exp_tvs_count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
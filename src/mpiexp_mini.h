@@ -0,0 +1,68 @@
+#ifndef MPIEXP_MINI_H
+#define MPIEXP_MINI_H
+/*
+ * Modular exponentiation from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "mpimont_mini.h"
+
+/*
+ * Both functions compute base^exp mod N, with N taken from a Montgomery
+ * context (see mpimont_mini.h). 'base' and 'res' are n-digit numbers in
+ * normal form, with base < N; 'exp' has its own length, expdigits, which
+ * may be more or less than n. res may be the same as base.
+ *
+ * mpiexp_mini() uses a sliding window over a table of odd powers of the
+ * base, with the window size chosen from the exponent length. Its timing
+ * depends on the exponent, so use it only for public exponents (e.g.
+ * RSA verification).
+ *
+ * mpiexp_ct_mini() uses fixed windows, and reads every table entry on
+ * every lookup, keeping the ones it wants with a mask. Its timing and
+ * memory accesses depend only on n and expdigits, so it is suitable
+ * for secret exponents.
+ *
+ * The table is on the stack: up to 2^MPIEXP_MINI_MAX_WINDOW entries of
+ * n digits.
+ */
+
+#ifndef MPIEXP_MINI_MAX_WINDOW
+#define MPIEXP_MINI_MAX_WINDOW 5
+#endif
+
+extern void mpiexp_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *base,
+                         const uint32_t *exp, int expdigits );
+/* res = base^exp mod N. Not constant-time! */
+
+extern void mpiexp_ct_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *base,
+                            const uint32_t *exp, int expdigits );
+/* res = base^exp mod N, in constant time */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef MPIMINI_INTERNAL_API
+
+extern int mpiexp_window_mini_( int expbits );
+/* Returns the window size to use for an exponent of 'expbits' bits */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
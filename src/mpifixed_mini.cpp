@@ -0,0 +1,354 @@
+/*
+ *
+ * Fixed-size multiprecision templates from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+/* The templates are all in mpifixed_mini.hpp; this file holds their
+ * test harness, which checks them against the C functions. */
+
+#include "mpifixed_mini.hpp"
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include "mpin_mini.h"
+#include "mpimont_mini.h"
+
+#include <stdio.h>
+#include <time.h>
+
+using namespace minicrypt;
+
+typedef struct
+{
+  UInt_Mini a;
+  UInt_Mini b;
+  ULong_Mini res;
+}
+  MpiMul_TV;
+
+static const MpiMul_TV mul_tvs[] =
+{
+#include "testvectors/mpimul.inc"
+};
+
+static const int mul_tvs_count = sizeof(mul_tvs) / sizeof(MpiMul_TV);
+
+static uint64_t rng_state = 0x0123456789abcdefULL;
+
+static uint32_t rnd32()
+{
+  /* xorshift64*, good enough for picking test values */
+  rng_state ^= rng_state >> 12;
+  rng_state ^= rng_state << 25;
+  rng_state ^= rng_state >> 27;
+  return (uint32_t)((rng_state * 0x2545F4914F6CDD1DULL) >> 32);
+}
+
+/* Random value of up to Bits bits; sometimes all-ones or zero, to get
+ * the carries going */
+template <unsigned Bits>
+static void rnd( FixedUInt<Bits> &a )
+{
+  uint32_t kind = rnd32() & 15;
+
+  for (int i=0; i < FixedUInt<Bits>::DIGITS; i++)
+    a.digits[i] = (kind == 0) ? 0xFFFFFFFF : (kind == 1) ? 0 : rnd32();
+  if ( Bits % 32 )
+    a.digits[FixedUInt<Bits>::DIGITS-1] &= (1u << (Bits % 32)) - 1;
+}
+
+/* Moduli ------------------------------------------ */
+
+struct P256
+{
+  static constexpr FixedUInt<256> value =
+    {{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x00000000,
+       0x00000000, 0x00000000, 0x00000001, 0xFFFFFFFF }};
+};
+
+struct P384
+{
+  static constexpr FixedUInt<384> value =
+    {{ 0xFFFFFFFF, 0x00000000, 0x00000000, 0xFFFFFFFF,
+       0xFFFFFFFE, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+       0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF }};
+};
+
+struct P521
+{
+  static constexpr FixedUInt<521> value =
+    {{ 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+       0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+       0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x000001FF }};
+};
+
+struct P25519
+{
+  static constexpr FixedUInt<255> value =
+    {{ 0xFFFFFFED, 0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF,
+       0xFFFFFFFF, 0xFFFFFFFF, 0xFFFFFFFF, 0x7FFFFFFF }};
+};
+
+/* The group order of P-256, whose low digit gives a less trivial n0inv */
+struct N256
+{
+  static constexpr FixedUInt<256> value =
+    {{ 0xFC632551, 0xF3B9CAC2, 0xA7179E84, 0xBCE6FAAD,
+       0xFFFFFFFF, 0xFFFFFFFF, 0x00000000, 0xFFFFFFFF }};
+};
+
+static_assert(ModInt<P256>::n0inv == 1, "n0inv for P-256");
+static_assert(ModInt<N256>::n0inv == 0xEE00BC4F, "n0inv for the P-256 order");
+static_assert(ModInt<P25519>::RR.digits[0] == 0x5A4 && ModInt<P25519>::RR.digits[1] == 0,
+              "R^2 mod 2^255-19 is 38^2");
+
+/* Tests ------------------------------------------- */
+
+static int test_c_vectors()
+{
+  int i, errs = 0;
+
+  for (i=0; i < mul_tvs_count; i++)
+  {
+    const MpiMul_TV *tv = &mul_tvs[i];
+    FixedUInt<512> r;
+
+    mul(r, from_mini(tv->a), from_mini(tv->b));
+    if ( memcmp(r.digits, tv->res.digits, sizeof(r.digits)) != 0 )
+    {
+      printf("Vector #%d failed (mul)\n", i);
+      errs++;
+    }
+  }
+
+  /* Against the C add, sub and square */
+  for (i=0; i < 1000; i++)
+  {
+    FixedUInt<256> a, b, r;
+    FixedUInt<512> r2;
+    UInt_Mini ca, cb, cr;
+    ULong_Mini cr2;
+    uint32_t c, cc;
+
+    rnd(a);
+    rnd(b);
+    ca = to_mini(a);
+    cb = to_mini(b);
+
+    c = add(r, a, b);
+    cc = mpiadd_mini(&cr, &ca, &cb);
+    if ( c != cc || memcmp(r.digits, cr.digits, sizeof(cr)) != 0 )
+    {
+      printf("Random #%d failed (add)\n", i);
+      errs++;
+    }
+    c = sub(r, a, b);
+    cc = mpisub_mini(&cr, &ca, &cb);
+    if ( c != cc || memcmp(r.digits, cr.digits, sizeof(cr)) != 0 )
+    {
+      printf("Random #%d failed (sub)\n", i);
+      errs++;
+    }
+    sqr(r2, a);
+    mpisqr_mini(&cr2, &ca);
+    if ( memcmp(r2.digits, cr2.digits, sizeof(cr2)) != 0 )
+    {
+      printf("Random #%d failed (sqr)\n", i);
+      errs++;
+    }
+  }
+  return errs;
+}
+
+/* Other sizes, against the variable-length code */
+template <unsigned Bits>
+static int test_size()
+{
+  constexpr int D = FixedUInt<Bits>::DIGITS;
+  uint32_t scratch[MPINMINI_SCRATCH_DIGITS(D)];
+  uint32_t cr[2*D];
+  int i, errs = 0;
+
+  for (i=0; i < 200; i++)
+  {
+    FixedUInt<Bits> a, b, r;
+    FixedUIntWide<Bits> r2;
+    uint32_t c;
+
+    rnd(a);
+    rnd(b);
+
+    c = add(r, a, b);
+    if ( c != mpin_add_mini(cr, a.digits, b.digits, D) || memcmp(r.digits, cr, sizeof(r)) != 0 )
+      errs++;
+    c = sub(r, a, b);
+    if ( c != mpin_sub_mini(cr, a.digits, b.digits, D) || memcmp(r.digits, cr, sizeof(r)) != 0 )
+      errs++;
+    mul(r2, a, b);
+    mpin_mul_mini(cr, a.digits, b.digits, D, scratch);
+    if ( memcmp(r2.digits, cr, sizeof(r2)) != 0 )
+      errs++;
+    sqr(r2, a);
+    mpin_sqr_mini(cr, a.digits, D, scratch);
+    if ( memcmp(r2.digits, cr, sizeof(r2)) != 0 )
+      errs++;
+  }
+  if ( errs )
+    printf("%u-bit: %d errors\n", Bits, errs);
+  return errs;
+}
+
+/* ModInt, against the Montgomery context */
+template <class Modulus>
+static int test_mod( const char *name )
+{
+  using M = ModInt<Modulus>;
+  using UInt = typename M::UInt;
+  constexpr int D = M::DIGITS;
+  static MPIMont_Mini ctx;
+  int i, errs = 0;
+
+  if ( mpimont_init_mini(&ctx, M::N.digits, D) != MC_OK
+       || ctx.n0inv != M::n0inv || memcmp(ctx.RR, M::RR.digits, sizeof(UInt)) != 0 )
+  {
+    printf("%s: constants differ\n", name);
+    return 1;
+  }
+
+  for (i=0; i < 200; i++)
+  {
+    UInt a, b, s, d;
+    uint32_t ma[D], mb[D], cr[D];
+
+    /* from() takes anything, and reduces it */
+    rnd(a);
+    rnd(b);
+    M x = M::from(a), y = M::from(b);
+
+    a = x.value();
+    b = y.value();
+    if ( mpin_cmp_mini(a.digits, M::N.digits, D) >= 0 || M::from(a) != x )
+      errs++;
+
+    mpimont_to_mini(&ctx, ma, a.digits);
+    mpimont_to_mini(&ctx, mb, b.digits);
+    if ( memcmp(x.mont().digits, ma, sizeof(ma)) != 0 )
+      errs++;
+
+    mpimont_mul_mini(&ctx, cr, ma, mb);
+    if ( memcmp((x*y).mont().digits, cr, sizeof(cr)) != 0 )
+      errs++;
+    mpimont_sqr_mini(&ctx, cr, ma);
+    if ( memcmp(x.sqr().mont().digits, cr, sizeof(cr)) != 0 || x.sqr() != x*x )
+      errs++;
+
+    /* a+b and a-b, fully reduced */
+    uint32_t c = add(s, a, b);
+    uint32_t borrow = sub(d, s, M::N);
+    if ( c || !borrow )
+      s = d;
+    if ( memcmp((x+y).value().digits, s.digits, sizeof(s)) != 0 || (x+y)-y != x )
+      errs++;
+    if ( (x-y)+y != x || (x-x) != M::zero() )
+      errs++;
+  }
+  if ( errs )
+    printf("%s: %d errors\n", name, errs);
+  return errs;
+}
+
+/* Benchmarks -------------------------------------- */
+
+static double usec( clock_t start, int count )
+{
+  return (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / count;
+}
+
+template <class Modulus>
+static void bench_mod( const char *name )
+{
+  using M = ModInt<Modulus>;
+  static MPIMont_Mini ctx;
+  typename M::UInt a;
+  int i, count = 1000000;
+  clock_t start;
+
+  rnd(a);
+  M x = M::from(a), y = x;
+  start = clock();
+  for (i=0; i < count; i++)
+    x = x * y;
+  printf("%s ModInt mul: %.3f us", name, usec(start, count));
+
+  mpimont_init_mini(&ctx, M::N.digits, M::DIGITS);
+  memcpy(a.digits, x.mont().digits, sizeof(a));
+  start = clock();
+  for (i=0; i < count; i++)
+    mpimont_mul_mini(&ctx, a.digits, a.digits, y.mont().digits);
+  printf(", mpimont_mul_mini: %.3f us\n", usec(start, count));
+}
+
+static void bench()
+{
+  FixedUInt<256> a, b;
+  FixedUInt<512> r;
+  UInt_Mini ca, cb;
+  ULong_Mini cr;
+  int i, count = 2000000;
+  clock_t start;
+
+  rnd(a);
+  rnd(b);
+  start = clock();
+  for (i=0; i < count; i++)
+  {
+    mul(r, a, b);
+    a.digits[0] ^= r.digits[8];
+  }
+  printf("256-bit mul: %.3f us", usec(start, count));
+
+  ca = to_mini(a);
+  cb = to_mini(b);
+  start = clock();
+  for (i=0; i < count; i++)
+  {
+    mpimul_mini(&cr, &ca, &cb);
+    ca.digits[0] ^= cr.digits[8];
+  }
+  printf(", mpimul_mini: %.3f us\n", usec(start, count));
+
+  bench_mod<P256>("P-256");
+  bench_mod<P384>("P-384");
+  bench_mod<P521>("P-521");
+}
+
+int main( int argc, char **argv )
+{
+  int errs;
+
+  errs = test_c_vectors();
+  errs += test_size<32>();
+  errs += test_size<96>();
+  errs += test_size<255>();
+  errs += test_size<384>();
+  errs += test_size<521>();
+  errs += test_size<1024>();
+  errs += test_mod<P256>("P-256");
+  errs += test_mod<N256>("P-256 order");
+  errs += test_mod<P384>("P-384");
+  errs += test_mod<P521>("P-521");
+  errs += test_mod<P25519>("2^255-19");
+
+  printf("%d errors\n", errs);
+
+  if ( argc > 1 && strcmp(argv[1], "-b") == 0 )
+    bench();
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,391 @@
+#ifndef MPIFIXED_MINI_HPP
+#define MPIFIXED_MINI_HPP
+/*
+ * Fixed-size multiprecision templates from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+
+#include "mpi_mini.h"
+
+/*
+ * C++17 versions of the mpi_mini.h operations for any fixed size.
+ * FixedUInt<Bits> holds an unsigned number in (Bits+31)/32 32-bit
+ * digits, least-significant first, and the add, sub, mul and sqr loops
+ * below are expanded at compile time for that digit count, so there are
+ * no loop counters or runtime length checks left in the generated code.
+ *
+ * FixedUInt<256> has the same layout as UInt_Mini, so to_mini() and
+ * from_mini() are plain copies. The C functions in mpiadd_mini.c etc.
+ * are separate code; the test harness checks these templates against
+ * them. Use those from C.
+ *
+ * ModInt<Modulus> is an element of Z/NZ for an odd N given at compile
+ * time, held in Montgomery form. Modulus is a type with a member
+ *
+ *    static constexpr FixedUInt<Bits> value = ...;
+ *
+ * and -N^-1 mod 2^32 and R^2 mod N are computed from it by the compiler.
+ * All ModInt operations run in time independent of the values.
+ */
+
+namespace minicrypt
+{
+
+template <unsigned Bits>
+struct FixedUInt
+{
+  static constexpr unsigned BITS = Bits;
+  static constexpr int DIGITS = (int)(Bits + 31) / 32;
+
+  uint32_t digits[DIGITS];
+};
+
+/* Double-width type for products of two FixedUInt<Bits> */
+template <unsigned Bits>
+using FixedUIntWide = FixedUInt<64 * FixedUInt<Bits>::DIGITS>;
+
+namespace detail
+{
+  /* Calls f(integral_constant<int, 0>) ... f(integral_constant<int, N-1>) */
+  template <typename F, int... I>
+  inline void unroll_( F &&f, std::integer_sequence<int, I...> )
+  {
+    (f(std::integral_constant<int, I>()), ...);
+  }
+
+  template <int N, typename F>
+  inline void unroll( F &&f )
+  {
+    unroll_(f, std::make_integer_sequence<int, N>());
+  }
+
+  /* res = a if keep_a is 0xFFFFFFFF, or b if it is 0 */
+  template <int D>
+  inline void select( uint32_t *res, const uint32_t *a, const uint32_t *b, uint32_t keep_a )
+  {
+    unroll<D>([&](auto i) { res[i] = (a[i] & keep_a) | (b[i] & ~keep_a); });
+  }
+}
+
+template <unsigned Bits>
+inline uint32_t add( FixedUInt<Bits> &res, const FixedUInt<Bits> &a, const FixedUInt<Bits> &b )
+/* Returns carry-out from top digit (0 or 1) */
+{
+  uint64_t carry = 0;
+
+  detail::unroll<FixedUInt<Bits>::DIGITS>([&](auto i) {
+    carry += (uint64_t)a.digits[i] + b.digits[i];
+    res.digits[i] = (uint32_t)carry;
+    carry >>= 32;
+  });
+  return (uint32_t)carry;
+}
+
+template <unsigned Bits>
+inline uint32_t sub( FixedUInt<Bits> &res, const FixedUInt<Bits> &a, const FixedUInt<Bits> &b )
+/* Returns carry-out from top digit, 0 or 0xFFFFFFFF */
+{
+  uint32_t borrow = 0;
+
+  detail::unroll<FixedUInt<Bits>::DIGITS>([&](auto i) {
+    uint64_t t = (uint64_t)a.digits[i] - b.digits[i] - borrow;
+    res.digits[i] = (uint32_t)t;
+    borrow = (uint32_t)(t >> 32) & 1;
+  });
+  return 0 - borrow;
+}
+
+template <unsigned Bits>
+inline void mul( FixedUIntWide<Bits> &res, const FixedUInt<Bits> &a, const FixedUInt<Bits> &b )
+/* Multiply two numbers to give double-sized result */
+{
+  constexpr int D = FixedUInt<Bits>::DIGITS;
+  uint32_t *t = res.digits;
+
+  detail::unroll<D>([&](auto i) {
+    uint64_t carry = 0;
+    detail::unroll<D>([&](auto j) {
+      uint64_t p = (uint64_t)a.digits[i] * b.digits[j] + carry;
+      if constexpr ( i > 0 )
+        p += t[i+j];
+      t[i+j] = (uint32_t)p;
+      carry = p >> 32;
+    });
+    t[i+D] = (uint32_t)carry;
+  });
+}
+
+template <unsigned Bits>
+inline void sqr( FixedUIntWide<Bits> &res, const FixedUInt<Bits> &a )
+/* Squares a number to give double-sized result. Faster than mul(res, a, a) */
+{
+  constexpr int D = FixedUInt<Bits>::DIGITS;
+  uint32_t *t = res.digits;
+  uint64_t carry;
+  uint32_t top;
+
+  /* Products above the diagonal, each once. Row i fills t[2i+1..i+D],
+   * and row i-1 has already written all of that but the top digit. */
+  t[0] = 0;
+  t[2*D-1] = 0;
+  detail::unroll<D-1>([&](auto i) {
+    uint64_t c = 0;
+    detail::unroll<D>([&](auto j) {
+      if constexpr ( j > i )
+      {
+        uint64_t p = (uint64_t)a.digits[i] * a.digits[j] + c;
+        if constexpr ( i > 0 )
+          p += t[i+j];
+        t[i+j] = (uint32_t)p;
+        c = p >> 32;
+      }
+    });
+    t[i+D] = (uint32_t)c;
+  });
+
+  /* Double them, then add the squares on the diagonal */
+  top = 0;
+  detail::unroll<2*D>([&](auto i) {
+    uint32_t d = t[i];
+    t[i] = (d << 1) | top;
+    top = d >> 31;
+  });
+  carry = 0;
+  detail::unroll<D>([&](auto i) {
+    uint64_t sq = (uint64_t)a.digits[i] * a.digits[i];
+    carry += (uint64_t)t[2*i] + (uint32_t)sq;
+    t[2*i] = (uint32_t)carry;
+    carry = (carry >> 32) + t[2*i+1] + (sq >> 32);
+    t[2*i+1] = (uint32_t)carry;
+    carry >>= 32;
+  });
+}
+
+/* Conversions to and from the C type, for the 256-bit case */
+
+static_assert(sizeof(FixedUInt<256>) == sizeof(UInt_Mini), "FixedUInt<256> must match UInt_Mini");
+
+inline FixedUInt<256> from_mini( const UInt_Mini &a )
+{
+  FixedUInt<256> r;
+  memcpy(r.digits, a.digits, sizeof(r.digits));
+  return r;
+}
+
+inline UInt_Mini to_mini( const FixedUInt<256> &a )
+{
+  UInt_Mini r;
+  memcpy(r.digits, a.digits, sizeof(r.digits));
+  return r;
+}
+
+/* Modular arithmetic ------------------------------ */
+
+namespace detail
+{
+  /* -n0^-1 mod 2^32, by Newton iteration; each step doubles the good bits */
+  constexpr uint32_t mont_n0inv( uint32_t n0 )
+  {
+    uint32_t x = 1;
+    for (int i=0; i < 5; i++)
+      x *= 2 - n0 * x;
+    return 0 - x;
+  }
+
+  /* r = 2r mod N, for r < N */
+  template <unsigned Bits>
+  constexpr void dbl_mod( FixedUInt<Bits> &r, const FixedUInt<Bits> &N )
+  {
+    constexpr int D = FixedUInt<Bits>::DIGITS;
+    uint32_t top = 0, borrow = 0;
+    uint32_t d[D] = {};
+
+    for (int i=0; i < D; i++)
+    {
+      uint32_t t = r.digits[i];
+      r.digits[i] = (t << 1) | top;
+      top = t >> 31;
+    }
+    for (int i=0; i < D; i++)
+    {
+      uint64_t t = (uint64_t)r.digits[i] - N.digits[i] - borrow;
+      d[i] = (uint32_t)t;
+      borrow = (uint32_t)(t >> 32) & 1;
+    }
+    if ( top || !borrow )
+      for (int i=0; i < D; i++)
+        r.digits[i] = d[i];
+  }
+
+  /* R^2 mod N, with R = 2^(32*DIGITS) */
+  template <unsigned Bits>
+  constexpr FixedUInt<Bits> mont_rr( const FixedUInt<Bits> &N )
+  {
+    FixedUInt<Bits> r = {};
+
+    r.digits[0] = 1;
+    for (int i=0; i < 64 * FixedUInt<Bits>::DIGITS; i++)
+      dbl_mod(r, N);
+    return r;
+  }
+
+  template <unsigned Bits>
+  constexpr bool valid_modulus( const FixedUInt<Bits> &N )
+  {
+    bool big = false;
+
+    for (int i=1; i < FixedUInt<Bits>::DIGITS; i++)
+      big = big || N.digits[i] != 0;
+    return (N.digits[0] & 1) && (big || N.digits[0] > 1);
+  }
+}
+
+template <class Modulus>
+class ModInt
+{
+public:
+  using UInt = std::remove_cv_t<decltype(Modulus::value)>;
+  using Wide = FixedUIntWide<UInt::BITS>;
+
+  static constexpr int DIGITS = UInt::DIGITS;
+  static constexpr UInt N = Modulus::value;
+  static constexpr uint32_t n0inv = detail::mont_n0inv(N.digits[0]);
+  static constexpr UInt RR = detail::mont_rr(N);
+
+  static_assert(detail::valid_modulus(N), "ModInt modulus must be odd and greater than 1");
+
+  static ModInt zero()
+  {
+    ModInt r;
+    detail::unroll<DIGITS>([&](auto i) { r.v.digits[i] = 0; });
+    return r;
+  }
+
+  static ModInt from( const UInt &a )
+  /* Any a will do, including ones not less than N */
+  {
+    ModInt r;
+    Wide t;
+
+    mul(t, a, RR);
+    redc(r.v, t);
+    return r;
+  }
+
+  UInt value() const
+  /* The least non-negative residue */
+  {
+    UInt r;
+    Wide t;
+
+    detail::unroll<DIGITS>([&](auto i) {
+      t.digits[i] = v.digits[i];
+      t.digits[i+DIGITS] = 0;
+    });
+    redc(r, t);
+    return r;
+  }
+
+  const UInt &mont() const
+  /* The Montgomery form, v*R mod N */
+  {
+    return v;
+  }
+
+  ModInt operator+( const ModInt &b ) const
+  {
+    ModInt r;
+    UInt d;
+    uint32_t carry = add(r.v, v, b.v);
+    uint32_t borrow = sub(d, r.v, N);
+
+    detail::select<DIGITS>(r.v.digits, r.v.digits, d.digits, borrow & ~(0 - carry));
+    return r;
+  }
+
+  ModInt operator-( const ModInt &b ) const
+  {
+    ModInt r;
+    UInt n;
+    uint32_t borrow = sub(r.v, v, b.v);
+
+    detail::unroll<DIGITS>([&](auto i) { n.digits[i] = N.digits[i] & borrow; });
+    add(r.v, r.v, n);
+    return r;
+  }
+
+  ModInt operator*( const ModInt &b ) const
+  {
+    ModInt r;
+    Wide t;
+
+    mul(t, v, b.v);
+    redc(r.v, t);
+    return r;
+  }
+
+  ModInt sqr() const
+  {
+    ModInt r;
+    Wide t;
+
+    minicrypt::sqr(t, v);
+    redc(r.v, t);
+    return r;
+  }
+
+  ModInt &operator+=( const ModInt &b ) { return *this = *this + b; }
+  ModInt &operator-=( const ModInt &b ) { return *this = *this - b; }
+  ModInt &operator*=( const ModInt &b ) { return *this = *this * b; }
+
+  bool operator==( const ModInt &b ) const
+  {
+    uint32_t diff = 0;
+
+    detail::unroll<DIGITS>([&](auto i) { diff |= v.digits[i] ^ b.v.digits[i]; });
+    return diff == 0;
+  }
+
+  bool operator!=( const ModInt &b ) const { return !(*this == b); }
+
+private:
+  UInt v;
+
+  /* res = t*R^-1 mod N, for t < R*N. t is overwritten. */
+  static void redc( UInt &res, Wide &t )
+  {
+    uint32_t top = 0, borrow;
+    UInt hi, d;
+
+    detail::unroll<DIGITS>([&](auto i) {
+      uint32_t m = t.digits[i] * n0inv;
+      uint64_t carry = 0;
+      detail::unroll<DIGITS>([&](auto j) {
+        carry += (uint64_t)m * N.digits[j] + t.digits[i+j];
+        t.digits[i+j] = (uint32_t)carry;
+        carry >>= 32;
+      });
+      carry += (uint64_t)t.digits[i+DIGITS] + top;
+      t.digits[i+DIGITS] = (uint32_t)carry;
+      top = (uint32_t)(carry >> 32);
+    });
+
+    /* t/R is less than 2N; take off N if that does not go negative */
+    detail::unroll<DIGITS>([&](auto i) { hi.digits[i] = t.digits[i+DIGITS]; });
+    borrow = sub(d, hi, N);
+    detail::select<DIGITS>(res.digits, hi.digits, d.digits, borrow & ~(0 - top));
+  }
+};
+
+} /* namespace minicrypt */
+
+#endif
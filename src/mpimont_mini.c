@@ -0,0 +1,244 @@
+/*
+ *
+ * Montgomery modular multiplication from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpi_mini.h"
+#include "mpin_mini.h"
+#include "mpimont_mini.h"
+
+void mpimont_condsub_mini_( uint32_t *res, const uint32_t *t, uint32_t top,
+                            const uint32_t *N, int n )
+{
+  uint32_t d[MPIMONT_MINI_MAX_DIGITS];
+  uint32_t borrow, mask;
+  int i;
+
+  /* Take t-N if it didn't borrow, or if t had a top bit to borrow from */
+  borrow = mpin_sub_mini(d, t, N, n);
+  mask = (0 - top) | ~borrow;
+  for (i=0; i<n; i++)
+    res[i] = (d[i] & mask) | (t[i] & ~mask);
+}
+
+MCResult mpimont_init_mini( MPIMont_Mini *ctx, const uint32_t *N, int n )
+{
+  uint32_t x, top;
+  int i, j;
+
+  if ( n < 1 || n > MPIMONT_MINI_MAX_DIGITS )
+    return MC_BAD_LENGTH;
+  if ( (N[0] & 1) == 0 )
+    return MC_BAD_PARAMS;
+  for (i=1; i<n && N[i] == 0; i++)
+    ;
+  if ( i == n && N[0] == 1 )
+    return MC_BAD_PARAMS;
+
+  ctx->n = n;
+  for (i=0; i<n; i++)
+    ctx->N[i] = N[i];
+
+  /* Newton iteration for N^-1 mod 2^32: N*N == 1 mod 8 for any odd N,
+   * and each step doubles the number of correct bits (3,6,12,24,48).
+   */
+  x = N[0];
+  for (i=0; i<4; i++)
+    x *= 2 - N[0] * x;
+  ctx->n0inv = 0 - x;
+
+  /* R^2 mod N = 2^(64n) mod N, by doubling 1 that many times */
+  ctx->RR[0] = 1;
+  for (i=1; i<n; i++)
+    ctx->RR[i] = 0;
+  for (j=0; j < 64*n; j++)
+  {
+    top = 0;
+    for (i=0; i<n; i++)
+    {
+      uint32_t d = ctx->RR[i];
+      ctx->RR[i] = (d << 1) | top;
+      top = d >> 31;
+    }
+    mpimont_condsub_mini_(ctx->RR, ctx->RR, top, N, n);
+  }
+  return MC_OK;
+}
+
+void mpimont_mul_mini( const MPIMont_Mini *ctx, uint32_t *res,
+                       const uint32_t *a, const uint32_t *b )
+{
+  /* t[i..i+n] holds the running total before step i; it stays below 2N,
+   * and t[i] is cleared by adding a multiple of N before moving on.
+   */
+  uint32_t t[2*MPIMONT_MINI_MAX_DIGITS+1];
+  int n = ctx->n;
+  int i;
+
+  for (i=0; i<2*n+1; i++)
+    t[i] = 0;
+
+  for (i=0; i<n; i++)
+  {
+    uint32_t m;
+
+    t[i+n+1] += mpi_mulrow_n_mini_(&t[i], a[i], b, n);
+    m = t[i] * ctx->n0inv;
+    t[i+n+1] += mpi_mulrow_n_mini_(&t[i], m, ctx->N, n);
+  }
+  mpimont_condsub_mini_(res, &t[n], t[2*n], ctx->N, n);
+}
+
+void mpimont_redc_mini_( const MPIMont_Mini *ctx, uint32_t *res, uint32_t *t )
+{
+  int n = ctx->n;
+  uint32_t pending = 0;
+  int i;
+
+  t[2*n] = 0;
+  for (i=0; i<n; i++)
+  {
+    uint32_t m = t[i] * ctx->n0inv;
+    uint32_t c = mpi_mulrow_n_mini_(&t[i], m, ctx->N, n);
+    uint64_t s = (uint64_t)t[i+n+1] + c + pending;
+
+    t[i+n+1] = (uint32_t)s;
+    pending = (uint32_t)(s >> 32);
+  }
+  mpimont_condsub_mini_(res, &t[n], t[2*n], ctx->N, n);
+}
+
+void mpimont_sqr_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a )
+{
+  uint32_t t[2*MPIMONT_MINI_MAX_DIGITS+1];
+
+  if ( ctx->n < MPINMINI_KARATSUBA_THRESHOLD )
+    mpin_sqr_school_mini_(t, a, ctx->n);
+  else
+  {
+    uint32_t scratch[MPINMINI_SCRATCH_DIGITS(MPIMONT_MINI_MAX_DIGITS)];
+    mpin_sqr_mini(t, a, ctx->n, scratch);
+  }
+  mpimont_redc_mini_(ctx, res, t);
+}
+
+void mpimont_to_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a )
+{
+  mpimont_mul_mini(ctx, res, a, ctx->RR);
+}
+
+void mpimont_from_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a )
+{
+  uint32_t one[MPIMONT_MINI_MAX_DIGITS];
+  int i;
+
+  one[0] = 1;
+  for (i=1; i<ctx->n; i++)
+    one[i] = 0;
+  mpimont_mul_mini(ctx, res, a, one);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+  int n;
+  uint32_t N[MPIMONT_MINI_MAX_DIGITS];
+  uint32_t a[MPIMONT_MINI_MAX_DIGITS];
+  uint32_t b[MPIMONT_MINI_MAX_DIGITS];
+  uint32_t res[MPIMONT_MINI_MAX_DIGITS];
+}
+  MpiMont_TV;
+
+static const MpiMont_TV mont_tvs[] =
+{
+#include "testvectors/mpimont.inc"
+};
+
+static const int mont_tvs_count = sizeof(mont_tvs) / sizeof(MpiMont_TV);
+
+static int test_errors(void)
+{
+  MPIMont_Mini ctx;
+  uint32_t N[2] = { 0x12345678, 0x9 };
+  int errs = 0;
+
+  if ( mpimont_init_mini(&ctx, N, 2) != MC_BAD_PARAMS )
+    errs++;
+  N[0] = 1;
+  if ( mpimont_init_mini(&ctx, N, 2) != MC_OK )
+    errs++;
+  if ( mpimont_init_mini(&ctx, N, 1) != MC_BAD_PARAMS )
+    errs++;
+  if ( mpimont_init_mini(&ctx, N, 0) != MC_BAD_LENGTH
+       || mpimont_init_mini(&ctx, N, MPIMONT_MINI_MAX_DIGITS+1) != MC_BAD_LENGTH )
+    errs++;
+  if ( errs )
+    printf("Parameter checks failed\n");
+  return errs;
+}
+
+int main(void)
+{
+  static MPIMont_Mini ctx;
+  int i, errs;
+
+  errs = test_errors();
+  for (i=0; i < mont_tvs_count; i++)
+  {
+    const MpiMont_TV *tv = &mont_tvs[i];
+    size_t len = tv->n * sizeof(uint32_t);
+    uint32_t am[MPIMONT_MINI_MAX_DIGITS], bm[MPIMONT_MINI_MAX_DIGITS];
+    uint32_t r[MPIMONT_MINI_MAX_DIGITS], s[MPIMONT_MINI_MAX_DIGITS];
+
+    if ( mpimont_init_mini(&ctx, tv->N, tv->n) != MC_OK )
+    {
+      printf("Test #%d: init failed\n", i);
+      errs++;
+      continue;
+    }
+
+    mpimont_to_mini(&ctx, am, tv->a);
+    mpimont_to_mini(&ctx, bm, tv->b);
+    mpimont_mul_mini(&ctx, r, am, bm);
+    mpimont_from_mini(&ctx, r, r);
+    if ( memcmp(r, tv->res, len) != 0 )
+    {
+      printf("Test #%d failed (mul)\n", i);
+      errs++;
+      continue;
+    }
+
+    /* Squaring, against multiplying. Also checks in-place use. */
+    mpimont_mul_mini(&ctx, r, am, am);
+    memcpy(s, am, len);
+    mpimont_sqr_mini(&ctx, s, s);
+    if ( memcmp(r, s, len) != 0 )
+    {
+      printf("Test #%d failed (sqr)\n", i);
+      errs++;
+      continue;
+    }
+
+    mpimont_from_mini(&ctx, r, bm);
+    if ( memcmp(r, tv->b, len) != 0 )
+    {
+      printf("Test #%d failed (round trip)\n", i);
+      errs++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, mont_tvs_count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
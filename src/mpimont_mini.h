@@ -0,0 +1,86 @@
+#ifndef MPIMONT_MINI_H
+#define MPIMONT_MINI_H
+/*
+ * Montgomery modular multiplication from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+
+/*
+ * A context holds an odd modulus N of n 32-bit digits, least-significant
+ * first, with the constants for Montgomery reduction with R = 2^(32n).
+ * Values are arrays of n digits, and must be less than N on input.
+ *
+ * Numbers are converted into Montgomery form (aR mod N) with
+ * mpimont_to_mini(), multiplied with mpimont_mul_mini() (which gives
+ * abR^-1 mod N, i.e. the Montgomery form of the product), and converted
+ * back with mpimont_from_mini(). None of this needs any division.
+ *
+ * The multiply and square functions run in time which depends only on n.
+ * mpimont_init_mini() is not constant-time, but the modulus is usually
+ * public.
+ */
+
+#ifndef MPIMONT_MINI_MAX_DIGITS
+#define MPIMONT_MINI_MAX_DIGITS 128  /* 4096 bits */
+#endif
+
+typedef struct
+{
+  int n;                                  /* Digits in N */
+  uint32_t n0inv;                         /* -N^-1 mod 2^32 */
+  uint32_t N[MPIMONT_MINI_MAX_DIGITS];
+  uint32_t RR[MPIMONT_MINI_MAX_DIGITS];   /* R^2 mod N */
+}
+  MPIMont_Mini;
+
+extern MCResult mpimont_init_mini( MPIMont_Mini *ctx, const uint32_t *N, int n );
+/* Sets up a context for modulus N[0..n-1]. Returns MC_BAD_PARAMS if N is
+ * even or 1, or MC_BAD_LENGTH if n is not 1..MPIMONT_MINI_MAX_DIGITS. */
+
+extern void mpimont_mul_mini( const MPIMont_Mini *ctx, uint32_t *res,
+                              const uint32_t *a, const uint32_t *b );
+/* res = a*b*R^-1 mod N. res may be the same as a or b. */
+
+extern void mpimont_sqr_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a );
+/* res = a*a*R^-1 mod N. res may be the same as a. */
+
+extern void mpimont_to_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a );
+/* res = a*R mod N, i.e. converts a into Montgomery form */
+
+extern void mpimont_from_mini( const MPIMont_Mini *ctx, uint32_t *res, const uint32_t *a );
+/* res = a*R^-1 mod N, i.e. converts a out of Montgomery form */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef MPIMINI_INTERNAL_API
+
+extern void mpimont_redc_mini_( const MPIMont_Mini *ctx, uint32_t *res, uint32_t *t );
+/* res = t*R^-1 mod N, for t[0..2n-1] < N*R. t must have room for 2n+1
+ * digits, and is destroyed. */
+
+extern void mpimont_condsub_mini_( uint32_t *res, const uint32_t *t, uint32_t top,
+                                   const uint32_t *N, int n );
+/* res = (top:t) - N if (top:t) >= N, else t, in constant time. top is 0 or 1,
+ * and (top:t) must be less than 2N. res may be the same as t. */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -10,12 +10,81 @@
 #define MPIMINI_INTERNAL_API
 #include "mpi_mini.h"
 
-uint32_t mpi_mulrow_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB)
+#if defined(MPIMINI_X86_ACCEL) && defined(__GNUC__) && defined(__x86_64__)
+# include "x86cpu_mini.h"
+# define MPIMINI_HAVE_X86 1
+#else
+# define MPIMINI_HAVE_X86 0
+#endif
+
+#ifdef MPIMINI_64BIT
+
+static uint32_t mulrow_generic ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB, int n)
+{
+    uint64_t carry = 0;
+    uint64_t top;
+    int i;
+
+    /* sA is only 32 bits, so each step is a 32x64 multiply and the
+     * carry between limbs stays below 2^32.
+     */
+    for (i = 0; i < n/2; i++)
+    {
+        mpi_dlimb_mini_ t = (mpi_dlimb_mini_)sA * mpi_getlimb_mini_(srcB, i)
+                            + mpi_getlimb_mini_(dst, i) + carry;
+        mpi_setlimb_mini_(dst, i, (uint64_t)t);
+        carry = (uint64_t)(t >> 64);
+    }
+    if ( n & 1 )
+    {
+        uint64_t t = (uint64_t)sA * srcB[n-1] + dst[n-1] + carry;
+        dst[n-1] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    top = (uint64_t)dst[n] + carry;
+    dst[n] = (uint32_t)top;
+    return (uint32_t)(top >> 32);
+}
+
+static void mul_generic( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+{
+    uint64_t r[2*MPIMINI_LIMBS];
+    uint64_t bl[MPIMINI_LIMBS];
+    int i, j;
+
+    for (j = 0; j < MPIMINI_LIMBS; j++)
+    {
+        bl[j] = mpi_getlimb_mini_(b->digits, j);
+        r[j] = 0;
+    }
+
+    for (i = 0; i < MPIMINI_LIMBS; i++)
+    {
+        uint64_t ai = mpi_getlimb_mini_(a->digits, i);
+        uint64_t carry = 0;
+
+        for (j = 0; j < MPIMINI_LIMBS; j++)
+        {
+            /* Max is (2^64-1)^2 + 2*(2^64-1) = 2^128-1, so no overflow */
+            mpi_dlimb_mini_ t = (mpi_dlimb_mini_)ai * bl[j] + r[i+j] + carry;
+            r[i+j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[i+MPIMINI_LIMBS] = carry;
+    }
+
+    for (i = 0; i < 2*MPIMINI_LIMBS; i++)
+      mpi_setlimb_mini_(res->digits, i, r[i]);
+}
+
+#else /* 32-bit digits */
+
+static uint32_t mulrow_generic ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB, int n)
 {
     uint32_t carry = 0;
     int i, j;
 
-    for (i = 0; i < MPIMINI_DIGITS; i++)
+    for (i = 0; i < n; i++)
     {
         uint32_t wsum[4];
         uint32_t sB = srcB[i];
@@ -46,7 +115,7 @@ uint32_t mpi_mulrow_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB)
     return carry;
 }
 
-void mpimul_mini( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+static void mul_generic( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
 {
     int i;
 
@@ -55,7 +124,7 @@ void mpimul_mini( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
     
     for (i = 0; i < MPIMINI_DIGITS; i++)
     {
-        mpi_mulrow_mini_ ( &res->digits[i], a->digits[i], b->digits );
+        mulrow_generic ( &res->digits[i], a->digits[i], b->digits, MPIMINI_DIGITS );
         // Note: *in this particular case* it's OK to ignore the carry,
         // as res->digits[sX+MPIMINI_DIGITS] will be zero on entry, so
         // the sum will be at most (slightly less than) this:
@@ -66,6 +135,204 @@ void mpimul_mini( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
     }
 }
 
+#endif /* MPIMINI_64BIT */
+
+#if MPIMINI_HAVE_X86
+
+/* x86-64 kernels using MULX (BMI2) and ADCX/ADOX (ADX). These work on
+ * 64-bit limbs, i.e. pairs of digits, whichever way the C code is built.
+ * ADCX only touches CF and ADOX only touches OF, so the low and high
+ * halves of the products are added along two independent carry chains.
+ */
+
+static uint32_t mulrow_adx ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB, int n)
+{
+    uint64_t carry, t;
+    uint64_t *d = (uint64_t *)dst;
+    const uint64_t *b = (const uint64_t *)srcB;
+    uint64_t count = (uint64_t)(n/2);
+
+    /* dst[2i..2i+1] += lo(sA*b[i]) (CF chain) + hi(sA*b[i-1]) (OF chain).
+     * The loop uses lea and jrcxz, as dec/cmp would clobber the flags.
+     */
+    __asm__ (
+        "xorl   %k[c], %k[c]\n\t"     /* Also clears CF and OF */
+        "jrcxz  2f\n"
+        "1:\n\t"
+        "mulxq  (%[b]), %%r10, %%r11\n\t"
+        "movq   (%[d]), %[t]\n\t"
+        "adcxq  %%r10, %[t]\n\t"
+        "adoxq  %[c], %[t]\n\t"
+        "movq   %[t], (%[d])\n\t"
+        "movq   %%r11, %[c]\n\t"
+        "leaq   8(%[b]), %[b]\n\t"
+        "leaq   8(%[d]), %[d]\n\t"
+        "leaq   -1(%%rcx), %%rcx\n\t"
+        "jrcxz  2f\n\t"
+        "jmp    1b\n"
+        "2:\n\t"
+        "movl   $0, %k[t]\n\t"
+        "adcxq  %[t], %[c]\n\t"
+        "adoxq  %[t], %[c]\n\t"
+        : [c] "=&r" (carry), [t] "=&r" (t), [d] "+r" (d), [b] "+r" (b), "+c" (count)
+        : "d" ((uint64_t)sA)
+        : "r10", "r11", "cc", "memory" );
+
+    /* As in the C version, carry is below 2^32 here */
+    if ( n & 1 )
+    {
+        t = (uint64_t)sA * srcB[n-1] + dst[n-1] + carry;
+        dst[n-1] = (uint32_t)t;
+        carry = t >> 32;
+    }
+    t = (uint64_t)dst[n] + carry;
+    dst[n] = (uint32_t)t;
+    return (uint32_t)(t >> 32);
+}
+
+#if MPIMINI_DIGITS == 8
+
+/* One row of the 4x4 limb product: adds a[i]*b into the accumulators
+ * A0..A3, and puts the top limb in A4. 'zero' must be zero on entry
+ * (the xor also clears CF and OF).
+ */
+#define MULX_ROW(off, A0, A1, A2, A3, A4) \
+        "movq   " #off "(%[a]), %%rdx\n\t" \
+        "xorl   %%eax, %%eax\n\t" \
+        "mulxq  0(%[b]), %%r13, %%r14\n\t" \
+        "adcxq  %%r13, " A0 "\n\t" \
+        "adoxq  %%r14, " A1 "\n\t" \
+        "mulxq  8(%[b]), %%r13, %%r14\n\t" \
+        "adcxq  %%r13, " A1 "\n\t" \
+        "adoxq  %%r14, " A2 "\n\t" \
+        "mulxq  16(%[b]), %%r13, %%r14\n\t" \
+        "adcxq  %%r13, " A2 "\n\t" \
+        "adoxq  %%r14, " A3 "\n\t" \
+        "mulxq  24(%[b]), %%r13, " A4 "\n\t" \
+        "adcxq  %%r13, " A3 "\n\t" \
+        "adoxq  %%rax, " A4 "\n\t" \
+        "adcxq  %%rax, " A4 "\n\t"
+
+static void mul_adx( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+{
+    __asm__ (
+        /* First row: nothing to accumulate into, so a single chain */
+        "movq   0(%[a]), %%rdx\n\t"
+        "mulxq  0(%[b]), %%r8, %%r9\n\t"
+        "mulxq  8(%[b]), %%r13, %%r10\n\t"
+        "addq   %%r13, %%r9\n\t"
+        "mulxq  16(%[b]), %%r13, %%r11\n\t"
+        "adcq   %%r13, %%r10\n\t"
+        "mulxq  24(%[b]), %%r13, %%r12\n\t"
+        "adcq   %%r13, %%r11\n\t"
+        "adcq   $0, %%r12\n\t"
+        "movq   %%r8, 0(%[r])\n\t"
+
+        MULX_ROW(8,  "%%r9",  "%%r10", "%%r11", "%%r12", "%%r8")
+        "movq   %%r9, 8(%[r])\n\t"
+        MULX_ROW(16, "%%r10", "%%r11", "%%r12", "%%r8",  "%%r9")
+        "movq   %%r10, 16(%[r])\n\t"
+        MULX_ROW(24, "%%r11", "%%r12", "%%r8",  "%%r9",  "%%r10")
+        "movq   %%r11, 24(%[r])\n\t"
+        "movq   %%r12, 32(%[r])\n\t"
+        "movq   %%r8,  40(%[r])\n\t"
+        "movq   %%r9,  48(%[r])\n\t"
+        "movq   %%r10, 56(%[r])\n\t"
+        :
+        : [r] "r" (res->digits), [a] "r" (a->digits), [b] "r" (b->digits)
+        : "rax", "rdx", "r8", "r9", "r10", "r11", "r12", "r13", "r14", "cc", "memory" );
+}
+
+#else
+
+static void mul_adx( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+{
+    int i;
+
+    for (i = 0; i < 2*MPIMINI_DIGITS; i++)
+      res->digits[i] = 0;
+    for (i = 0; i < MPIMINI_DIGITS; i++)
+      mulrow_adx ( &res->digits[i], a->digits[i], b->digits, MPIMINI_DIGITS );
+}
+
+#endif /* MPIMINI_DIGITS == 8 */
+
+static int cpu_has_adx(void)
+{
+  unsigned need = X86MINI_BMI2 | X86MINI_ADX;
+  return (X86Mini_features() & need) == need;
+}
+
+#endif /* MPIMINI_HAVE_X86 */
+
+/* Implementation selection ----------------------- */
+
+typedef struct
+{
+  const char *name;
+  void (*mul)( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b );
+  uint32_t (*mulrow)( uint32_t *dst, uint32_t sA, const uint32_t *srcB, int n );
+  int (*supported)(void);
+}
+  MulImpl;
+
+static int always(void)
+{
+  return 1;
+}
+
+/* Best first */
+static const MulImpl impls[] =
+{
+#if MPIMINI_HAVE_X86
+  { "mulx-adx", mul_adx, mulrow_adx, cpu_has_adx },
+#endif
+  { "generic", mul_generic, mulrow_generic, always },
+  { NULL, NULL, NULL, NULL }
+};
+
+static const MulImpl *mul_impl = NULL;
+
+static const MulImpl *select_impl(void)
+{
+  /* Racing threads all pick the same entry; the atomics just
+     keep the unsynchronised access well defined */
+  const MulImpl *mi = __atomic_load_n(&mul_impl, __ATOMIC_RELAXED);
+
+  if ( mi == NULL )
+  {
+    mi = impls;
+    while ( !mi->supported() )
+      mi++;
+    __atomic_store_n(&mul_impl, mi, __ATOMIC_RELAXED);
+  }
+  return mi;
+}
+
+void mpimul_mini( ULong_Mini *res, const UInt_Mini *a, const UInt_Mini *b )
+{
+    select_impl()->mul(res, a, b);
+}
+
+uint32_t mpi_mulrow_n_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB, int n)
+{
+    return select_impl()->mulrow(dst, sA, srcB, n);
+}
+
+uint32_t mpi_mulrow_mini_ ( uint32_t *dst,  uint32_t sA, const uint32_t *srcB)
+{
+    return select_impl()->mulrow(dst, sA, srcB, MPIMINI_DIGITS);
+}
+
+int mpi_mulaccel_mini_(void)
+{
+#if MPIMINI_HAVE_X86
+    return select_impl()->mul == mul_adx;
+#else
+    return 0;
+#endif
+}
+
 /* Test harness ======================================================= */
 #ifdef TEST_HARNESS
 
@@ -87,25 +354,60 @@ static const MpiMul_TV mul_tvs[] =
 
 static const int mul_tvs_count = sizeof(mul_tvs) / sizeof(MpiMul_TV);
 
-int main(void)
+static int test_impl(void)
 {
   int i, errs;
-  
+
   errs = 0;
   for (i=0; i < mul_tvs_count; i++)
   {
     const MpiMul_TV *tv = &mul_tvs[i];
     ULong_Mini res;
-    
+    int j;
+
     mpimul_mini(&res, &tv->a, &tv->b);
     if ( memcmp(&res, &tv->res, sizeof(res)) != 0 )
     {
       printf("Test #%d failed\n", i);
       errs ++;
+      continue;
+    }
+
+    /* Same product, built a row at a time */
+    memset(&res, 0, sizeof(res));
+    for (j=0; j < MPIMINI_DIGITS; j++)
+    {
+      if ( mpi_mulrow_mini_(&res.digits[j], tv->a.digits[j], tv->b.digits) != 0 )
+        break;
+    }
+    if ( j < MPIMINI_DIGITS || memcmp(&res, &tv->res, sizeof(res)) != 0 )
+    {
+      printf("Test #%d failed (mulrow)\n", i);
+      errs ++;
     }
   }
-  
-  printf("%d errors out of %d\n", errs, mul_tvs_count);
+  return errs;
+}
+
+int main(void)
+{
+  const MulImpl *mi;
+  int errs = 0;
+
+  for (mi=&impls[0]; mi->name != NULL; mi++)
+  {
+    int e;
+
+    if ( !mi->supported() )
+    {
+      printf("[%s] not supported on this CPU\n", mi->name);
+      continue;
+    }
+    mul_impl = mi;
+    e = test_impl();
+    printf("[%s] %d errors out of %d\n", mi->name, e, mul_tvs_count);
+    errs += e;
+  }
   return (errs==0) ? 0 : 1;
 }
 
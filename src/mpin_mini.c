@@ -0,0 +1,375 @@
+/*
+ *
+ * Variable-length MPI arithmetic from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpi_mini.h"
+#include "mpin_mini.h"
+
+uint32_t mpin_add_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n )
+{
+  uint64_t carry = 0;
+  int i;
+
+  for (i=0; i<n; i++)
+  {
+    carry += (uint64_t)a[i] + b[i];
+    res[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  return (uint32_t)carry;
+}
+
+uint32_t mpin_sub_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n )
+{
+  uint32_t borrow = 0;
+  int i;
+
+  for (i=0; i<n; i++)
+  {
+    uint64_t t = (uint64_t)a[i] - b[i] - borrow;
+    res[i] = (uint32_t)t;
+    borrow = (uint32_t)(t >> 32) & 1;
+  }
+  return 0 - borrow;
+}
+
+int mpin_cmp_mini( const uint32_t *a, const uint32_t *b, int n )
+{
+  while ( n-- > 0 )
+  {
+    if ( a[n] < b[n] )
+      return -1;
+    if ( a[n] > b[n] )
+      return 1;
+  }
+  return 0;
+}
+
+/* Schoolbook base cases ---------------------------------------------- */
+
+void mpin_mul_school_mini_( uint32_t *res, const uint32_t *a, const uint32_t *b, int n )
+{
+  int i;
+
+  for (i=0; i<2*n; i++)
+    res[i] = 0;
+
+  /* As in mpimul_mini(), res[i+n] is zero before row i is added,
+   * so the carry out of each row is always zero. */
+  for (i=0; i<n; i++)
+    mpi_mulrow_n_mini_(&res[i], a[i], b, n);
+}
+
+void mpin_sqr_school_mini_( uint32_t *res, const uint32_t *a, int n )
+{
+  uint32_t carry;
+  int i;
+
+  for (i=0; i<2*n; i++)
+    res[i] = 0;
+
+  /* Cross products a[i]*a[j], i < j. Row i covers res[2i+1 .. i+n],
+   * and res[i+n] is still zero on entry. */
+  for (i=0; i<n-1; i++)
+    mpi_mulrow_n_mini_(&res[2*i+1], a[i], &a[i+1], n-1-i);
+
+  /* Double them. The cross products sum to less than a^2/2, so the
+   * top bit shifted out is zero. */
+  carry = 0;
+  for (i=0; i<2*n; i++)
+  {
+    uint32_t d = res[i];
+    res[i] = (d << 1) | carry;
+    carry = d >> 31;
+  }
+
+  /* Add the squares on the diagonal */
+  carry = 0;
+  for (i=0; i<n; i++)
+  {
+    uint64_t sq = (uint64_t)a[i] * a[i];
+    uint64_t t = (uint64_t)res[2*i] + (uint32_t)sq + carry;
+    res[2*i] = (uint32_t)t;
+    t = (uint64_t)res[2*i+1] + (sq >> 32) + (t >> 32);
+    res[2*i+1] = (uint32_t)t;
+    carry = (uint32_t)(t >> 32);
+  }
+}
+
+/* Karatsuba --------------------------------------------------------- */
+
+/* d[0..ny-1] = |x - y|, where x has nx <= ny digits (zero-extended).
+ * Returns 0xFFFFFFFF if x < y, otherwise 0. Constant-time.
+ */
+static uint32_t absdiff( uint32_t *d, const uint32_t *x, int nx, const uint32_t *y, int ny )
+{
+  uint32_t borrow = 0, mask;
+  uint64_t carry;
+  int i;
+
+  for (i=0; i<ny; i++)
+  {
+    uint64_t t = (uint64_t)(i < nx ? x[i] : 0) - y[i] - borrow;
+    d[i] = (uint32_t)t;
+    borrow = (uint32_t)(t >> 32) & 1;
+  }
+
+  /* Negate if it went negative: -d = ~d + 1 */
+  mask = 0 - borrow;
+  carry = borrow;
+  for (i=0; i<ny; i++)
+  {
+    carry += d[i] ^ mask;
+    d[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  return mask;
+}
+
+/* Given z0 = x0*y0 in res[0..2l-1] and z2 = x1*y1 in res[2l..2n-1], and
+ * t = |x0-x1|*|y0-y1| in t[0..2h-1], adds the middle term
+ *   z1 = z0 + z2 - t   (if 'subtract' is all-ones)
+ *   z1 = z0 + z2 + t   (if 'subtract' is zero)
+ * into res at offset l. 'mid' must have room for 2h+1 digits.
+ */
+static void add_middle( uint32_t *res, int l, int h, const uint32_t *t,
+                        uint32_t subtract, uint32_t *mid )
+{
+  uint64_t carry;
+  int i;
+
+  /* mid = z0 + z2 */
+  carry = 0;
+  for (i=0; i<2*h; i++)
+  {
+    carry += (uint64_t)res[2*l+i] + (i < 2*l ? res[i] : 0);
+    mid[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  mid[2*h] = (uint32_t)carry;
+
+  /* mid += t, or mid += ~t + 1 to subtract. The true result is
+   * non-negative and fits in 2h+1 digits, so working modulo
+   * 2^(32*(2h+1)) gets it right. */
+  carry = subtract & 1;
+  for (i=0; i<2*h; i++)
+  {
+    carry += (uint64_t)mid[i] + (t[i] ^ subtract);
+    mid[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  mid[2*h] += (uint32_t)carry + subtract;
+
+  /* res[l..] += mid, carrying to the top */
+  carry = 0;
+  for (i=0; i<2*h+1; i++)
+  {
+    carry += (uint64_t)res[l+i] + mid[i];
+    res[l+i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+  for (i=l+2*h+1; i<l+2*h+l; i++)
+  {
+    carry += res[i];
+    res[i] = (uint32_t)carry;
+    carry >>= 32;
+  }
+}
+
+void mpin_mul_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n,
+                    uint32_t *scratch )
+{
+  int l, h;
+  uint32_t sa, sb;
+
+  if ( n < MPINMINI_KARATSUBA_THRESHOLD )
+  {
+    mpin_mul_school_mini_(res, a, b, n);
+    return;
+  }
+
+  /* a = a1*B^l + a0, with a0 having l digits and a1 having h >= l */
+  l = n/2;
+  h = n - l;
+  mpin_mul_mini(res, a, b, l, scratch);
+  mpin_mul_mini(res + 2*l, a + l, b + l, h, scratch);
+
+  /* scratch: t[2h], then |a0-a1|[h] and |b0-b1|[h] (later mid[2h+1]),
+   * then the rest for the recursive call. */
+  sa = absdiff(scratch + 2*h, a, l, a + l, h);
+  sb = absdiff(scratch + 3*h, b, l, b + l, h);
+  mpin_mul_mini(scratch, scratch + 2*h, scratch + 3*h, h, scratch + 4*h + 1);
+
+  /* (a0-a1)(b0-b1) = +t if the signs agree, and is subtracted */
+  add_middle(res, l, h, scratch, ~(sa ^ sb), scratch + 2*h);
+}
+
+void mpin_sqr_mini( uint32_t *res, const uint32_t *a, int n, uint32_t *scratch )
+{
+  int l, h;
+
+  if ( n < MPINMINI_KARATSUBA_THRESHOLD )
+  {
+    mpin_sqr_school_mini_(res, a, n);
+    return;
+  }
+
+  l = n/2;
+  h = n - l;
+  mpin_sqr_mini(res, a, l, scratch);
+  mpin_sqr_mini(res + 2*l, a + l, h, scratch);
+
+  absdiff(scratch + 2*h, a, l, a + l, h);
+  mpin_sqr_mini(scratch, scratch + 2*h, h, scratch + 4*h + 1);
+
+  /* (a0-a1)^2 is never negative, so it is always subtracted */
+  add_middle(res, l, h, scratch, 0xFFFFFFFF, scratch + 2*h);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <string.h>
+
+#define MAXN 200
+
+static uint32_t rng_state = 0x12345678;
+
+static uint32_t rng(void)
+{
+  /* xorshift32; good enough for test operands */
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 17;
+  rng_state ^= rng_state << 5;
+  return rng_state;
+}
+
+static void random_digits(uint32_t *d, int n)
+{
+  int i;
+  uint32_t style = rng() & 7;
+
+  for (i=0; i<n; i++)
+  {
+    d[i] = rng();
+    /* Mix in runs of all-zero and all-one digits to stress carries */
+    if ( style == 1 )
+      d[i] = 0xFFFFFFFF;
+    else if ( style == 2 && (d[i] & 1) )
+      d[i] = (d[i] & 2) ? 0xFFFFFFFF : 0;
+  }
+}
+
+/* Value mod (2^32-5), independently of the code under test */
+#define TEST_P 0xFFFFFFFBu
+
+static uint32_t residue(const uint32_t *d, int n)
+{
+  uint64_t r = 0;
+  while ( n-- > 0 )
+    r = ((r << 32) | d[n]) % TEST_P;
+  return (uint32_t)r;
+}
+
+static uint32_t scratch[MPINMINI_SCRATCH_DIGITS(MAXN)];
+
+int main(void)
+{
+  static uint32_t a[MAXN], b[MAXN], r1[2*MAXN], r2[2*MAXN];
+  int n, iter, i, errs = 0, count = 0;
+
+  for (n=1; n<=MAXN; n++)
+  {
+    for (iter=0; iter < 4; iter++)
+    {
+      uint64_t expect;
+
+      random_digits(a, n);
+      random_digits(b, n);
+      count++;
+
+      mpin_mul_school_mini_(r1, a, b, n);
+      expect = ((uint64_t)residue(a, n) * residue(b, n)) % TEST_P;
+      if ( residue(r1, 2*n) != expect )
+      {
+        printf("n=%d schoolbook multiply failed\n", n);
+        errs++;
+        continue;
+      }
+
+      mpin_mul_mini(r2, a, b, n, scratch);
+      if ( memcmp(r1, r2, 2*n*sizeof(uint32_t)) != 0 )
+      {
+        printf("n=%d multiply failed\n", n);
+        errs++;
+        continue;
+      }
+
+      mpin_mul_school_mini_(r1, a, a, n);
+      mpin_sqr_school_mini_(r2, a, n);
+      if ( memcmp(r1, r2, 2*n*sizeof(uint32_t)) != 0 )
+      {
+        printf("n=%d schoolbook square failed\n", n);
+        errs++;
+        continue;
+      }
+
+      mpin_sqr_mini(r2, a, n, scratch);
+      if ( memcmp(r1, r2, 2*n*sizeof(uint32_t)) != 0 )
+      {
+        printf("n=%d square failed\n", n);
+        errs++;
+        continue;
+      }
+    }
+
+    /* (B^n - 1)^2 = (B^n - 2)*B^n + 1 */
+    for (i=0; i<n; i++)
+      a[i] = 0xFFFFFFFF;
+    mpin_sqr_mini(r2, a, n, scratch);
+    mpin_mul_mini(r1, a, a, n, scratch);
+    count++;
+    for (i=0; i<2*n; i++)
+    {
+      uint32_t expect = (i == 0) ? 1 : (i < n) ? 0 : (i == n) ? 0xFFFFFFFE : 0xFFFFFFFF;
+      if ( r1[i] != expect || r2[i] != expect )
+        break;
+    }
+    if ( i < 2*n )
+    {
+      printf("n=%d all-ones failed\n", n);
+      errs++;
+    }
+  }
+
+  /* add/sub */
+  for (iter=0; iter < 1000; iter++)
+  {
+    uint32_t c1, c2;
+
+    n = 1 + rng() % MAXN;
+    random_digits(a, n);
+    random_digits(b, n);
+    count++;
+    c1 = mpin_add_mini(r1, a, b, n);
+    c2 = mpin_sub_mini(r2, r1, b, n);
+    if ( memcmp(r2, a, n*sizeof(uint32_t)) != 0 || (c1 == 1) != (c2 == 0xFFFFFFFF)
+         || (c1 == 1) != (mpin_cmp_mini(r1, a, n) < 0) )
+    {
+      printf("add/sub test %d failed\n", iter);
+      errs++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,83 @@
+#ifndef MPIN_MINI_H
+#define MPIN_MINI_H
+/*
+ * Variable-length multiprecision integers from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+
+/*
+ * These functions work on caller-provided arrays of 32-bit digits,
+ * least-significant first, with the length 'n' (in digits) passed in.
+ * This is for RSA-sized values (2048-4096 bits and beyond), where a
+ * fixed-size UInt_Mini would be far too big for the 256-bit users.
+ *
+ * There is still no memory allocation: the multiply and square functions
+ * take a 'scratch' array of at least MPINMINI_SCRATCH_DIGITS(n) digits,
+ * which they use for intermediate values. Like UInt_Mini, values are
+ * unsigned.
+ *
+ * Multiplication is schoolbook below MPINMINI_KARATSUBA_THRESHOLD digits,
+ * and Karatsuba above it. All of these run in time dependent only on 'n',
+ * apart from mpin_cmp_mini().
+ */
+
+#ifndef MPINMINI_KARATSUBA_THRESHOLD
+#ifdef MPIMINI_64BIT
+#define MPINMINI_KARATSUBA_THRESHOLD 32
+#else
+#define MPINMINI_KARATSUBA_THRESHOLD 16 /* Schoolbook rows are slower here */
+#endif
+#endif
+
+#define MPINMINI_SCRATCH_DIGITS(n) (4*(n) + 160)
+
+extern uint32_t mpin_add_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n );
+/* res = a + b, all n digits. Returns carry-out from top digit (0 or 1).
+ * res may be the same as a or b. */
+
+extern uint32_t mpin_sub_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n );
+/* res = a - b, all n digits. Returns carry-out from top digit, 0 or 0xFFFFFFFF.
+ * res may be the same as a or b. */
+
+extern int mpin_cmp_mini( const uint32_t *a, const uint32_t *b, int n );
+/* Returns -1 if a < b; 0 if a==b; 1 if a > b.
+ * NB: Not constant-time! */
+
+extern void mpin_mul_mini( uint32_t *res, const uint32_t *a, const uint32_t *b, int n,
+                           uint32_t *scratch );
+/* res[0..2n-1] = a * b. res must not overlap a or b. */
+
+extern void mpin_sqr_mini( uint32_t *res, const uint32_t *a, int n, uint32_t *scratch );
+/* res[0..2n-1] = a * a. res must not overlap a. */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef MPIMINI_INTERNAL_API
+
+extern void mpin_mul_school_mini_( uint32_t *res, const uint32_t *a, const uint32_t *b, int n );
+/* res[0..2n-1] = a * b, by rows of mpi_mulrow_n_mini_(). No scratch needed. */
+
+extern void mpin_sqr_school_mini_( uint32_t *res, const uint32_t *a, int n );
+/* res[0..2n-1] = a * a, computing each cross product once. No scratch needed. */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,165 @@
+/*
+ *
+ * Multiprecision integer square from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "mpi_mini.h"
+
+/* Both versions work the same way: each cross product a[i]*a[j] (i < j)
+ * is added in once, the total is doubled with a one-bit shift, and
+ * then the squares a[i]*a[i] are added on the diagonal. The cross
+ * products sum to less than a^2/2, so the doubling can't overflow.
+ */
+
+#ifdef MPIMINI_64BIT
+
+static void sqr_generic( ULong_Mini *res, const UInt_Mini *a )
+{
+    uint64_t r[2*MPIMINI_LIMBS];
+    uint64_t al[MPIMINI_LIMBS];
+    uint64_t carry, hb;
+    int i, j;
+
+    for (i = 0; i < MPIMINI_LIMBS; i++)
+    {
+        al[i] = mpi_getlimb_mini_(a->digits, i);
+        r[i] = r[i+MPIMINI_LIMBS] = 0;
+    }
+
+    for (i = 0; i < MPIMINI_LIMBS-1; i++)
+    {
+        carry = 0;
+        for (j = i+1; j < MPIMINI_LIMBS; j++)
+        {
+            mpi_dlimb_mini_ t = (mpi_dlimb_mini_)al[i] * al[j] + r[i+j] + carry;
+            r[i+j] = (uint64_t)t;
+            carry = (uint64_t)(t >> 64);
+        }
+        r[i+MPIMINI_LIMBS] = carry;
+    }
+
+    /* Doubling and the diagonal in one pass, two limbs at a time;
+     * hb is the bit shifted out of the previous pair. */
+    carry = hb = 0;
+    for (i = 0; i < MPIMINI_LIMBS; i++)
+    {
+        mpi_dlimb_mini_ sq = (mpi_dlimb_mini_)al[i] * al[i];
+        uint64_t lo = r[2*i], hi = r[2*i+1];
+        mpi_dlimb_mini_ t;
+
+        t = (mpi_dlimb_mini_)((lo << 1) | hb) + (uint64_t)sq + carry;
+        r[2*i] = (uint64_t)t;
+        t = (mpi_dlimb_mini_)((hi << 1) | (lo >> 63)) + (uint64_t)(sq >> 64) + (uint64_t)(t >> 64);
+        r[2*i+1] = (uint64_t)t;
+        carry = (uint64_t)(t >> 64);
+        hb = hi >> 63;
+    }
+
+    for (i = 0; i < 2*MPIMINI_LIMBS; i++)
+      mpi_setlimb_mini_(res->digits, i, r[i]);
+}
+
+#else /* 32-bit digits */
+
+static void sqr_generic( ULong_Mini *res, const UInt_Mini *a )
+{
+    uint32_t *r = res->digits;
+    uint32_t carry;
+    int i;
+
+    for (i = 0; i < 2*MPIMINI_DIGITS; i++)
+      r[i] = 0;
+
+    /* Row i adds a[i]*a[i+1..] into r[2i+1 .. i+DIGITS]; as in
+     * mpimul_mini(), the top digit is zero on entry so the carry is too.
+     */
+    for (i = 0; i < MPIMINI_DIGITS-1; i++)
+      mpi_mulrow_n_mini_ ( &r[2*i+1], a->digits[i], &a->digits[i+1], MPIMINI_DIGITS-1-i );
+
+    carry = 0;
+    for (i = 0; i < 2*MPIMINI_DIGITS; i++)
+    {
+        uint32_t d = r[i];
+        r[i] = (d << 1) | carry;
+        carry = d >> 31;
+    }
+
+    carry = 0;
+    for (i = 0; i < MPIMINI_DIGITS; i++)
+    {
+        uint64_t sq = (uint64_t)a->digits[i] * a->digits[i];
+        uint64_t t = (uint64_t)r[2*i] + (uint32_t)sq + carry;
+        r[2*i] = (uint32_t)t;
+        t = (uint64_t)r[2*i+1] + (sq >> 32) + (t >> 32);
+        r[2*i+1] = (uint32_t)t;
+        carry = (uint32_t)(t >> 32);
+    }
+}
+
+#endif /* MPIMINI_64BIT */
+
+void mpisqr_mini( ULong_Mini *res, const UInt_Mini *a )
+{
+    /* The MULX/ADX multiply beats saving products in C */
+    if ( mpi_mulaccel_mini_() )
+      mpimul_mini(res, a, a);
+    else
+      sqr_generic(res, a);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <string.h>
+
+typedef struct
+{
+  UInt_Mini a;
+  UInt_Mini b;
+  ULong_Mini res;
+}
+  MpiMul_TV;
+
+static const MpiMul_TV mul_tvs[] =
+{
+#include "testvectors/mpimul.inc"
+};
+
+static const int mul_tvs_count = sizeof(mul_tvs) / sizeof(MpiMul_TV);
+
+int main(void)
+{
+  int i, errs;
+
+  errs = 0;
+  for (i=0; i < mul_tvs_count; i++)
+  {
+    const MpiMul_TV *tv = &mul_tvs[i];
+    ULong_Mini res, res2, expect;
+
+    /* Every input appears as 'a' somewhere, so square each of them
+     * and check against multiplying it by itself. */
+    mpisqr_mini(&res, &tv->a);
+    sqr_generic(&res2, &tv->a);
+    mpimul_mini(&expect, &tv->a, &tv->a);
+    if ( memcmp(&res, &expect, sizeof(res)) != 0
+         || memcmp(&res2, &expect, sizeof(res)) != 0
+         || (memcmp(&tv->a, &tv->b, sizeof(tv->a)) == 0
+             && memcmp(&res, &tv->res, sizeof(res)) != 0) )
+    {
+      printf("Test #%d failed\n", i);
+      errs ++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, mul_tvs_count);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
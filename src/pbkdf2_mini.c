@@ -0,0 +1,312 @@
+/*
+ *
+ * PBKDF2-HMAC-SHA256 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define SHA2MINI_INTERNAL_API
+#include "pbkdf2_mini.h"
+#include "hmac_mini.h"
+
+#include <string.h>
+
+#define HASHLEN SHA256MINI_HASHLEN
+#define LANES   SHA256MINI_MAX_LANES
+
+/* Each output block of each job is one lane. After U1, every iteration
+   hashes exactly 32 bytes from a cached HMAC state, so the padded block
+   is fixed apart from its first 32 bytes and goes straight to the
+   compression function: two compressions per iteration, no buffering. */
+
+typedef struct
+{
+  HMACSHA256Mini_key key;
+  uint32_t H[8];
+  uint32_t T[8];
+  uint8_t blk[64];
+  uint8_t *out;
+  size_t outlen;
+}
+  Lane;
+
+static void put_BE32(const uint32_t *words, uint8_t *bytes, unsigned nwords)
+{
+  while ( nwords-- > 0 )
+  {
+    uint32_t w = *words++;
+    bytes[0] = (uint8_t)(w >> 24);
+    bytes[1] = (uint8_t)(w >> 16);
+    bytes[2] = (uint8_t)(w >> 8);
+    bytes[3] = (uint8_t)w;
+    bytes += 4;
+  }
+}
+
+static void get_BE32(const uint8_t *bytes, uint32_t *words, unsigned nwords)
+{
+  while ( nwords-- > 0 )
+  {
+    *words++ = ((uint32_t)bytes[0] << 24) | ((uint32_t)bytes[1] << 16)
+             | ((uint32_t)bytes[2] << 8) | bytes[3];
+    bytes += 4;
+  }
+}
+
+static void lane_start(Lane *ln, const PBKDF2Mini_job *job, uint32_t blkno,
+                       uint8_t *out, size_t outlen)
+{
+  HMACSHA256Mini_ctx hc;
+  uint8_t ctr[4], U1[HASHLEN];
+
+  HMACSHA256Mini_SetKey(&ln->key, job->pw, job->pwlen);
+
+  ctr[0] = (uint8_t)(blkno >> 24);
+  ctr[1] = (uint8_t)(blkno >> 16);
+  ctr[2] = (uint8_t)(blkno >> 8);
+  ctr[3] = (uint8_t)blkno;
+  HMACSHA256Mini_Init(&hc, &ln->key);
+  HMACSHA256Mini_Update(&hc, job->salt, job->saltlen);
+  HMACSHA256Mini_Update(&hc, ctr, sizeof(ctr));
+  HMACSHA256Mini_Final(&hc, U1);
+  get_BE32(U1, ln->T, 8);
+
+  /* Padding for a 32-byte message after one 64-byte block */
+  memcpy(ln->blk, U1, HASHLEN);
+  memset(ln->blk + HASHLEN, 0, 64 - HASHLEN);
+  ln->blk[HASHLEN] = 0x80;
+  ln->blk[62] = 0x03;  /* (64+32)*8 = 0x300 bits */
+
+  ln->out = out;
+  ln->outlen = outlen;
+}
+
+static void run_lanes(Lane *lanes, unsigned n, uint32_t iterations)
+{
+  uint32_t *hp[LANES];
+  const uint8_t *mp[LANES];
+  unsigned i, j;
+
+  for (i=0; i < n; i++)
+  {
+    hp[i] = lanes[i].H;
+    mp[i] = lanes[i].blk;
+  }
+
+  while ( --iterations > 0 )
+  {
+    for (i=0; i < n; i++)
+      memcpy(lanes[i].H, lanes[i].key.iH, sizeof(lanes[i].H));
+    SHA256Mini_compress_lanes_(hp, mp, n);
+
+    for (i=0; i < n; i++)
+    {
+      put_BE32(lanes[i].H, lanes[i].blk, 8);
+      memcpy(lanes[i].H, lanes[i].key.oH, sizeof(lanes[i].H));
+    }
+    SHA256Mini_compress_lanes_(hp, mp, n);
+
+    for (i=0; i < n; i++)
+    {
+      put_BE32(lanes[i].H, lanes[i].blk, 8);
+      for (j=0; j < 8; j++)
+        lanes[i].T[j] ^= lanes[i].H[j];
+    }
+  }
+
+  for (i=0; i < n; i++)
+  {
+    uint8_t T[HASHLEN];
+    put_BE32(lanes[i].T, T, 8);
+    memcpy(lanes[i].out, T, lanes[i].outlen);
+    memset(T, 0, sizeof(T));
+  }
+  memset(lanes, 0, n * sizeof(Lane));
+}
+
+MCResult PBKDF2Mini_HMAC_SHA256_Multi(const PBKDF2Mini_job *jobs, size_t count,
+    uint32_t iterations, size_t dklen)
+{
+  Lane lanes[LANES];
+  size_t nblocks = (dklen + HASHLEN - 1) / HASHLEN;
+  size_t i, b;
+  unsigned n = 0;
+
+  if ( iterations == 0 )
+    return MC_BAD_PARAMS;
+  if ( nblocks > 0xFFFFFFFFu )
+    return MC_BAD_LENGTH;
+
+  for (i=0; i < count; i++)
+  {
+    for (b=0; b < nblocks; b++)
+    {
+      size_t off = b * HASHLEN;
+      size_t len = (dklen - off < HASHLEN) ? dklen - off : HASHLEN;
+
+      lane_start(&lanes[n++], &jobs[i], (uint32_t)(b+1), jobs[i].dk + off, len);
+      if ( n == LANES )
+      {
+        run_lanes(lanes, n, iterations);
+        n = 0;
+      }
+    }
+  }
+  if ( n > 0 )
+    run_lanes(lanes, n, iterations);
+  return MC_OK;
+}
+
+MCResult PBKDF2Mini_HMAC_SHA256(const uint8_t *pw, size_t pwlen,
+    const uint8_t *salt, size_t saltlen, uint32_t iterations,
+    uint8_t *dk, size_t dklen)
+{
+  PBKDF2Mini_job job;
+
+  job.pw = pw;
+  job.pwlen = pwlen;
+  job.salt = salt;
+  job.saltlen = saltlen;
+  job.dk = dk;
+  return PBKDF2Mini_HMAC_SHA256_Multi(&job, 1, iterations, dklen);
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* The first two are from RFC 7914 section 11, the rest are the
+   SHA-256 equivalents of the RFC 6070 cases */
+
+typedef struct
+{
+  const char *pw;
+  const char *salt;
+  uint32_t iterations;
+  size_t dklen;
+  uint8_t dk[64];
+}
+  PBKDF2_TV;
+
+static const PBKDF2_TV pbkdf2_tvs[] =
+{
+  { "passwd", "salt", 1, 64,
+    {
+      0x55, 0xac, 0x04, 0x6e, 0x56, 0xe3, 0x08, 0x9f, 0xec, 0x16, 0x91, 0xc2, 0x25, 0x44, 0xb6, 0x05,
+      0xf9, 0x41, 0x85, 0x21, 0x6d, 0xde, 0x04, 0x65, 0xe6, 0x8b, 0x9d, 0x57, 0xc2, 0x0d, 0xac, 0xbc,
+      0x49, 0xca, 0x9c, 0xcc, 0xf1, 0x79, 0xb6, 0x45, 0x99, 0x16, 0x64, 0xb3, 0x9d, 0x77, 0xef, 0x31,
+      0x7c, 0x71, 0xb8, 0x45, 0xb1, 0xe3, 0x0b, 0xd5, 0x09, 0x11, 0x20, 0x41, 0xd3, 0xa1, 0x97, 0x83
+    }
+  },
+
+  { "Password", "NaCl", 80000, 64,
+    {
+      0x4d, 0xdc, 0xd8, 0xf6, 0x0b, 0x98, 0xbe, 0x21, 0x83, 0x0c, 0xee, 0x5e, 0xf2, 0x27, 0x01, 0xf9,
+      0x64, 0x1a, 0x44, 0x18, 0xd0, 0x4c, 0x04, 0x14, 0xae, 0xff, 0x08, 0x87, 0x6b, 0x34, 0xab, 0x56,
+      0xa1, 0xd4, 0x25, 0xa1, 0x22, 0x58, 0x33, 0x54, 0x9a, 0xdb, 0x84, 0x1b, 0x51, 0xc9, 0xb3, 0x17,
+      0x6a, 0x27, 0x2b, 0xde, 0xbb, 0xa1, 0xd0, 0x78, 0x47, 0x8f, 0x62, 0xb3, 0x97, 0xf3, 0x3c, 0x8d
+    }
+  },
+
+  { "password", "salt", 1, 32,
+    {
+      0x12, 0x0f, 0xb6, 0xcf, 0xfc, 0xf8, 0xb3, 0x2c, 0x43, 0xe7, 0x22, 0x52, 0x56, 0xc4, 0xf8, 0x37,
+      0xa8, 0x65, 0x48, 0xc9, 0x2c, 0xcc, 0x35, 0x48, 0x08, 0x05, 0x98, 0x7c, 0xb7, 0x0b, 0xe1, 0x7b
+    }
+  },
+
+  { "password", "salt", 2, 32,
+    {
+      0xae, 0x4d, 0x0c, 0x95, 0xaf, 0x6b, 0x46, 0xd3, 0x2d, 0x0a, 0xdf, 0xf9, 0x28, 0xf0, 0x6d, 0xd0,
+      0x2a, 0x30, 0x3f, 0x8e, 0xf3, 0xc2, 0x51, 0xdf, 0xd6, 0xe2, 0xd8, 0x5a, 0x95, 0x47, 0x4c, 0x43
+    }
+  },
+
+  { "password", "salt", 4096, 32,
+    {
+      0xc5, 0xe4, 0x78, 0xd5, 0x92, 0x88, 0xc8, 0x41, 0xaa, 0x53, 0x0d, 0xb6, 0x84, 0x5c, 0x4c, 0x8d,
+      0x96, 0x28, 0x93, 0xa0, 0x01, 0xce, 0x4e, 0x11, 0xa4, 0x96, 0x38, 0x73, 0xaa, 0x98, 0x13, 0x4a
+    }
+  },
+
+  { "passwordPASSWORDpassword", "saltSALTsaltSALTsaltSALTsaltSALTsalt", 4096, 40,
+    {
+      0x34, 0x8c, 0x89, 0xdb, 0xcb, 0xd3, 0x2b, 0x2f, 0x32, 0xd8, 0x14, 0xb8, 0x11, 0x6e, 0x84, 0xcf,
+      0x2b, 0x17, 0x34, 0x7e, 0xbc, 0x18, 0x00, 0x18, 0x1c, 0x4e, 0x2a, 0x1f, 0xb8, 0xdd, 0x53, 0xe1,
+      0xc6, 0x35, 0x51, 0x8c, 0x7d, 0xac, 0x47, 0xe9
+    }
+  },
+};
+
+static const int pbkdf2_tvs_count = sizeof(pbkdf2_tvs) / sizeof(PBKDF2_TV);
+
+/* Runs all the 4096-iteration vectors as one batch */
+static int test_multi(void)
+{
+  PBKDF2Mini_job jobs[3];
+  uint8_t dk[3][40];
+  int i, n = 0, errs = 0;
+
+  for (i=0; i < pbkdf2_tvs_count; i++)
+  {
+    const PBKDF2_TV *tv = &pbkdf2_tvs[i];
+    if ( tv->iterations != 4096 )
+      continue;
+    jobs[n].pw = (const uint8_t *)tv->pw;
+    jobs[n].pwlen = strlen(tv->pw);
+    jobs[n].salt = (const uint8_t *)tv->salt;
+    jobs[n].saltlen = strlen(tv->salt);
+    jobs[n].dk = dk[n];
+    n++;
+  }
+
+  if ( PBKDF2Mini_HMAC_SHA256_Multi(jobs, n, 4096, 32) != MC_OK )
+    return 1;
+  n = 0;
+  for (i=0; i < pbkdf2_tvs_count; i++)
+  {
+    const PBKDF2_TV *tv = &pbkdf2_tvs[i];
+    if ( tv->iterations != 4096 )
+      continue;
+    if ( memcmp(dk[n], tv->dk, 32) != 0 )
+    {
+      printf("Batch test #%d failed\n", i);
+      errs++;
+    }
+    n++;
+  }
+
+  if ( PBKDF2Mini_HMAC_SHA256_Multi(jobs, n, 0, 32) != MC_BAD_PARAMS )
+    errs++;
+  return errs;
+}
+
+int main(void)
+{
+  int i, errs;
+
+  errs = 0;
+  for (i=0; i < pbkdf2_tvs_count; i++)
+  {
+    const PBKDF2_TV *tv = &pbkdf2_tvs[i];
+    uint8_t dk[64];
+
+    if ( PBKDF2Mini_HMAC_SHA256((const uint8_t *)tv->pw, strlen(tv->pw),
+                                (const uint8_t *)tv->salt, strlen(tv->salt),
+                                tv->iterations, dk, tv->dklen) != MC_OK
+         || memcmp(dk, tv->dk, tv->dklen) != 0 )
+    {
+      printf("Test #%d failed\n", i);
+      errs++;
+    }
+  }
+
+  errs += test_multi();
+  printf("%d errors out of %d\n", errs, pbkdf2_tvs_count + 1);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
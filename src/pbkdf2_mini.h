@@ -0,0 +1,44 @@
+#ifndef PBKDF2_MINI_H
+#define PBKDF2_MINI_H
+/*
+ * PBKDF2-HMAC-SHA256 (RFC 8018) implementation from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+
+typedef struct
+{
+  const uint8_t *pw;
+  size_t pwlen;
+  const uint8_t *salt;
+  size_t saltlen;
+  uint8_t *dk;
+}
+  PBKDF2Mini_job;
+
+extern MCResult PBKDF2Mini_HMAC_SHA256(const uint8_t *pw, size_t pwlen,
+    const uint8_t *salt, size_t saltlen, uint32_t iterations,
+    uint8_t *dk, size_t dklen);
+/* Derives dklen bytes into dk. Returns MC_BAD_PARAMS if iterations is 0.
+ * Where dklen is more than 32 bytes, the output blocks are computed
+ * together in SIMD lanes if possible. */
+
+extern MCResult PBKDF2Mini_HMAC_SHA256_Multi(const PBKDF2Mini_job *jobs, size_t count,
+    uint32_t iterations, size_t dklen);
+/* As PBKDF2Mini_HMAC_SHA256 for each job, all with the same iteration count
+ * and output length. Several candidate passwords are run at once in SIMD
+ * lanes if possible, which is the fast way to check a batch of logins. */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PBKDF2_MINI_H */
@@ -0,0 +1,339 @@
+/*
+ *
+ * RSA signature verification from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define MPIMINI_INTERNAL_API
+#include "rsa_mini.h"
+#include "mpin_mini.h"
+#include "mpiexp_mini.h"
+#include "sha2_mini.h"
+
+#include <string.h>
+
+#define RSAMINI_DIGITS (RSAMINI_MAX_BYTES/4)
+
+/* Big-endian bytes to little-endian digits, and back again */
+static void from_bytes(uint32_t *d, int ndigits, const uint8_t *b, size_t len)
+{
+  size_t i;
+
+  for (i=0; i < (size_t)ndigits; i++)
+    d[i] = 0;
+  for (i=0; i < len; i++)
+    d[i/4] |= (uint32_t)b[len-1-i] << (8*(i%4));
+}
+
+static void to_bytes(uint8_t *b, size_t len, const uint32_t *d)
+{
+  size_t i;
+
+  for (i=0; i < len; i++)
+    b[len-1-i] = (uint8_t)(d[i/4] >> (8*(i%4)));
+}
+
+/* Returns nonzero if the buffers differ; time depends only on len */
+static int differ(const uint8_t *a, const uint8_t *b, size_t len)
+{
+  uint8_t acc = 0;
+  size_t i;
+
+  for (i=0; i < len; i++)
+    acc |= a[i] ^ b[i];
+  return acc != 0;
+}
+
+MCResult RSAMini_InitPublic(RSAMini_pubkey *key, const uint8_t *n, size_t nlen, uint32_t e)
+{
+  uint32_t N[RSAMINI_DIGITS];
+  uint8_t top;
+  MCResult rc;
+
+  while ( nlen > 0 && n[0] == 0 )
+  {
+    n++;
+    nlen--;
+  }
+  if ( nlen < RSAMINI_MIN_BYTES || nlen > RSAMINI_MAX_BYTES )
+    return MC_BAD_LENGTH;
+  if ( (n[nlen-1] & 1) == 0 || (e & 1) == 0 || e < 3 )
+    return MC_BAD_PARAMS;
+
+  from_bytes(N, (int)(nlen+3)/4, n, nlen);
+  rc = mpimont_init_mini(&key->mont, N, (int)(nlen+3)/4);
+  if ( rc != MC_OK )
+    return rc;
+
+  key->k = nlen;
+  key->e = e;
+  key->bits = (int)(8*nlen);
+  for (top = n[0]; (top & 0x80) == 0; top <<= 1)
+    key->bits--;
+  return MC_OK;
+}
+
+MCResult RSAMini_public_(const RSAMini_pubkey *key, const uint8_t *sig, size_t siglen,
+    uint8_t *em)
+{
+  uint32_t s[RSAMINI_DIGITS], x[RSAMINI_DIGITS];
+  const MPIMont_Mini *mont = &key->mont;
+  int i;
+
+  if ( siglen != key->k )
+    return MC_BAD_LENGTH;
+  from_bytes(s, mont->n, sig, siglen);
+  if ( mpin_cmp_mini(s, mont->N, mont->n) >= 0 )
+    return MC_VERIFY_FAILED;
+
+  if ( key->e == 65537 )
+  {
+    /* x = s*R, squared 16 times gives s^65536*R. Multiplying that by s
+     * in normal form takes out the R, so no conversion back is needed. */
+    mpimont_to_mini(mont, x, s);
+    for (i=0; i < 16; i++)
+      mpimont_sqr_mini(mont, x, x);
+    mpimont_mul_mini(mont, x, x, s);
+  }
+  else
+    mpiexp_mini(mont, x, s, &key->e, 1);
+
+  to_bytes(em, key->k, x);
+  return MC_OK;
+}
+
+/* PKCS#1 v1.5 ------------------------------------- */
+
+/* DER encoding of the SHA-256 AlgorithmIdentifier and the digest's header */
+static const uint8_t sha256_digestinfo[] =
+{
+  0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01, 0x65, 0x03, 0x04, 0x02, 0x01,
+  0x05, 0x00, 0x04, 0x20
+};
+
+MCResult RSAMini_VerifyPKCS1v15_SHA256(const RSAMini_pubkey *key, const uint8_t *hash,
+    const uint8_t *sig, size_t siglen)
+{
+  uint8_t em[RSAMINI_MAX_BYTES], expect[RSAMINI_MAX_BYTES];
+  size_t tlen = sizeof(sha256_digestinfo) + SHA256MINI_HASHLEN;
+  MCResult rc;
+
+  rc = RSAMini_public_(key, sig, siglen, em);
+  if ( rc != MC_OK )
+    return rc;
+
+  /* EM = 00 01 FF..FF 00 || DigestInfo || hash */
+  expect[0] = 0x00;
+  expect[1] = 0x01;
+  memset(expect + 2, 0xFF, key->k - tlen - 3);
+  expect[key->k - tlen - 1] = 0x00;
+  memcpy(expect + key->k - tlen, sha256_digestinfo, sizeof(sha256_digestinfo));
+  memcpy(expect + key->k - SHA256MINI_HASHLEN, hash, SHA256MINI_HASHLEN);
+
+  return differ(em, expect, key->k) ? MC_VERIFY_FAILED : MC_OK;
+}
+
+/* PSS --------------------------------------------- */
+
+/* db ^= MGF1-SHA256(seed), for dblen bytes */
+static void mgf1_xor(uint8_t *db, size_t dblen, const uint8_t *seed)
+{
+  uint8_t block[SHA256MINI_HASHLEN + 4], mask[SHA256MINI_HASHLEN];
+  uint32_t counter;
+  size_t pos, i;
+
+  memcpy(block, seed, SHA256MINI_HASHLEN);
+  for (counter=0, pos=0; pos < dblen; counter++)
+  {
+    block[SHA256MINI_HASHLEN]   = (uint8_t)(counter >> 24);
+    block[SHA256MINI_HASHLEN+1] = (uint8_t)(counter >> 16);
+    block[SHA256MINI_HASHLEN+2] = (uint8_t)(counter >> 8);
+    block[SHA256MINI_HASHLEN+3] = (uint8_t)counter;
+    SHA256Mini(block, sizeof(block), mask);
+    for (i=0; i < SHA256MINI_HASHLEN && pos < dblen; i++, pos++)
+      db[pos] ^= mask[i];
+  }
+}
+
+MCResult RSAMini_VerifyPSS_SHA256(const RSAMini_pubkey *key, const uint8_t *hash,
+    const uint8_t *sig, size_t siglen, int saltlen)
+{
+  static const uint8_t zeros[8] = { 0 };
+  uint8_t em[RSAMINI_MAX_BYTES], hcheck[SHA256MINI_HASHLEN];
+  SHA256Mini_ctx ctx;
+  const uint8_t *EM, *H;
+  size_t emlen, dblen, i;
+  int embits = key->bits - 1;
+  int topbits;
+  MCResult rc;
+
+  rc = RSAMini_public_(key, sig, siglen, em);
+  if ( rc != MC_OK )
+    return rc;
+
+  /* EM is emBits = modBits-1 bits long, so if modBits is 1 more than a
+   * multiple of 8, there is a whole zero byte in front of it. */
+  emlen = ((size_t)embits + 7) / 8;
+  EM = em + (key->k - emlen);
+  if ( emlen < key->k && em[0] != 0 )
+    return MC_VERIFY_FAILED;
+  topbits = (int)(8*emlen) - embits;
+
+  if ( emlen < SHA256MINI_HASHLEN + 2
+       || (saltlen != RSAMINI_PSS_SALT_ANY
+           && (saltlen < 0 || emlen < SHA256MINI_HASHLEN + (size_t)saltlen + 2)) )
+    return MC_VERIFY_FAILED;
+  if ( EM[emlen-1] != 0xbc || (EM[0] & (0xFF00 >> topbits)) != 0 )
+    return MC_VERIFY_FAILED;
+
+  /* EM = maskedDB || H || 0xbc; unmask DB in place */
+  dblen = emlen - SHA256MINI_HASHLEN - 1;
+  H = EM + dblen;
+  mgf1_xor((uint8_t *)EM, dblen, H);
+  ((uint8_t *)EM)[0] &= 0xFF >> topbits;
+
+  /* DB = 00..00 01 || salt */
+  for (i=0; i < dblen && EM[i] == 0; i++)
+    ;
+  if ( i == dblen || EM[i] != 0x01 )
+    return MC_VERIFY_FAILED;
+  if ( saltlen == RSAMINI_PSS_SALT_ANY )
+    saltlen = (int)(dblen - i - 1);
+  else if ( i != dblen - (size_t)saltlen - 1 )
+    return MC_VERIFY_FAILED;
+
+  /* H must be SHA256(00*8 || hash || salt) */
+  SHA256Mini_Init(&ctx);
+  SHA256Mini_Update(&ctx, zeros, sizeof(zeros));
+  SHA256Mini_Update(&ctx, hash, SHA256MINI_HASHLEN);
+  SHA256Mini_Update(&ctx, EM + dblen - saltlen, saltlen);
+  SHA256Mini_Final(&ctx, hcheck);
+
+  return differ(hcheck, H, SHA256MINI_HASHLEN) ? MC_VERIFY_FAILED : MC_OK;
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+#include <time.h>
+
+#define RSAMINI_TV_PKCS1 1
+#define RSAMINI_TV_PSS   2
+
+typedef struct
+{
+  size_t nlen;
+  uint8_t n[RSAMINI_MAX_BYTES];
+  uint32_t e;
+  uint8_t hash[SHA256MINI_HASHLEN];
+  int scheme;
+  int saltlen;
+  size_t siglen;
+  uint8_t sig[RSAMINI_MAX_BYTES];
+  MCResult expect;
+}
+  RSA_TV;
+
+static const RSA_TV rsa_tvs[] =
+{
+#include "testvectors/rsa.inc"
+};
+
+static const int rsa_tvs_count = sizeof(rsa_tvs) / sizeof(RSA_TV);
+
+static RSAMini_pubkey key;
+
+static int test_params(void)
+{
+  uint8_t n[RSAMINI_MAX_BYTES+1];
+  int errs = 0;
+
+  memset(n, 0xFF, sizeof(n));
+  if ( RSAMini_InitPublic(&key, n, RSAMINI_MIN_BYTES-1, 65537) != MC_BAD_LENGTH
+       || RSAMini_InitPublic(&key, n, RSAMINI_MAX_BYTES+1, 65537) != MC_BAD_LENGTH
+       || RSAMini_InitPublic(&key, n, RSAMINI_MIN_BYTES, 65536) != MC_BAD_PARAMS
+       || RSAMini_InitPublic(&key, n, RSAMINI_MIN_BYTES, 1) != MC_BAD_PARAMS )
+    errs++;
+  n[RSAMINI_MIN_BYTES-1] = 0xFE;
+  if ( RSAMini_InitPublic(&key, n, RSAMINI_MIN_BYTES, 65537) != MC_BAD_PARAMS )
+    errs++;
+
+  /* Leading zeros are skipped */
+  n[0] = 0;
+  n[RSAMINI_MIN_BYTES] = 0xFF;
+  if ( RSAMini_InitPublic(&key, n, RSAMINI_MIN_BYTES+1, 65537) != MC_OK
+       || key.k != RSAMINI_MIN_BYTES || key.bits != 8*RSAMINI_MIN_BYTES )
+    errs++;
+
+  if ( errs )
+    printf("Parameter checks failed\n");
+  return errs;
+}
+
+static void bench(const RSA_TV *tv)
+{
+  clock_t start;
+  int i, count = 2000;
+
+  RSAMini_InitPublic(&key, tv->n, tv->nlen, tv->e);
+  start = clock();
+  for (i=0; i < count; i++)
+    RSAMini_VerifyPKCS1v15_SHA256(&key, tv->hash, tv->sig, tv->siglen);
+  printf("%d-bit verify: %.1f us\n", key.bits,
+         (double)(clock() - start) * 1e6 / CLOCKS_PER_SEC / count);
+}
+
+int main(int argc, char **argv)
+{
+  int i, errs;
+
+  errs = test_params();
+  for (i=0; i < rsa_tvs_count; i++)
+  {
+    const RSA_TV *tv = &rsa_tvs[i];
+    MCResult rc;
+
+    if ( RSAMini_InitPublic(&key, tv->n, tv->nlen, tv->e) != MC_OK )
+    {
+      printf("Test #%d: init failed\n", i);
+      errs++;
+      continue;
+    }
+
+    if ( tv->scheme == RSAMINI_TV_PKCS1 )
+      rc = RSAMini_VerifyPKCS1v15_SHA256(&key, tv->hash, tv->sig, tv->siglen);
+    else
+      rc = RSAMini_VerifyPSS_SHA256(&key, tv->hash, tv->sig, tv->siglen, tv->saltlen);
+
+    /* A signature of the wrong length is reported as such */
+    if ( tv->siglen != key.k ? rc != MC_BAD_LENGTH : rc != tv->expect )
+    {
+      printf("Test #%d failed (got %d)\n", i, rc);
+      errs++;
+    }
+  }
+
+  printf("%d errors out of %d\n", errs, rsa_tvs_count);
+
+  /* -b: time verification with the first valid PKCS#1 vector of each size */
+  if ( argc > 1 && strcmp(argv[1], "-b") == 0 )
+  {
+    size_t last = 0;
+    for (i=0; i < rsa_tvs_count; i++)
+    {
+      if ( rsa_tvs[i].scheme == RSAMINI_TV_PKCS1 && rsa_tvs[i].expect == MC_OK
+           && rsa_tvs[i].nlen != last && rsa_tvs[i].e == 65537 )
+      {
+        bench(&rsa_tvs[i]);
+        last = rsa_tvs[i].nlen;
+      }
+    }
+  }
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,86 @@
+#ifndef RSA_MINI_H
+#define RSA_MINI_H
+/*
+ * RSA signature verification from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "mpimont_mini.h"
+
+/*
+ * Verifies RSASSA-PKCS1-v1_5 and RSASSA-PSS signatures (RFC 8017) over
+ * SHA-256, for moduli of 2048 to 4096 bits. Only public-key operations
+ * are provided.
+ *
+ * An RSAMini_pubkey holds the Montgomery constants for its modulus, so
+ * set one up with RSAMini_InitPublic() once per key and reuse it; each
+ * verification then costs one modular exponentiation. For the usual
+ * e = 65537 that is 16 Montgomery squarings and two multiplies.
+ */
+
+#define RSAMINI_MIN_BYTES 256   /* 2048 bits */
+#define RSAMINI_MAX_BYTES 512   /* 4096 bits */
+
+#if MPIMONT_MINI_MAX_DIGITS*4 < RSAMINI_MAX_BYTES
+#error "RSA needs MPIMONT_MINI_MAX_DIGITS of at least 128"
+#endif
+
+#define RSAMINI_PSS_SALT_ANY (-1)
+
+typedef struct
+{
+  MPIMont_Mini mont;
+  size_t k;             /* Modulus length in bytes */
+  int bits;             /* Modulus length in bits */
+  uint32_t e;
+}
+  RSAMini_pubkey;
+
+extern MCResult RSAMini_InitPublic(RSAMini_pubkey *key, const uint8_t *n, size_t nlen, uint32_t e);
+/* Sets up a public key from the big-endian modulus n and exponent e.
+ * Leading zero bytes of n are ignored. Returns MC_BAD_LENGTH if the
+ * modulus is not 2048..4096 bits, or MC_BAD_PARAMS if n or e is even,
+ * or e is 1. */
+
+extern MCResult RSAMini_VerifyPKCS1v15_SHA256(const RSAMini_pubkey *key, const uint8_t *hash,
+    const uint8_t *sig, size_t siglen);
+/* Checks an RSASSA-PKCS1-v1_5 signature over the 32-byte SHA-256 hash.
+ * Returns MC_OK if it is valid, MC_VERIFY_FAILED if not, or MC_BAD_LENGTH
+ * if siglen is not the modulus length. */
+
+extern MCResult RSAMini_VerifyPSS_SHA256(const RSAMini_pubkey *key, const uint8_t *hash,
+    const uint8_t *sig, size_t siglen, int saltlen);
+/* Checks an RSASSA-PSS signature over the 32-byte SHA-256 hash, using
+ * SHA-256 for MGF1 too. saltlen is the expected salt length in bytes, or
+ * RSAMINI_PSS_SALT_ANY to accept whatever the signature has. Returns as
+ * RSAMini_VerifyPKCS1v15_SHA256(). */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef MPIMINI_INTERNAL_API
+
+extern MCResult RSAMini_public_(const RSAMini_pubkey *key, const uint8_t *sig, size_t siglen,
+    uint8_t *em);
+/* em[0..k-1] = sig^e mod n, big-endian. Returns MC_BAD_LENGTH if siglen
+ * is not k, or MC_VERIFY_FAILED if sig is not less than n. */
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -4,14 +4,21 @@
  * Note there is NO WARRANTY of any kind.
  */
  
+#define SHA2MINI_INTERNAL_API
 #include "sha2_mini.h"
 
 #include <assert.h>
 #include <string.h>
 
+#if defined(SHA2MINI_X86_ACCEL) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define SHA2MINI_HAVE_X86 1
+#else
+# define SHA2MINI_HAVE_X86 0
+#endif
+
 /* SHA-256 Main compression function */
 
-static const uint32_t K[64] =
+const uint32_t SHA256Mini_K_[64] =
 {
    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
    0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
@@ -23,6 +30,22 @@ static const uint32_t K[64] =
    0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
 };
 
+/* W[i]+K[i] for the last block of a 64-byte message, which is always
+   0x80, zeros, then the length (512 bits). Worked out in advance, so
+   the rounds for it need no message schedule at all. */
+
+const uint32_t SHA256Mini_pad64_WK_[64] =
+{
+   0xc28a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+   0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf374,
+   0x649b69c1, 0xf0fe4786, 0x0fe1edc6, 0x240cf254, 0x4fe9346f, 0x6cc984be, 0x61b9411e, 0x16f988fa,
+   0xf2c65152, 0xa88e5a6d, 0xb019fc65, 0xb9d99ec7, 0x9a1231c3, 0xe70eeaa0, 0xfdb1232b, 0xc7353eb0,
+   0x3069bad5, 0xcb976d5f, 0x5a0f118f, 0xdc1eeefd, 0x0a35b689, 0xde0b7a04, 0x58f4ca9d, 0xe15d5b16,
+   0x007f3e86, 0x37088980, 0xa507ea32, 0x6fab9537, 0x17406110, 0x0d8cd6f1, 0xcdaa3b6d, 0xc0bbbe37,
+   0x83613bda, 0xdb48a363, 0x0b02e931, 0x6fd15ca7, 0x521afaca, 0x31338431, 0x6ed41a95, 0x6d437890,
+   0xc39c91f2, 0x9eccabbd, 0xb5c9a0e6, 0x532fb63c, 0xd2c741c6, 0x07237ea3, 0xa4954b68, 0x4c191d76
+};
+
 static uint32_t ROR(uint32_t v, unsigned n)
 {
   return (v >> n) | (v << (32-n));
@@ -50,47 +73,85 @@ static void put_BE32(const uint32_t *words, uint8_t *bytes, unsigned nwords)
   }
 }
 
-static void SHA256Mini_compress(uint32_t *H, const uint8_t *msg)
-/* H is 8 words, msg is 64 bytes */
+static void compress_generic(uint32_t *H, const uint8_t *msg, size_t nblocks)
+/* H is 8 words, msg is nblocks * 64 bytes */
+{
+  for ( ; nblocks > 0; nblocks--, msg += 64 )
+  {
+    uint32_t W[16];
+    unsigned i;
+
+    get_BE32(msg, W, 16);
+
+    uint32_t a,b,c,d,e,f,g,h;
+
+    a=H[0]; b=H[1]; c=H[2]; d=H[3];
+    e=H[4]; f=H[5]; g=H[6]; h=H[7];
+
+    for (i=0; i<64; i++)
+    {
+      uint32_t temp1, temp2, W_i;
+
+      if ( i < 16 )
+        W_i = W[i];
+      else
+      {
+        temp1 = W[(i-15) & 15];
+        temp1 = ROR(temp1, 7) ^ ROR(temp1, 18) ^ (temp1 >> 3);
+
+        temp2 = W[(i-2) & 15];
+        temp2 = ROR(temp2, 17) ^ ROR(temp2, 19) ^ (temp2 >> 10);
+        W_i = W[i & 15] + W[(i-7) & 15] + temp1 + temp2;
+        W[i & 15] = W_i;
+      }
+
+      temp1 = h + SHA256Mini_K_[i] + W_i;
+      temp1 += ROR(e,6) ^ ROR(e,11) ^ ROR(e,25);
+      temp1 += (e & f) ^ (~e & g);
+
+      temp2 = ROR(a,2) ^ ROR(a,13) ^ ROR(a,22);
+      temp2 += (a & b) ^ (a & c) ^ (b & c);
+
+      h=g;  g=f;  f=e;  e = d + temp1;
+      d=c;  c=b;  b=a;  a = temp1 + temp2;
+    }
+
+    H[0] += a;
+    H[1] += b;
+    H[2] += c;
+    H[3] += d;
+    H[4] += e;
+    H[5] += f;
+    H[6] += g;
+    H[7] += h;
+  }
+}
+
+/* Rounds only, for a schedule with K[i] already added */
+
+static void rounds_wk(uint32_t *H, const uint32_t *WK)
 {
-  uint32_t W[16];
-  unsigned i;
-  
-  get_BE32(msg, W, 16);
-  
   uint32_t a,b,c,d,e,f,g,h;
-  
+  unsigned i;
+
   a=H[0]; b=H[1]; c=H[2]; d=H[3];
   e=H[4]; f=H[5]; g=H[6]; h=H[7];
-  
+
   for (i=0; i<64; i++)
   {
-    uint32_t temp1, temp2, W_i;
-    
-    if ( i < 16 )
-      W_i = W[i];
-    else
-    {
-      temp1 = W[(i-15) & 15];
-      temp1 = ROR(temp1, 7) ^ ROR(temp1, 18) ^ (temp1 >> 3);
+    uint32_t temp1, temp2;
 
-      temp2 = W[(i-2) & 15];
-      temp2 = ROR(temp2, 17) ^ ROR(temp2, 19) ^ (temp2 >> 10);
-      W_i = W[i & 15] + W[(i-7) & 15] + temp1 + temp2;
-      W[i & 15] = W_i;
-    }
-    
-    temp1 = h + K[i] + W_i;
+    temp1 = h + WK[i];
     temp1 += ROR(e,6) ^ ROR(e,11) ^ ROR(e,25);
     temp1 += (e & f) ^ (~e & g);
-    
+
     temp2 = ROR(a,2) ^ ROR(a,13) ^ ROR(a,22);
     temp2 += (a & b) ^ (a & c) ^ (b & c);
-    
+
     h=g;  g=f;  f=e;  e = d + temp1;
     d=c;  c=b;  b=a;  a = temp1 + temp2;
   }
-  
+
   H[0] += a;
   H[1] += b;
   H[2] += c;
@@ -101,6 +162,239 @@ static void SHA256Mini_compress(uint32_t *H, const uint8_t *msg)
   H[7] += h;
 }
 
+#if SHA2MINI_HAVE_X86
+
+/* x86 SHA extensions (SHA256RNDS2/MSG1/MSG2). The state is kept in
+   two registers in the ABEF/CDGH order the instructions want, and
+   only converted back after the last block. */
+
+#include "x86cpu_mini.h"
+#include <immintrin.h>
+
+#define SHANI_ROUNDS4(m, i) \
+  do { \
+    __m128i t_ = _mm_add_epi32(m, _mm_loadu_si128((const __m128i *)&SHA256Mini_K_[4*(i)])); \
+    st1 = _mm_sha256rnds2_epu32(st1, st0, t_); \
+    t_ = _mm_shuffle_epi32(t_, 0x0E); \
+    st0 = _mm_sha256rnds2_epu32(st0, st1, t_); \
+  } while (0)
+
+/* m0 <- next 4 schedule words, given the previous 16 in m0..m3 */
+#define SHANI_SCHED(m0, m1, m2, m3) \
+  m0 = _mm_sha256msg2_epu32( \
+         _mm_add_epi32(_mm_sha256msg1_epu32(m0, m1), _mm_alignr_epi8(m3, m2, 4)), m3)
+
+__attribute__((target("sha,sse4.1,ssse3")))
+static void compress_shani(uint32_t *H, const uint8_t *msg, size_t nblocks)
+{
+  const __m128i bswap = _mm_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  __m128i st0, st1, tmp;
+  unsigned i;
+
+  tmp = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&H[0]), 0xB1); /* CDAB */
+  st1 = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)&H[4]), 0x1B); /* EFGH */
+  st0 = _mm_alignr_epi8(tmp, st1, 8);                                      /* ABEF */
+  st1 = _mm_blend_epi16(st1, tmp, 0xF0);                                   /* CDGH */
+
+  for ( ; nblocks > 0; nblocks--, msg += 64 )
+  {
+    __m128i save0 = st0, save1 = st1;
+    __m128i m0, m1, m2, m3;
+
+    m0 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(msg+ 0)), bswap);
+    m1 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(msg+16)), bswap);
+    m2 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(msg+32)), bswap);
+    m3 = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(msg+48)), bswap);
+
+    SHANI_ROUNDS4(m0, 0);
+    SHANI_ROUNDS4(m1, 1);
+    SHANI_ROUNDS4(m2, 2);
+    SHANI_ROUNDS4(m3, 3);
+    for (i=4; i < 16; i += 4)
+    {
+      SHANI_SCHED(m0, m1, m2, m3);  SHANI_ROUNDS4(m0, i);
+      SHANI_SCHED(m1, m2, m3, m0);  SHANI_ROUNDS4(m1, i+1);
+      SHANI_SCHED(m2, m3, m0, m1);  SHANI_ROUNDS4(m2, i+2);
+      SHANI_SCHED(m3, m0, m1, m2);  SHANI_ROUNDS4(m3, i+3);
+    }
+
+    st0 = _mm_add_epi32(st0, save0);
+    st1 = _mm_add_epi32(st1, save1);
+  }
+
+  tmp = _mm_shuffle_epi32(st0, 0x1B);       /* FEBA */
+  st1 = _mm_shuffle_epi32(st1, 0xB1);       /* DCHG */
+  st0 = _mm_blend_epi16(tmp, st1, 0xF0);    /* DCBA */
+  st1 = _mm_alignr_epi8(st1, tmp, 8);       /* HGFE */
+  _mm_storeu_si128((__m128i *)&H[0], st0);
+  _mm_storeu_si128((__m128i *)&H[4], st1);
+}
+
+/* AVX2 message schedule. Without SHA instructions, the rounds
+   themselves have to be done with scalar code, but the schedule can be
+   computed four words at a time with K[i] already added, leaving the
+   round loop with a single load per round. This is done for two blocks
+   at once, one in each 128-bit half. (The same thing with SSSE3, one
+   block at a time, was measured as no faster than the generic code.) */
+
+#define ROR256(x, n)  _mm256_or_si256(_mm256_srli_epi32(x, n), _mm256_slli_epi32(x, 32-(n)))
+
+/* Next four schedule words from the previous 16 (in x0..x3), in each
+   half. sigma1 needs two of its own outputs, so is done in two halves. */
+__attribute__((target("avx2")))
+static __m256i sched4_avx2(__m256i x0, __m256i x1, __m256i x2, __m256i x3)
+{
+  __m256i w15 = _mm256_alignr_epi8(x1, x0, 4);
+  __m256i w7 = _mm256_alignr_epi8(x3, x2, 4);
+  __m256i t, v, s;
+
+  s = _mm256_xor_si256(_mm256_xor_si256(ROR256(w15, 7), ROR256(w15, 18)), _mm256_srli_epi32(w15, 3));
+  t = _mm256_add_epi32(_mm256_add_epi32(x0, w7), s);
+
+  v = _mm256_shuffle_epi32(x3, 0xFE);
+  s = _mm256_xor_si256(_mm256_xor_si256(ROR256(v, 17), ROR256(v, 19)), _mm256_srli_epi32(v, 10));
+  t = _mm256_add_epi32(t, _mm256_blend_epi32(_mm256_setzero_si256(), s, 0x33));
+
+  v = _mm256_shuffle_epi32(t, 0x40);
+  s = _mm256_xor_si256(_mm256_xor_si256(ROR256(v, 17), ROR256(v, 19)), _mm256_srli_epi32(v, 10));
+  return _mm256_add_epi32(t, _mm256_unpackhi_epi64(_mm256_setzero_si256(), s));
+}
+
+__attribute__((target("avx2")))
+static __m256i load2_avx2(const uint8_t *b0, const uint8_t *b1, __m256i bswap)
+{
+  __m256i v = _mm256_inserti128_si256(
+                _mm256_castsi128_si256(_mm_loadu_si128((const __m128i *)b0)),
+                _mm_loadu_si128((const __m128i *)b1), 1);
+  return _mm256_shuffle_epi8(v, bswap);
+}
+
+__attribute__((target("avx2")))
+static void compress_avx2(uint32_t *H, const uint8_t *msg, size_t nblocks)
+{
+  const __m256i bswap = _mm256_set_epi64x(0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL,
+                                          0x0c0d0e0f08090a0bULL, 0x0405060700010203ULL);
+  uint32_t WK0[64] __attribute__((aligned(32)));
+  uint32_t WK1[64] __attribute__((aligned(32)));
+
+  for ( ; nblocks >= 2; nblocks -= 2, msg += 128 )
+  {
+    __m256i x0, x1, x2, x3, xn, wk;
+    unsigned i;
+
+    x0 = load2_avx2(msg+ 0, msg+ 64, bswap);
+    x1 = load2_avx2(msg+16, msg+ 80, bswap);
+    x2 = load2_avx2(msg+32, msg+ 96, bswap);
+    x3 = load2_avx2(msg+48, msg+112, bswap);
+
+    for (i=0; i < 64; i += 4)
+    {
+      wk = _mm256_add_epi32(x0, _mm256_broadcastsi128_si256(
+                                  _mm_loadu_si128((const __m128i *)&SHA256Mini_K_[i])));
+      _mm_store_si128((__m128i *)&WK0[i], _mm256_castsi256_si128(wk));
+      _mm_store_si128((__m128i *)&WK1[i], _mm256_extracti128_si256(wk, 1));
+      xn = sched4_avx2(x0, x1, x2, x3);
+      x0 = x1;  x1 = x2;  x2 = x3;  x3 = xn;
+    }
+    rounds_wk(H, WK0);
+    rounds_wk(H, WK1);
+  }
+
+  if ( nblocks > 0 )
+    compress_generic(H, msg, nblocks);
+}
+
+static int cpu_has_shani(void)
+{
+  unsigned need = X86MINI_SHA | X86MINI_SSE41 | X86MINI_SSSE3;
+  return (X86Mini_features() & need) == need;
+}
+
+static int cpu_has_avx2(void)
+{
+  unsigned need = X86MINI_AVX2 | X86MINI_SSSE3;
+  return (X86Mini_features() & need) == need;
+}
+
+#endif /* SHA2MINI_HAVE_X86 */
+
+/* Implementation selection ----------------------- */
+
+typedef void (*compress_fn)(uint32_t *H, const uint8_t *msg, size_t nblocks);
+
+typedef struct
+{
+  const char *name;
+  compress_fn fn;
+  int (*supported)(void);
+}
+  CompressImpl;
+
+static int always(void)
+{
+  return 1;
+}
+
+/* Best first */
+static const CompressImpl impls[] =
+{
+#if SHA2MINI_HAVE_X86
+  { "sha-ni", compress_shani, cpu_has_shani },
+  { "avx2", compress_avx2, cpu_has_avx2 },
+#endif
+  { "generic", compress_generic, always },
+  { NULL, NULL, NULL }
+};
+
+static compress_fn compress_impl = NULL;
+
+static compress_fn select_impl(void)
+{
+  /* Racing threads all pick the same entry; the atomics just
+     keep the unsynchronised access well defined */
+  compress_fn fn = __atomic_load_n(&compress_impl, __ATOMIC_RELAXED);
+
+  if ( fn == NULL )
+  {
+    const CompressImpl *ci = impls;
+    while ( !ci->supported() )
+      ci++;
+    fn = ci->fn;
+    __atomic_store_n(&compress_impl, fn, __ATOMIC_RELAXED);
+  }
+  return fn;
+}
+
+void SHA256Mini_compress_(uint32_t *H, const uint8_t *msg, size_t nblocks)
+{
+  select_impl()(H, msg, nblocks);
+}
+
+int SHA256Mini_hwaccel_(void)
+{
+#if SHA2MINI_HAVE_X86
+  return select_impl() == compress_shani;
+#else
+  return 0;
+#endif
+}
+
+static const uint8_t pad64_block[64] =
+{
+  0x80, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+  0,    0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0x02, 0
+};
+
+void SHA256Mini_pad64_(uint32_t *H)
+{
+  /* The SHA instructions beat even a precomputed schedule */
+  if ( SHA256Mini_hwaccel_() )
+    SHA256Mini_compress_(H, pad64_block, 1);
+  else
+    rounds_wk(H, SHA256Mini_pad64_WK_);
+}
 
 static const uint32_t Hinit[8] = 
 {
@@ -126,18 +420,21 @@ void SHA256Mini_Update(SHA256Mini_ctx *ctx, const void *pvmsg, size_t remain)
   {
     uint32_t got = (ctx->count & 63);
     uint32_t space = 64-got;
-    uint32_t taken;
+    size_t taken;
     
     if ( remain >= space ) 
     {
       if ( got==0 ) // Nothing in buffer, avoid copy
-        SHA256Mini_compress(ctx->H, msg);
+      {
+        taken = remain & ~(size_t)63;
+        SHA256Mini_compress_(ctx->H, msg, taken >> 6);
+      }
       else
       {    
         memcpy( ctx->msgbuf + got, msg, space );
-        SHA256Mini_compress(ctx->H, ctx->msgbuf);
+        SHA256Mini_compress_(ctx->H, ctx->msgbuf, 1);
+        taken = space;
       }
-      taken = space;
     }
     else
     {
@@ -164,7 +461,7 @@ void SHA256Mini_Final(SHA256Mini_ctx *ctx, uint8_t *out)
   {
     /* Not enough */
     memset(ctx->msgbuf + got, 0, 64-got);
-    SHA256Mini_compress(ctx->H, ctx->msgbuf);
+    SHA256Mini_compress_(ctx->H, ctx->msgbuf, 1);
     got = 0;
   }
   memset( ctx->msgbuf + got, 0, 64-got );
@@ -186,7 +483,7 @@ void SHA256Mini_Final(SHA256Mini_ctx *ctx, uint8_t *out)
     nbits >>= 8;
   }
   
-  SHA256Mini_compress(ctx->H, ctx->msgbuf);
+  SHA256Mini_compress_(ctx->H, ctx->msgbuf, 1);
 
   put_BE32(ctx->H, out, 8);
 }
@@ -199,6 +496,66 @@ void SHA256Mini(const void *msg, size_t msglen, uint8_t *out32)
   SHA256Mini_Final(&c, out32);
 }
 
+void SHA256Mini_Hash64(const uint8_t *in64, uint8_t *out32)
+{
+  uint32_t H[8];
+
+  memcpy(H, Hinit, sizeof(H));
+  if ( SHA256Mini_hwaccel_() )
+  {
+    /* Both blocks in one call, to keep the state in SHA-NI order */
+    uint8_t blk[128];
+    memcpy(blk, in64, 64);
+    memcpy(blk + 64, pad64_block, 64);
+    SHA256Mini_compress_(H, blk, 2);
+  }
+  else
+  {
+    SHA256Mini_compress_(H, in64, 1);
+    rounds_wk(H, SHA256Mini_pad64_WK_);
+  }
+  put_BE32(H, out32, 8);
+}
+
+size_t SHA256Mini_Export(const SHA256Mini_ctx *ctx, uint8_t *out)
+{
+  uint64_t count = ctx->count;
+  uint32_t got = (ctx->count & 63);
+  int i;
+
+  out[0] = SHA256MINI_EXPORT_VERSION;
+  for (i=8; i > 0; i--)
+  {
+    out[i] = (uint8_t)(count & 0xFF);
+    count >>= 8;
+  }
+  put_BE32(ctx->H, out + 9, 8);
+  memcpy(out + 41, ctx->msgbuf, got);
+  return 41 + got;
+}
+
+MCResult SHA256Mini_Import(SHA256Mini_ctx *ctx, const uint8_t *in, size_t inlen)
+{
+  uint64_t count = 0;
+  uint32_t got;
+  int i;
+
+  if ( inlen < 41 )
+    return MC_BAD_LENGTH;
+  if ( in[0] != SHA256MINI_EXPORT_VERSION )
+    return MC_BAD_PARAMS;
+  for (i=1; i <= 8; i++)
+    count = (count << 8) | in[i];
+  got = (uint32_t)(count & 63);
+  if ( inlen != 41 + got || (size_t)count != count )
+    return MC_BAD_LENGTH;
+
+  ctx->count = (size_t)count;
+  get_BE32(in + 9, ctx->H, 8);
+  memcpy(ctx->msgbuf, in + 41, got);
+  return MC_OK;
+}
+
 /* ----------------------------------------------------------------- */
 
 #ifdef TEST_HARNESS
@@ -265,25 +622,146 @@ static const TestVector tvs[] =
   { NULL, { 0 } }
 };
 
+/* One million 'a's, fed in awkward-sized pieces */
+static const uint8_t million_a[SHA256MINI_HASHLEN] =
+{
+  0xcd, 0xc7, 0x6e, 0x5c, 0x99, 0x14, 0xfb, 0x92,
+  0x81, 0xa1, 0xc7, 0xe2, 0x84, 0xd7, 0x3e, 0x67,
+  0xf1, 0x80, 0x9a, 0x48, 0xa4, 0x97, 0x20, 0x0e,
+  0x04, 0x6d, 0x39, 0xcc, 0xc7, 0x11, 0x2c, 0xd0
+};
+
+static int test_million_a(void)
+{
+  static uint8_t buf[1000];
+  uint8_t res[SHA256MINI_HASHLEN];
+  SHA256Mini_ctx ctx;
+  size_t done = 0, n = 1;
+
+  memset(buf, 'a', sizeof(buf));
+  SHA256Mini_Init(&ctx);
+  while ( done < 1000000 )
+  {
+    if ( n > 1000000 - done )
+      n = 1000000 - done;
+    SHA256Mini_Update(&ctx, buf, n);
+    done += n;
+    n = (n * 7 + 13) % sizeof(buf);
+  }
+  SHA256Mini_Final(&ctx, res);
+  printf("Million a's: ");
+  if ( memcmp(res, million_a, sizeof(res)) != 0 )
+  {
+    printf("FAIL\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
+
+static int test_hash64(void)
+{
+  uint8_t in[64], res[SHA256MINI_HASHLEN], ref[SHA256MINI_HASHLEN];
+  int i, errs = 0;
+
+  for (i=0; i < 64; i++)
+    in[i] = (uint8_t)(i * 29 + 7);
+  for (i=0; i < 3; i++)
+  {
+    SHA256Mini(in, 64, ref);
+    SHA256Mini_Hash64(in, res);
+    if ( memcmp(res, ref, sizeof(ref)) != 0 )
+      errs++;
+    SHA256Mini_Hash64(in, in);
+    if ( memcmp(in, ref, sizeof(ref)) != 0 )
+      errs++;
+  }
+  printf("Hash64: %s\n", errs ? "FAIL" : "OK");
+  return errs;
+}
+
+/* Export at every split point of a message, and finish from the import */
+static int test_export(void)
+{
+  static const char msg[] = "The quick brown fox jumps over the lazy dog, "
+                            "then does it again for good measure, twice over";
+  size_t len = strlen(msg), split, elen;
+  uint8_t ref[SHA256MINI_HASHLEN], res[SHA256MINI_HASHLEN];
+  uint8_t state[SHA256MINI_EXPORT_MAXLEN];
+  SHA256Mini_ctx a, b;
+  int errs = 0;
+
+  SHA256Mini(msg, len, ref);
+  for (split=0; split <= len; split++)
+  {
+    SHA256Mini_Init(&a);
+    SHA256Mini_Update(&a, msg, split);
+    elen = SHA256Mini_Export(&a, state);
+    memset(&b, 0xAA, sizeof(b));
+    if ( elen != 41 + (split & 63) || SHA256Mini_Import(&b, state, elen) != MC_OK )
+    {
+      errs++;
+      continue;
+    }
+    SHA256Mini_Update(&b, msg + split, len - split);
+    SHA256Mini_Final(&b, res);
+    if ( memcmp(res, ref, sizeof(res)) != 0 )
+      errs++;
+  }
+
+  /* Fixed layout: version, BE count, BE H */
+  SHA256Mini_Init(&a);
+  SHA256Mini_Update(&a, msg, 66);
+  elen = SHA256Mini_Export(&a, state);
+  if ( elen != 43 || state[0] != 1 || state[8] != 66 || state[1] != 0
+       || state[41] != (uint8_t)msg[64] || state[42] != (uint8_t)msg[65] )
+    errs++;
+
+  if ( SHA256Mini_Import(&b, state, elen - 1) != MC_BAD_LENGTH
+       || SHA256Mini_Import(&b, state, 40) != MC_BAD_LENGTH )
+    errs++;
+  state[0] = 99;
+  if ( SHA256Mini_Import(&b, state, elen) != MC_BAD_PARAMS )
+    errs++;
+
+  printf("Export/import: %s\n", errs ? "FAIL" : "OK");
+  return errs;
+}
+
 int main()
 {
   const TestVector *tv;
+  const CompressImpl *ci;
   int fails=0;
   
-  for (tv=&tvs[0]; tv->in != NULL; tv++)
+  for (ci=&impls[0]; ci->name != NULL; ci++)
   {
-    uint8_t buf[SHA256MINI_HASHLEN];
-    size_t l = strlen(tv->in);
-    printf("Length %5ld: ", (unsigned long)l);
-    SHA256Mini(tv->in, l, buf);
-    if ( memcmp(buf, tv->out, 32) != 0 )
+    if ( !ci->supported() )
     {
-      fails++;
-      printf("FAIL\n");
+      printf("[%s] not supported on this CPU\n", ci->name);
+      continue;
+    }
+    compress_impl = ci->fn;
+    printf("[%s]\n", ci->name);
+
+    for (tv=&tvs[0]; tv->in != NULL; tv++)
+    {
+      uint8_t buf[SHA256MINI_HASHLEN];
+      size_t l = strlen(tv->in);
+      printf("Length %5ld: ", (unsigned long)l);
+      SHA256Mini(tv->in, l, buf);
+      if ( memcmp(buf, tv->out, 32) != 0 )
+      {
+        fails++;
+        printf("FAIL\n");
+      }
+      else  
+        printf("OK\n");
     }
-    else  
-      printf("OK\n");
+    fails += test_million_a();
+    fails += test_hash64();
   }
+  fails += test_export();
   
   return fails ? 1 : 0;
 }  
@@ -6,6 +6,13 @@
  * https://github.com/IanHarvey/minicrypt
  *
  * In the public domain. Note there is NO WARRANTY.
+ *
+ * When building this, you can #define:
+ *  SHA2MINI_X86_ACCEL to include code using the x86 SHA extensions, or
+ *  failing that AVX2 for the message schedule, and SSE2/AVX2 code
+ *  for hashing several messages at once. Each is used only
+ *  if the CPU supports it (checked at runtime). Needs GCC or clang, and
+ *  linking with x86cpu_mini.c.
  */
 
 #ifdef __cplusplus
@@ -30,6 +37,87 @@ extern void SHA256Mini_Final(SHA256Mini_ctx *ctx, uint8_t *out);
 
 extern void SHA256Mini(const void *msg, size_t msglen, uint8_t *out32);
 
+extern void SHA256Mini_Hash64(const uint8_t *in64, uint8_t *out32);
+/* SHA-256 of exactly 64 bytes, e.g. the two children of a Merkle tree
+ * node. Same result as SHA256Mini(in64, 64, out32), but the second block
+ * is constant and its message schedule is precomputed. */
+
+extern void SHA256Mini_Hash64Multi(const uint8_t *in, size_t count, uint8_t *out);
+/* SHA256Mini_Hash64 of each of the 'count' consecutive 64-byte blocks at
+ * 'in', writing count * SHA256MINI_HASHLEN bytes to 'out'. Uses SIMD lanes
+ * as SHA256Mini_Multi does. 'out' may be the same as 'in', so a tree
+ * level can be hashed in place into the next. */
+
+/* Saving and restoring state
+ *
+ * The exported form is the same on all platforms: a version byte, the
+ * byte count (64-bit big-endian), H[0..7] (big-endian), then the
+ * (count mod 64) bytes not yet compressed. It can be stored and
+ * imported later, e.g. to carry on hashing a log file as it grows
+ * without re-reading what was hashed before.
+ */
+#define SHA256MINI_EXPORT_VERSION 1
+#define SHA256MINI_EXPORT_MAXLEN  (1 + 8 + 32 + 63)
+
+extern size_t SHA256Mini_Export(const SHA256Mini_ctx *ctx, uint8_t *out);
+/* Writes the state to 'out' (up to SHA256MINI_EXPORT_MAXLEN bytes) and
+ * returns its length. The context is not changed. */
+
+extern MCResult SHA256Mini_Import(SHA256Mini_ctx *ctx, const uint8_t *in, size_t inlen);
+/* Restores a state written by SHA256Mini_Export. Returns MC_BAD_PARAMS
+ * for an unknown version, MC_BAD_LENGTH if 'inlen' does not match. */
+
+extern void SHA256Mini_MultiPrefix(const SHA256Mini_ctx *prefix,
+                                   const void *const *msgs, const size_t *msglens,
+                                   size_t count, uint8_t *out);
+/* As SHA256Mini_Multi, but each message is hashed as if appended to the
+ * data already given to 'prefix', which is not changed. Hash a shared
+ * header once into 'prefix' and keep it; if its length is a multiple of
+ * 64 bytes, the messages are hashed in SIMD lanes as in SHA256Mini_Multi. */
+
+extern void SHA256Mini_Multi(const void *const *msgs, const size_t *msglens,
+                             size_t count, uint8_t *out);
+/* Hashes 'count' independent messages, writing count * SHA256MINI_HASHLEN
+ * bytes to 'out'. Where the CPU allows, several messages are hashed at
+ * once in SIMD lanes (see SHA2MINI_X86_ACCEL), which is much faster than
+ * calling SHA256Mini() on each in turn when there are many small messages. */
+
+/* Internal API
+ *
+ * These functions are for use only within the minicrypt library itself,
+ * they may make inconvenient assumptions about the caller, and may change
+ * incompatibly between library versions.
+ */
+#ifdef SHA2MINI_INTERNAL_API
+
+extern const uint32_t SHA256Mini_K_[64];
+/* Round constants */
+
+extern void SHA256Mini_compress_(uint32_t *H, const uint8_t *msg, size_t nblocks);
+/* Compresses nblocks 64-byte blocks from msg into the 8-word state H */
+
+extern int SHA256Mini_hwaccel_(void);
+/* Returns nonzero if SHA256Mini_compress_ is using dedicated SHA instructions */
+
+extern const uint32_t SHA256Mini_pad64_WK_[64];
+/* W[i]+K[i] for the padding block which ends a 64-byte message */
+
+extern void SHA256Mini_pad64_(uint32_t *H);
+/* Compresses that padding block into H */
+
+#define SHA256MINI_MAX_LANES 8
+
+extern unsigned SHA256Mini_lanes_(void);
+/* Returns the number of blocks SHA256Mini_compress_lanes_ works on at once;
+ * callers should try to pass it a multiple of this. */
+
+extern void SHA256Mini_compress_lanes_(uint32_t *const *H, const uint8_t *const *msg,
+                                       unsigned nlanes);
+/* For each i < nlanes, compresses the 64-byte block msg[i] into the
+ * 8-word state H[i]. nlanes may be any number; the states must not overlap. */
+
+#endif
+
 #ifdef __cplusplus
 }
 #endif
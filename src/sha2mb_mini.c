@@ -0,0 +1,555 @@
+/*
+ *
+ * Multi-buffer SHA-256 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#define SHA2MINI_INTERNAL_API
+#include "sha2_mini.h"
+
+#include <string.h>
+
+#if defined(SHA2MINI_X86_ACCEL) && defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+# define SHA2MINI_HAVE_X86 1
+# include "x86cpu_mini.h"
+#else
+# define SHA2MINI_HAVE_X86 0
+#endif
+
+/* Lane kernels -----------------------------------
+
+   A kernel of width N compresses exactly N blocks into N states. */
+
+typedef void (*lanes_fn)(uint32_t *const *H, const uint8_t *const *msg);
+
+/* A pad64 kernel compresses the constant last block of a 64-byte message
+   into N states, using the precomputed schedule. */
+
+typedef void (*lanes_pad64_fn)(uint32_t *const *H);
+
+static void lanes_single(uint32_t *const *H, const uint8_t *const *msg)
+{
+  SHA256Mini_compress_(H[0], msg[0], 1);
+}
+
+static void lanes_single_pad64(uint32_t *const *H)
+{
+  SHA256Mini_pad64_(H[0]);
+}
+
+#if SHA2MINI_HAVE_X86
+
+static uint32_t load_BE32(const uint8_t *p)
+{
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) | ((uint32_t)p[2] << 8) | p[3];
+}
+
+/* The SIMD kernels hold word j of every lane in one vector (GCC vector
+   extensions), and run the ordinary SHA-256 rounds on those vectors. */
+
+typedef uint32_t V4 __attribute__((vector_size(16)));
+typedef uint32_t V8 __attribute__((vector_size(32)));
+
+#define VROR(x, n) (((x) >> (n)) | ((x) << (32-(n))))
+
+/* One round, given W[i]+K[i] as 'wk' */
+#define LANE_ROUND(wk)                                                    \
+  do {                                                                    \
+    t1 = h + (wk)                                                         \
+         + (VROR(e, 6) ^ VROR(e, 11) ^ VROR(e, 25))                       \
+         + ((e & f) ^ (~e & g));                                          \
+    t2 = (VROR(a, 2) ^ VROR(a, 13) ^ VROR(a, 22))                         \
+         + ((a & b) | (c & (a | b)));                                     \
+    h=g;  g=f;  f=e;  e = d + t1;                                         \
+    d=c;  c=b;  b=a;  a = t1 + t2;                                        \
+  } while (0)
+
+#define LANE_LOAD_STATE(NL)                                           \
+  for (i=0; i < NL; i++)                                                  \
+    for (j=0; j < 8; j++)                                                 \
+      tmp[j][i] = H[i][j];                                                \
+  memcpy(S, tmp, sizeof(S));                                              \
+  a=S[0]; b=S[1]; c=S[2]; d=S[3];                                         \
+  e=S[4]; f=S[5]; g=S[6]; h=S[7]
+
+#define LANE_STORE_STATE(NL)                                          \
+  S[0]+=a; S[1]+=b; S[2]+=c; S[3]+=d;                                     \
+  S[4]+=e; S[5]+=f; S[6]+=g; S[7]+=h;                                     \
+  memcpy(tmp, S, sizeof(S));                                              \
+  for (i=0; i < NL; i++)                                                  \
+    for (j=0; j < 8; j++)                                                 \
+      H[i][j] = tmp[j][i]
+
+#define DEFINE_LANE_KERNEL(NAME, TARGET, VT, NL)                          \
+__attribute__((target(TARGET)))                                           \
+static void NAME(uint32_t *const *H, const uint8_t *const *msg)           \
+{                                                                         \
+  uint32_t tmp[16][NL] __attribute__((aligned(32)));                      \
+  VT W[16], S[8];                                                         \
+  VT a, b, c, d, e, f, g, h, t1, t2;                                      \
+  unsigned i, j;                                                          \
+                                                                          \
+  for (i=0; i < NL; i++)                                                  \
+    for (j=0; j < 16; j++)                                                \
+      tmp[j][i] = load_BE32(msg[i] + 4*j);                                \
+  memcpy(W, tmp, sizeof(W));                                              \
+  LANE_LOAD_STATE(NL);                                                \
+                                                                          \
+  for (i=0; i < 64; i++)                                                  \
+  {                                                                       \
+    if ( i >= 16 )                                                        \
+    {                                                                     \
+      t1 = W[(i-15) & 15];                                                \
+      t2 = W[(i-2) & 15];                                                 \
+      W[i & 15] += W[(i-7) & 15]                                          \
+                 + (VROR(t1, 7) ^ VROR(t1, 18) ^ (t1 >> 3))               \
+                 + (VROR(t2, 17) ^ VROR(t2, 19) ^ (t2 >> 10));            \
+    }                                                                     \
+    LANE_ROUND(W[i & 15] + SHA256Mini_K_[i]);                             \
+  }                                                                       \
+                                                                          \
+  LANE_STORE_STATE(NL);                                               \
+}                                                                         \
+                                                                          \
+__attribute__((target(TARGET)))                                           \
+static void NAME##_pad64(uint32_t *const *H)                              \
+{                                                                         \
+  uint32_t tmp[8][NL] __attribute__((aligned(32)));                       \
+  VT S[8];                                                                \
+  VT a, b, c, d, e, f, g, h, t1, t2;                                      \
+  unsigned i, j;                                                          \
+                                                                          \
+  LANE_LOAD_STATE(NL);                                                \
+  for (i=0; i < 64; i++)                                                  \
+    LANE_ROUND(SHA256Mini_pad64_WK_[i]);                                  \
+  LANE_STORE_STATE(NL);                                               \
+}
+
+DEFINE_LANE_KERNEL(lanes_sse2, "sse2", V4, 4)
+DEFINE_LANE_KERNEL(lanes_avx2, "avx2", V8, 8)
+
+static int cpu_has_sse2(void)
+{
+  return (X86Mini_features() & X86MINI_SSE2) != 0;
+}
+
+static int cpu_has_avx2(void)
+{
+  return (X86Mini_features() & X86MINI_AVX2) != 0;
+}
+
+#endif /* SHA2MINI_HAVE_X86 */
+
+/* Kernel selection ------------------------------- */
+
+typedef struct
+{
+  const char *name;
+  unsigned width;
+  lanes_fn fn;
+  lanes_pad64_fn pad64;
+  int (*supported)(void);
+}
+  LanesImpl;
+
+static int always(void)
+{
+  return 1;
+}
+
+/* Best first. Where there are SHA instructions, one stream
+   at a time beats spreading the work across SIMD lanes. */
+static const LanesImpl lanes_impls[] =
+{
+#if SHA2MINI_HAVE_X86
+  { "sha-ni x1", 1, lanes_single, lanes_single_pad64, SHA256Mini_hwaccel_ },
+  { "avx2 x8", 8, lanes_avx2, lanes_avx2_pad64, cpu_has_avx2 },
+  { "sse2 x4", 4, lanes_sse2, lanes_sse2_pad64, cpu_has_sse2 },
+#endif
+  { "generic x1", 1, lanes_single, lanes_single_pad64, always },
+  { NULL, 0, NULL, NULL, NULL }
+};
+
+static const LanesImpl *lanes_impl = NULL;
+
+static const LanesImpl *select_lanes(void)
+{
+  /* Racing threads all pick the same entry; the atomics just
+     keep the unsynchronised access well defined */
+  const LanesImpl *li = __atomic_load_n(&lanes_impl, __ATOMIC_RELAXED);
+
+  if ( li == NULL )
+  {
+    li = lanes_impls;
+    while ( !li->supported() )
+      li++;
+    __atomic_store_n(&lanes_impl, li, __ATOMIC_RELAXED);
+  }
+  return li;
+}
+
+unsigned SHA256Mini_lanes_(void)
+{
+  return select_lanes()->width;
+}
+
+void SHA256Mini_compress_lanes_(uint32_t *const *H, const uint8_t *const *msg,
+                                unsigned nlanes)
+{
+  const LanesImpl *li = select_lanes();
+  unsigned w = li->width;
+
+  while ( nlanes >= w )
+  {
+    li->fn(H, msg);
+    H += w;
+    msg += w;
+    nlanes -= w;
+  }
+
+  if ( nlanes > 0 )
+  {
+    /* Fill up the spare lanes with a dummy block */
+    static const uint8_t zeros[64];
+    uint32_t dummy[8];
+    uint32_t *h2[SHA256MINI_MAX_LANES];
+    const uint8_t *m2[SHA256MINI_MAX_LANES];
+    unsigned i;
+
+    for (i=0; i < w; i++)
+    {
+      h2[i] = (i < nlanes) ? H[i] : dummy;
+      m2[i] = (i < nlanes) ? msg[i] : zeros;
+    }
+    li->fn(h2, m2);
+  }
+}
+
+/* Whole messages --------------------------------- */
+
+typedef struct
+{
+  uint32_t H[8];
+  const uint8_t *msg;
+  size_t nblocks;       /* Whole blocks left at 'msg' */
+  uint8_t tail[128];    /* Last partial block plus padding */
+  unsigned ntail;       /* Blocks left in 'tail' */
+  unsigned tailpos;
+  size_t index;
+}
+  Lane;
+
+static const uint32_t Hinit[8] =
+{
+  0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+  0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+/* H0 is the starting state, after 'prelen' bytes (a multiple of 64) */
+static void lane_start(Lane *ln, const uint32_t *H0, size_t prelen,
+                       const void *msg, size_t len, size_t index)
+{
+  size_t rem = len & 63;
+  size_t nbits = (prelen + len) << 3;
+  uint8_t *p;
+
+  memcpy(ln->H, H0, sizeof(ln->H));
+  ln->msg = (const uint8_t *)msg;
+  ln->nblocks = len >> 6;
+  ln->index = index;
+  ln->tailpos = 0;
+  ln->ntail = (rem < 56) ? 1 : 2;
+
+  memset(ln->tail, 0, sizeof(ln->tail));
+  if ( rem > 0 )
+    memcpy(ln->tail, ln->msg + (len - rem), rem);
+  ln->tail[rem] = 0x80;
+  p = ln->tail + 64*ln->ntail - 1;
+  while ( nbits > 0 )
+  {
+    *p-- = (uint8_t)(nbits & 0xFF);
+    nbits >>= 8;
+  }
+}
+
+static const uint8_t *lane_next(Lane *ln)
+{
+  const uint8_t *p;
+
+  if ( ln->nblocks > 0 )
+  {
+    p = ln->msg;
+    ln->msg += 64;
+    ln->nblocks--;
+  }
+  else
+  {
+    p = ln->tail + 64*ln->tailpos++;
+    ln->ntail--;
+  }
+  return p;
+}
+
+static void lane_output(const Lane *ln, uint8_t *out)
+{
+  unsigned i;
+  out += ln->index * SHA256MINI_HASHLEN;
+  for (i=0; i < 8; i++)
+  {
+    out[4*i]   = (uint8_t)(ln->H[i] >> 24);
+    out[4*i+1] = (uint8_t)(ln->H[i] >> 16);
+    out[4*i+2] = (uint8_t)(ln->H[i] >> 8);
+    out[4*i+3] = (uint8_t)(ln->H[i]);
+  }
+}
+
+static void multi_from(const uint32_t *H0, size_t prelen,
+                       const void *const *msgs, const size_t *msglens,
+                       size_t count, uint8_t *out)
+{
+  Lane lanes[SHA256MINI_MAX_LANES];
+  uint32_t *hp[SHA256MINI_MAX_LANES];
+  const uint8_t *mp[SHA256MINI_MAX_LANES];
+  unsigned width = SHA256Mini_lanes_();
+  unsigned nactive = 0, i;
+  size_t next = 0;
+
+  for (;;)
+  {
+    /* Refill lanes as messages finish */
+    while ( nactive < width && next < count )
+    {
+      lane_start(&lanes[nactive++], H0, prelen, msgs[next], msglens[next], next);
+      next++;
+    }
+    if ( nactive == 0 )
+      break;
+
+    if ( nactive == 1 && lanes[0].nblocks > 0 )
+    {
+      /* Nothing to share the work with; stream the body in one go */
+      SHA256Mini_compress_(lanes[0].H, lanes[0].msg, lanes[0].nblocks);
+      lanes[0].msg += 64 * lanes[0].nblocks;
+      lanes[0].nblocks = 0;
+    }
+
+    for (i=0; i < nactive; i++)
+    {
+      hp[i] = lanes[i].H;
+      mp[i] = lane_next(&lanes[i]);
+    }
+    SHA256Mini_compress_lanes_(hp, mp, nactive);
+
+    for (i=nactive; i-- > 0; )
+    {
+      if ( lanes[i].nblocks == 0 && lanes[i].ntail == 0 )
+      {
+        lane_output(&lanes[i], out);
+        lanes[i] = lanes[--nactive];
+      }
+    }
+  }
+}
+
+void SHA256Mini_Multi(const void *const *msgs, const size_t *msglens,
+                      size_t count, uint8_t *out)
+{
+  multi_from(Hinit, 0, msgs, msglens, count, out);
+}
+
+void SHA256Mini_MultiPrefix(const SHA256Mini_ctx *prefix,
+                            const void *const *msgs, const size_t *msglens,
+                            size_t count, uint8_t *out)
+{
+  size_t i;
+
+  if ( (prefix->count & 63) == 0 )
+  {
+    multi_from(prefix->H, prefix->count, msgs, msglens, count, out);
+    return;
+  }
+
+  /* Part-filled block in the prefix; carry on from a copy for each */
+  for (i=0; i < count; i++)
+  {
+    SHA256Mini_ctx c = *prefix;
+    SHA256Mini_Update(&c, msgs[i], msglens[i]);
+    SHA256Mini_Final(&c, out + i * SHA256MINI_HASHLEN);
+  }
+}
+
+/* Fixed 64-byte messages ------------------------- */
+
+void SHA256Mini_Hash64Multi(const uint8_t *in, size_t count, uint8_t *out)
+{
+  const LanesImpl *li = select_lanes();
+  uint32_t H[SHA256MINI_MAX_LANES][8];
+  uint32_t *hp[SHA256MINI_MAX_LANES];
+  const uint8_t *mp[SHA256MINI_MAX_LANES];
+  unsigned w = li->width, n, i;
+
+  if ( w == 1 )
+  {
+    for (; count > 0; count--, in += 64, out += 32)
+      SHA256Mini_Hash64(in, out);
+    return;
+  }
+
+  memset(H, 0, sizeof(H));
+  for (i=0; i < w; i++)
+    hp[i] = H[i];
+
+  while ( count > 0 )
+  {
+    n = (count < w) ? (unsigned)count : w;
+    for (i=0; i < n; i++)
+    {
+      memcpy(H[i], Hinit, sizeof(Hinit));
+      mp[i] = in + 64*i;
+    }
+    SHA256Mini_compress_lanes_(hp, mp, n);
+
+    /* Spare lanes of a short last group just work on old states */
+    li->pad64(hp);
+
+    /* All of this group's input has been read, so 'out' can overlap it */
+    for (i=0; i < n; i++)
+    {
+      unsigned j;
+      for (j=0; j < 8; j++)
+      {
+        out[32*i+4*j]   = (uint8_t)(H[i][j] >> 24);
+        out[32*i+4*j+1] = (uint8_t)(H[i][j] >> 16);
+        out[32*i+4*j+2] = (uint8_t)(H[i][j] >> 8);
+        out[32*i+4*j+3] = (uint8_t)(H[i][j]);
+      }
+    }
+    in += 64*n;
+    out += 32*n;
+    count -= n;
+  }
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+#define NMSGS 200
+
+static uint8_t data[NMSGS * 64 + 5000];
+
+static int run_tests(void)
+{
+  const void *msgs[NMSGS];
+  size_t lens[NMSGS];
+  uint8_t out[NMSGS * SHA256MINI_HASHLEN];
+  uint8_t ref[SHA256MINI_HASHLEN];
+  size_t i, n, plen, off = 0;
+  int errs = 0;
+
+  /* Mixed lengths, to exercise retiring and refilling lanes, with
+     the occasional long one */
+  for (i=0; i < NMSGS; i++)
+  {
+    lens[i] = (i % 37 == 5) ? 4000 + i : (i * 7) % 130;
+    msgs[i] = data + off;
+    off = (off + 61) % (sizeof(data) - 4200);
+  }
+
+  SHA256Mini_Multi(msgs, lens, NMSGS, out);
+  for (i=0; i < NMSGS; i++)
+  {
+    SHA256Mini(msgs[i], lens[i], ref);
+    if ( memcmp(out + i*SHA256MINI_HASHLEN, ref, sizeof(ref)) != 0 )
+    {
+      printf("Message #%d (len %d) failed\n", (int)i, (int)lens[i]);
+      errs++;
+    }
+  }
+
+  /* Fewer messages than lanes */
+  SHA256Mini_Multi(msgs, lens, 3, out);
+  for (i=0; i < 3; i++)
+  {
+    SHA256Mini(msgs[i], lens[i], ref);
+    if ( memcmp(out + i*SHA256MINI_HASHLEN, ref, sizeof(ref)) != 0 )
+    {
+      printf("Short batch #%d failed\n", (int)i);
+      errs++;
+    }
+  }
+  SHA256Mini_Multi(msgs, lens, 0, out);
+
+  /* Fixed 64-byte messages, including hashing a level in place */
+  for (n=1; n <= 21; n += 10)
+  {
+    static uint8_t buf[21 * 64];
+
+    memcpy(buf, data + 3, n * 64);
+    SHA256Mini_Hash64Multi(buf, n, out);
+    SHA256Mini_Hash64Multi(buf, n, buf);
+    for (i=0; i < n; i++)
+    {
+      SHA256Mini(data + 3 + 64*i, 64, ref);
+      if ( memcmp(out + i*SHA256MINI_HASHLEN, ref, sizeof(ref)) != 0
+           || memcmp(buf + i*SHA256MINI_HASHLEN, ref, sizeof(ref)) != 0 )
+      {
+        printf("Hash64 batch of %d, #%d failed\n", (int)n, (int)i);
+        errs++;
+      }
+    }
+  }
+
+  /* Shared prefixes, block-aligned (lanes) and not (fallback) */
+  for (plen=64; plen <= 200; plen += 136)
+  {
+    SHA256Mini_ctx pfx, c;
+
+    SHA256Mini_Init(&pfx);
+    SHA256Mini_Update(&pfx, data + 7, plen);
+    SHA256Mini_MultiPrefix(&pfx, msgs, lens, 40, out);
+    for (i=0; i < 40; i++)
+    {
+      c = pfx;
+      SHA256Mini_Update(&c, msgs[i], lens[i]);
+      SHA256Mini_Final(&c, ref);
+      if ( memcmp(out + i*SHA256MINI_HASHLEN, ref, sizeof(ref)) != 0 )
+      {
+        printf("Prefix %d message #%d failed\n", (int)plen, (int)i);
+        errs++;
+      }
+    }
+  }
+  return errs;
+}
+
+int main(void)
+{
+  const LanesImpl *li;
+  size_t i;
+  int errs = 0, kerrs;
+
+  for (i=0; i < sizeof(data); i++)
+    data[i] = (uint8_t)(i * 131 + (i >> 8));
+
+  for (li=&lanes_impls[0]; li->name != NULL; li++)
+  {
+    if ( !li->supported() )
+    {
+      printf("[%s] not supported on this CPU\n", li->name);
+      continue;
+    }
+    lanes_impl = li;
+    kerrs = run_tests();
+    printf("[%s] %d errors\n", li->name, kerrs);
+    errs += kerrs;
+  }
+
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
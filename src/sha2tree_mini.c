@@ -0,0 +1,300 @@
+/*
+ *
+ * SHA-256 tree hashing from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "sha2tree_mini.h"
+
+#include <string.h>
+
+#define HASHLEN SHA256MINI_HASHLEN
+
+size_t SHA256TreeMini_LeafCount(size_t datalen, size_t leafsize)
+{
+  if ( leafsize == 0 )
+    return 0;
+  if ( datalen == 0 )
+    return 1;
+  return (datalen - 1) / leafsize + 1;
+}
+
+void SHA256TreeMini_Leaf(const void *data, size_t len, uint8_t *out)
+{
+  static const uint8_t prefix = SHA256TREEMINI_LEAF_PREFIX;
+  SHA256Mini_ctx ctx;
+
+  SHA256Mini_Init(&ctx);
+  SHA256Mini_Update(&ctx, &prefix, 1);
+  SHA256Mini_Update(&ctx, data, len);
+  SHA256Mini_Final(&ctx, out);
+}
+
+void SHA256TreeMini_Node(const uint8_t *children, unsigned nchildren, uint8_t *out)
+{
+  static const uint8_t prefix = SHA256TREEMINI_NODE_PREFIX;
+  SHA256Mini_ctx ctx;
+
+  SHA256Mini_Init(&ctx);
+  SHA256Mini_Update(&ctx, &prefix, 1);
+  SHA256Mini_Update(&ctx, children, (size_t)nchildren * HASHLEN);
+  SHA256Mini_Final(&ctx, out);
+}
+
+static int fanout_ok(unsigned fanout)
+{
+  return fanout >= SHA256TREEMINI_MIN_FANOUT && fanout <= SHA256TREEMINI_MAX_FANOUT;
+}
+
+/* Each level is written over the one below: parent j only reads hashes
+   at j*fanout and up, which nothing before it has overwritten. */
+static MCResult reduce(uint8_t *hashes, size_t n, unsigned fanout,
+                       size_t index, uint8_t *proof, size_t *nproof, uint8_t *root)
+{
+  size_t np = 0, m, j;
+
+  if ( !fanout_ok(fanout) || n == 0 || (proof != NULL && index >= n) )
+    return MC_BAD_PARAMS;
+
+  while ( n > 1 )
+  {
+    if ( proof != NULL )
+    {
+      size_t first = index - index % fanout;
+      size_t end = (n - first < fanout) ? n : first + fanout;
+
+      for (j=first; j < end; j++)
+        if ( j != index )
+          memcpy(proof + HASHLEN * np++, hashes + HASHLEN * j, HASHLEN);
+      index /= fanout;
+    }
+
+    for (j=0, m=0; j < n; j += fanout, m++)
+    {
+      unsigned k = (n - j < fanout) ? (unsigned)(n - j) : fanout;
+      SHA256TreeMini_Node(hashes + HASHLEN * j, k, hashes + HASHLEN * m);
+    }
+    n = m;
+  }
+
+  memcpy(root, hashes, HASHLEN);
+  if ( nproof != NULL )
+    *nproof = np;
+  return MC_OK;
+}
+
+MCResult SHA256TreeMini_Root(uint8_t *hashes, size_t nleaves, unsigned fanout,
+                             uint8_t *root)
+{
+  return reduce(hashes, nleaves, fanout, 0, NULL, NULL, root);
+}
+
+MCResult SHA256TreeMini_Proof(uint8_t *hashes, size_t nleaves, unsigned fanout,
+                              size_t index, uint8_t *proof, size_t *nproof,
+                              uint8_t *root)
+{
+  return reduce(hashes, nleaves, fanout, index, proof, nproof, root);
+}
+
+MCResult SHA256TreeMini_Verify(const uint8_t *leafhash, size_t index,
+                               size_t nleaves, unsigned fanout,
+                               const uint8_t *proof, size_t nproof,
+                               const uint8_t *root)
+{
+  uint8_t group[SHA256TREEMINI_MAX_FANOUT * HASHLEN];
+  uint8_t cur[HASHLEN];
+  size_t n = nleaves, np = 0;
+
+  if ( !fanout_ok(fanout) || index >= nleaves )
+    return MC_VERIFY_FAILED;
+
+  memcpy(cur, leafhash, HASHLEN);
+  while ( n > 1 )
+  {
+    size_t first = index - index % fanout;
+    unsigned k = (n - first < fanout) ? (unsigned)(n - first) : fanout;
+    unsigned j;
+
+    if ( nproof - np < k - 1 )
+      return MC_VERIFY_FAILED;
+    for (j=0; j < k; j++)
+    {
+      if ( first + j == index )
+        memcpy(group + HASHLEN * j, cur, HASHLEN);
+      else
+        memcpy(group + HASHLEN * j, proof + HASHLEN * np++, HASHLEN);
+    }
+    SHA256TreeMini_Node(group, k, cur);
+
+    index /= fanout;
+    n = (n - 1) / fanout + 1;
+  }
+
+  if ( np != nproof || memcmp(cur, root, HASHLEN) != 0 )
+    return MC_VERIFY_FAILED;
+  return MC_OK;
+}
+
+/* Test harness ======================================================= */
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* Roots worked out independently with Python hashlib, over prefixes
+   of the data[] pattern below */
+
+typedef struct
+{
+  size_t datalen;
+  size_t leafsize;
+  unsigned fanout;
+  uint8_t root[HASHLEN];
+}
+  TreeTV;
+
+static const TreeTV tree_tvs[] =
+{
+  { 0, 64, 2,
+    {
+      0x6e, 0x34, 0x0b, 0x9c, 0xff, 0xb3, 0x7a, 0x98,
+      0x9c, 0xa5, 0x44, 0xe6, 0xbb, 0x78, 0x0a, 0x2c,
+      0x78, 0x90, 0x1d, 0x3f, 0xb3, 0x37, 0x38, 0x76,
+      0x85, 0x11, 0xa3, 0x06, 0x17, 0xaf, 0xa0, 0x1d
+    }
+  },
+  { 1000, 64, 2,
+    {
+      0x88, 0x8f, 0x88, 0x53, 0x97, 0xa0, 0x5b, 0xdb,
+      0xae, 0x54, 0xb3, 0xff, 0x67, 0x66, 0x7f, 0xb9,
+      0x78, 0xd2, 0xe4, 0x24, 0x4f, 0x1b, 0x5a, 0x76,
+      0xf1, 0x08, 0x85, 0xa9, 0xf3, 0x6b, 0x73, 0xc1
+    }
+  },
+  { 1000, 64, 3,
+    {
+      0x21, 0x95, 0x44, 0x04, 0x04, 0xd6, 0x96, 0xa8,
+      0x7b, 0x99, 0x42, 0xe8, 0xd2, 0x6b, 0x78, 0x2d,
+      0xb5, 0xde, 0xaa, 0x94, 0x9b, 0x31, 0x06, 0x80,
+      0x70, 0xbd, 0x51, 0x3c, 0x8f, 0x86, 0x99, 0x00
+    }
+  },
+  { 1000, 100, 16,
+    {
+      0xe2, 0xac, 0x9c, 0x1b, 0x49, 0x0c, 0x20, 0x1e,
+      0xed, 0xd3, 0x35, 0xcc, 0x28, 0x2b, 0x62, 0xc8,
+      0xb2, 0x90, 0xd1, 0xa0, 0x28, 0x08, 0x68, 0xe1,
+      0x5c, 0xe8, 0x3b, 0x36, 0x13, 0x12, 0x60, 0xf3
+    }
+  },
+  { 1000, 1000, 4,
+    {
+      0x86, 0xd8, 0xdb, 0x04, 0xac, 0x23, 0xdc, 0xd2,
+      0x35, 0xb3, 0xc6, 0x35, 0x65, 0xde, 0xe3, 0x58,
+      0xcc, 0x00, 0x13, 0xec, 0x0e, 0xdd, 0xdf, 0x65,
+      0x2e, 0x5b, 0x31, 0xb3, 0xf5, 0x92, 0xb4, 0x86
+    }
+  },
+  { 640, 64, 4,
+    {
+      0xc4, 0x80, 0xfd, 0x22, 0xf5, 0x15, 0x2b, 0xfb,
+      0xda, 0x3a, 0xf4, 0xc1, 0xe8, 0xb5, 0xd6, 0x11,
+      0xe2, 0x34, 0xa7, 0xc2, 0x71, 0xbf, 0x7c, 0xb6,
+      0x39, 0x27, 0x41, 0x5b, 0x33, 0x17, 0x66, 0x42
+    }
+  },
+};
+
+static const int tree_tvs_count = sizeof(tree_tvs) / sizeof(TreeTV);
+
+#define MAX_LEAVES 16
+
+static uint8_t data[1000];
+
+static size_t leaf_hashes(const TreeTV *tv, uint8_t *hashes)
+{
+  size_t n = SHA256TreeMini_LeafCount(tv->datalen, tv->leafsize), i;
+
+  for (i=0; i < n; i++)
+  {
+    size_t off = i * tv->leafsize;
+    size_t len = (tv->datalen - off < tv->leafsize) ? tv->datalen - off : tv->leafsize;
+    SHA256TreeMini_Leaf(data + off, len, hashes + HASHLEN * i);
+  }
+  return n;
+}
+
+/* Proofs for every leaf must verify, and fail if any byte is changed */
+static int test_proofs(const TreeTV *tv)
+{
+  uint8_t leaves[MAX_LEAVES * HASHLEN], work[MAX_LEAVES * HASHLEN];
+  uint8_t proof[MAX_LEAVES * HASHLEN], root[HASHLEN];
+  size_t n = leaf_hashes(tv, leaves), i, np;
+  int errs = 0;
+
+  for (i=0; i < n; i++)
+  {
+    memcpy(work, leaves, sizeof(work));
+    if ( SHA256TreeMini_Proof(work, n, tv->fanout, i, proof, &np, root) != MC_OK
+         || memcmp(root, tv->root, HASHLEN) != 0
+         || SHA256TreeMini_Verify(leaves + HASHLEN * i, i, n, tv->fanout,
+                                  proof, np, root) != MC_OK )
+    {
+      errs++;
+      continue;
+    }
+    if ( np > 0 )
+    {
+      proof[HASHLEN * np - 1] ^= 1;
+      if ( SHA256TreeMini_Verify(leaves + HASHLEN * i, i, n, tv->fanout,
+                                 proof, np, root) != MC_VERIFY_FAILED )
+        errs++;
+      proof[HASHLEN * np - 1] ^= 1;
+      if ( SHA256TreeMini_Verify(leaves + HASHLEN * i, i, n, tv->fanout,
+                                 proof, np - 1, root) != MC_VERIFY_FAILED )
+        errs++;
+    }
+    if ( n > 1 && SHA256TreeMini_Verify(leaves + HASHLEN * i, (i+1) % n, n,
+                                        tv->fanout, proof, np, root) != MC_VERIFY_FAILED )
+      errs++;
+  }
+  return errs;
+}
+
+int main(void)
+{
+  uint8_t hashes[MAX_LEAVES * HASHLEN], root[HASHLEN];
+  int i, errs = 0;
+
+  for (i=0; i < (int)sizeof(data); i++)
+    data[i] = (uint8_t)(i * 131 + (i >> 8));
+
+  for (i=0; i < tree_tvs_count; i++)
+  {
+    const TreeTV *tv = &tree_tvs[i];
+    size_t n = leaf_hashes(tv, hashes);
+
+    if ( SHA256TreeMini_Root(hashes, n, tv->fanout, root) != MC_OK
+         || memcmp(root, tv->root, HASHLEN) != 0 )
+    {
+      printf("Test #%d root failed\n", i);
+      errs++;
+    }
+    else if ( test_proofs(tv) != 0 )
+    {
+      printf("Test #%d proofs failed\n", i);
+      errs++;
+    }
+  }
+
+  if ( SHA256TreeMini_Root(hashes, 4, 1, root) != MC_BAD_PARAMS
+       || SHA256TreeMini_Root(hashes, 0, 2, root) != MC_BAD_PARAMS )
+    errs++;
+
+  printf("%d errors out of %d\n", errs, tree_tvs_count + 1);
+  return (errs==0) ? 0 : 1;
+}
+
+#endif /* TEST_HARNESS */
@@ -0,0 +1,71 @@
+#ifndef SHA2TREE_MINI_H
+#define SHA2TREE_MINI_H
+/*
+ * SHA-256 tree hashing from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * The input is split into fixed-size leaves (the last may be short; an
+ * empty input is one empty leaf). Each leaf is hashed as
+ *   SHA-256(0x00 || leaf data)
+ * and then each group of up to 'fanout' consecutive hashes is replaced by
+ *   SHA-256(0x01 || child hash || child hash ...)
+ * until one hash, the root, is left. The prefix bytes keep leaves and
+ * interior nodes apart, so one cannot be passed off as the other.
+ *
+ * Since leaves are independent they can be hashed on as many cores as
+ * are available; SHA256TreeMini_Root then only has about
+ * nleaves/(fanout-1) small hashes left to do.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+#include "sha2_mini.h"
+
+#define SHA256TREEMINI_LEAF_PREFIX 0x00
+#define SHA256TREEMINI_NODE_PREFIX 0x01
+
+#define SHA256TREEMINI_MIN_FANOUT  2
+#define SHA256TREEMINI_MAX_FANOUT  16
+
+extern size_t SHA256TreeMini_LeafCount(size_t datalen, size_t leafsize);
+/* Returns the number of leaves for 'datalen' bytes of input */
+
+extern void SHA256TreeMini_Leaf(const void *data, size_t len, uint8_t *out);
+/* Hashes one leaf into SHA256MINI_HASHLEN bytes at 'out' */
+
+extern void SHA256TreeMini_Node(const uint8_t *children, unsigned nchildren, uint8_t *out);
+/* Hashes 'nchildren' consecutive child hashes into 'out', which may
+ * be the same as 'children' */
+
+extern MCResult SHA256TreeMini_Root(uint8_t *hashes, size_t nleaves, unsigned fanout,
+                                    uint8_t *root);
+/* Works out the root from the 'nleaves' leaf hashes in 'hashes', which
+ * is used as workspace and overwritten. Returns MC_BAD_PARAMS if fanout
+ * is out of range or there are no leaves. */
+
+extern MCResult SHA256TreeMini_Proof(uint8_t *hashes, size_t nleaves, unsigned fanout,
+                                     size_t index, uint8_t *proof, size_t *nproof,
+                                     uint8_t *root);
+/* As SHA256TreeMini_Root, and also writes the proof for leaf 'index':
+ * the other hashes in its group at each level, from the bottom up, in
+ * order. *nproof is set to the number of hashes written; there are at most
+ * (fanout-1) per level. */
+
+extern MCResult SHA256TreeMini_Verify(const uint8_t *leafhash, size_t index,
+                                      size_t nleaves, unsigned fanout,
+                                      const uint8_t *proof, size_t nproof,
+                                      const uint8_t *root);
+/* Checks that a leaf hash and proof lead to 'root'. Returns MC_OK, or
+ * MC_VERIFY_FAILED if not (including a proof of the wrong length). */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA2TREE_MINI_H */
@@ -0,0 +1,656 @@
+/*
+ *
+ * SHA-384/512 from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "sha512_mini.h"
+
+#include <string.h>
+
+static const uint64_t K[80] =
+{
+  0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL, 0xe9b5dba58189dbbcULL,
+  0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL, 0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL,
+  0xd807aa98a3030242ULL, 0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+  0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL, 0xc19bf174cf692694ULL,
+  0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL, 0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL,
+  0x2de92c6f592b0275ULL, 0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+  0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL, 0xbf597fc7beef0ee4ULL,
+  0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL, 0x06ca6351e003826fULL, 0x142929670a0e6e70ULL,
+  0x27b70a8546d22ffcULL, 0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+  0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL, 0x92722c851482353bULL,
+  0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL, 0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL,
+  0xd192e819d6ef5218ULL, 0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+  0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL, 0x34b0bcb5e19b48a8ULL,
+  0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL, 0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL,
+  0x748f82ee5defb2fcULL, 0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+  0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL, 0xc67178f2e372532bULL,
+  0xca273eceea26619cULL, 0xd186b8c721c0c207ULL, 0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL,
+  0x06f067aa72176fbaULL, 0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+  0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL, 0x431d67c49c100d4cULL,
+  0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL, 0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static uint64_t ROR64(uint64_t v, unsigned n)
+{
+  return (v >> n) | (v << (64-n));
+}
+
+static uint64_t get_BE64(const uint8_t *p)
+{
+  return ((uint64_t)p[0] << 56) | ((uint64_t)p[1] << 48)
+       | ((uint64_t)p[2] << 40) | ((uint64_t)p[3] << 32)
+       | ((uint64_t)p[4] << 24) | ((uint64_t)p[5] << 16)
+       | ((uint64_t)p[6] << 8)  | p[7];
+}
+
+static void put_BE64(uint64_t v, uint8_t *p)
+{
+  int i;
+  for (i=7; i >= 0; i--)
+  {
+    p[i] = (uint8_t)(v & 0xFF);
+    v >>= 8;
+  }
+}
+
+/* Compression, unrolled eight rounds at a time. Rather than shuffling
+   a..h along after each round, each of the eight rounds names them in a
+   rotated order, so only d and h are written. */
+
+#define S0(x)  (ROR64(x,28) ^ ROR64(x,34) ^ ROR64(x,39))
+#define S1(x)  (ROR64(x,14) ^ ROR64(x,18) ^ ROR64(x,41))
+#define s0(x)  (ROR64(x,1) ^ ROR64(x,8) ^ ((x) >> 7))
+#define s1(x)  (ROR64(x,19) ^ ROR64(x,61) ^ ((x) >> 6))
+
+#define ROUND(a,b,c,d,e,f,g,h,wk) \
+  do { \
+    uint64_t t1_ = h + S1(e) + ((e & f) ^ (~e & g)) + (wk); \
+    d += t1_; \
+    h = t1_ + S0(a) + ((a & b) | (c & (a | b))); \
+  } while (0)
+
+#define ROUNDS8(WK, i) \
+  do { \
+    ROUND(a,b,c,d,e,f,g,h, WK(i)); \
+    ROUND(h,a,b,c,d,e,f,g, WK(i+1)); \
+    ROUND(g,h,a,b,c,d,e,f, WK(i+2)); \
+    ROUND(f,g,h,a,b,c,d,e, WK(i+3)); \
+    ROUND(e,f,g,h,a,b,c,d, WK(i+4)); \
+    ROUND(d,e,f,g,h,a,b,c, WK(i+5)); \
+    ROUND(c,d,e,f,g,h,a,b, WK(i+6)); \
+    ROUND(b,c,d,e,f,g,h,a, WK(i+7)); \
+  } while (0)
+
+#define LOAD_STATE() \
+  a=H[0]; b=H[1]; c=H[2]; d=H[3]; \
+  e=H[4]; f=H[5]; g=H[6]; h=H[7]
+
+#define ADD_STATE() \
+  H[0]+=a; H[1]+=b; H[2]+=c; H[3]+=d; \
+  H[4]+=e; H[5]+=f; H[6]+=g; H[7]+=h
+
+/* W[i]+K[i]; from round 16 on, W is a 16-word ring updated in place */
+#define WK_LOAD(i)   (W[i] + K[i])
+#define WK_SCHED(i)  ((W[(i) & 15] += s1(W[((i)-2) & 15]) + W[((i)-7) & 15] \
+                                      + s0(W[((i)-15) & 15])) + K[i])
+
+static void compress(uint64_t *H, const uint8_t *msg, size_t nblocks)
+/* H is 8 words, msg is nblocks * 128 bytes */
+{
+  for ( ; nblocks > 0; nblocks--, msg += 128 )
+  {
+    uint64_t W[16];
+    uint64_t a,b,c,d,e,f,g,h;
+    unsigned i;
+
+    for (i=0; i < 16; i++)
+      W[i] = get_BE64(msg + 8*i);
+
+    LOAD_STATE();
+    ROUNDS8(WK_LOAD, 0);
+    ROUNDS8(WK_LOAD, 8);
+    for (i=16; i < 80; i += 8)
+      ROUNDS8(WK_SCHED, i);
+    ADD_STATE();
+  }
+}
+
+/* Hashing --------------------------------------- */
+
+static const uint64_t Hinit512[8] =
+{
+  0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL, 0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+  0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL, 0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint64_t Hinit384[8] =
+{
+  0xcbbb9d5dc1059ed8ULL, 0x629a292a367cd507ULL, 0x9159015a3070dd17ULL, 0x152fecd8f70e5939ULL,
+  0x67332667ffc00b31ULL, 0x8eb44a8768581511ULL, 0xdb0c2e0d64f98fa7ULL, 0x47b5481dbefa4fa4ULL
+};
+
+static const uint64_t Hinit512_256[8] =
+{
+  0x22312194fc2bf72cULL, 0x9f555fa3c84c64c2ULL, 0x2393b86b6f53b151ULL, 0x963877195940eabdULL,
+  0x96283ee2a88effe3ULL, 0xbe5e1e2553863992ULL, 0x2b0199fc2c85b8aaULL, 0x0eb72ddc81c52ca2ULL
+};
+
+static void init(SHA512Mini_ctx *ctx, const uint64_t *Hinit)
+{
+  memcpy(ctx->H, Hinit, sizeof(ctx->H));
+  ctx->count = 0;
+}
+
+void SHA512Mini_Update(SHA512Mini_ctx *ctx, const void *pvmsg, size_t remain)
+{
+  const uint8_t *msg = (const uint8_t *)pvmsg;
+
+  while ( remain > 0 )
+  {
+    unsigned got = (unsigned)(ctx->count & 127);
+    unsigned space = 128-got;
+    size_t taken;
+
+    if ( remain >= space )
+    {
+      if ( got==0 ) // Nothing in buffer, avoid copy
+      {
+        taken = remain & ~(size_t)127;
+        compress(ctx->H, msg, taken >> 7);
+      }
+      else
+      {
+        memcpy( ctx->msgbuf + got, msg, space );
+        compress(ctx->H, ctx->msgbuf, 1);
+        taken = space;
+      }
+    }
+    else
+    {
+      // Will have to buffer until next time
+      memcpy( ctx->msgbuf + got, msg, remain );
+      taken = remain;
+    }
+    ctx->count += taken;
+    msg += taken;
+    remain -= taken;
+  }
+}
+
+/* Pads and writes the first 'outlen' bytes of the state */
+static void final(SHA512Mini_ctx *ctx, uint8_t *out, unsigned outlen)
+{
+  unsigned got = (unsigned)(ctx->count & 127);
+  uint8_t word[8];
+  unsigned i;
+
+  ctx->msgbuf[got++] = 0x80;
+  if ( got > 112 )
+  {
+    memset(ctx->msgbuf + got, 0, 128-got);
+    compress(ctx->H, ctx->msgbuf, 1);
+    got = 0;
+  }
+  memset(ctx->msgbuf + got, 0, 128-got);
+
+  /* 128-bit length in bits, big-endian */
+  put_BE64(ctx->count >> 61, ctx->msgbuf + 112);
+  put_BE64(ctx->count << 3, ctx->msgbuf + 120);
+  compress(ctx->H, ctx->msgbuf, 1);
+
+  for (i=0; i < outlen; i += 8)
+  {
+    put_BE64(ctx->H[i/8], word);
+    memcpy(out + i, word, (outlen - i < 8) ? outlen - i : 8);
+  }
+}
+
+void SHA512Mini_Init(SHA512Mini_ctx *ctx)
+{
+  init(ctx, Hinit512);
+}
+
+void SHA512Mini_Final(SHA512Mini_ctx *ctx, uint8_t *out)
+{
+  final(ctx, out, SHA512MINI_HASHLEN);
+}
+
+void SHA384Mini_Init(SHA384Mini_ctx *ctx)
+{
+  init(ctx, Hinit384);
+}
+
+void SHA384Mini_Update(SHA384Mini_ctx *ctx, const void *pvmsg, size_t msglen)
+{
+  SHA512Mini_Update(ctx, pvmsg, msglen);
+}
+
+void SHA384Mini_Final(SHA384Mini_ctx *ctx, uint8_t *out)
+{
+  final(ctx, out, SHA384MINI_HASHLEN);
+}
+
+void SHA512_256Mini_Init(SHA512_256Mini_ctx *ctx)
+{
+  init(ctx, Hinit512_256);
+}
+
+void SHA512_256Mini_Update(SHA512_256Mini_ctx *ctx, const void *pvmsg, size_t msglen)
+{
+  SHA512Mini_Update(ctx, pvmsg, msglen);
+}
+
+void SHA512_256Mini_Final(SHA512_256Mini_ctx *ctx, uint8_t *out)
+{
+  final(ctx, out, SHA512_256MINI_HASHLEN);
+}
+
+void SHA512Mini(const void *msg, size_t msglen, uint8_t *out64)
+{
+  SHA512Mini_ctx c;
+  SHA512Mini_Init(&c);
+  SHA512Mini_Update(&c, msg, msglen);
+  SHA512Mini_Final(&c, out64);
+}
+
+void SHA384Mini(const void *msg, size_t msglen, uint8_t *out48)
+{
+  SHA384Mini_ctx c;
+  SHA384Mini_Init(&c);
+  SHA384Mini_Update(&c, msg, msglen);
+  SHA384Mini_Final(&c, out48);
+}
+
+void SHA512_256Mini(const void *msg, size_t msglen, uint8_t *out32)
+{
+  SHA512_256Mini_ctx c;
+  SHA512_256Mini_Init(&c);
+  SHA512_256Mini_Update(&c, msg, msglen);
+  SHA512_256Mini_Final(&c, out32);
+}
+
+/* ----------------------------------------------------------------- */
+
+#ifdef TEST_HARNESS
+
+#include <stdio.h>
+
+/* From Python hashlib: the FIPS 180 examples, then runs of the alphabet
+   around the one- and two-block padding boundaries */
+
+typedef struct
+{
+  const char *in;
+  uint8_t out384[SHA384MINI_HASHLEN];
+  uint8_t out512[SHA512MINI_HASHLEN];
+  uint8_t out512_256[SHA512_256MINI_HASHLEN];
+}
+  TestVector;
+
+static const TestVector tvs[] =
+{
+  { "",
+    {
+      0x38, 0xb0, 0x60, 0xa7, 0x51, 0xac, 0x96, 0x38,
+      0x4c, 0xd9, 0x32, 0x7e, 0xb1, 0xb1, 0xe3, 0x6a,
+      0x21, 0xfd, 0xb7, 0x11, 0x14, 0xbe, 0x07, 0x43,
+      0x4c, 0x0c, 0xc7, 0xbf, 0x63, 0xf6, 0xe1, 0xda,
+      0x27, 0x4e, 0xde, 0xbf, 0xe7, 0x6f, 0x65, 0xfb,
+      0xd5, 0x1a, 0xd2, 0xf1, 0x48, 0x98, 0xb9, 0x5b
+    },
+    {
+      0xcf, 0x83, 0xe1, 0x35, 0x7e, 0xef, 0xb8, 0xbd,
+      0xf1, 0x54, 0x28, 0x50, 0xd6, 0x6d, 0x80, 0x07,
+      0xd6, 0x20, 0xe4, 0x05, 0x0b, 0x57, 0x15, 0xdc,
+      0x83, 0xf4, 0xa9, 0x21, 0xd3, 0x6c, 0xe9, 0xce,
+      0x47, 0xd0, 0xd1, 0x3c, 0x5d, 0x85, 0xf2, 0xb0,
+      0xff, 0x83, 0x18, 0xd2, 0x87, 0x7e, 0xec, 0x2f,
+      0x63, 0xb9, 0x31, 0xbd, 0x47, 0x41, 0x7a, 0x81,
+      0xa5, 0x38, 0x32, 0x7a, 0xf9, 0x27, 0xda, 0x3e
+    },
+    {
+      0xc6, 0x72, 0xb8, 0xd1, 0xef, 0x56, 0xed, 0x28,
+      0xab, 0x87, 0xc3, 0x62, 0x2c, 0x51, 0x14, 0x06,
+      0x9b, 0xdd, 0x3a, 0xd7, 0xb8, 0xf9, 0x73, 0x74,
+      0x98, 0xd0, 0xc0, 0x1e, 0xce, 0xf0, 0x96, 0x7a
+    }
+  },
+  { "abc",
+    {
+      0xcb, 0x00, 0x75, 0x3f, 0x45, 0xa3, 0x5e, 0x8b,
+      0xb5, 0xa0, 0x3d, 0x69, 0x9a, 0xc6, 0x50, 0x07,
+      0x27, 0x2c, 0x32, 0xab, 0x0e, 0xde, 0xd1, 0x63,
+      0x1a, 0x8b, 0x60, 0x5a, 0x43, 0xff, 0x5b, 0xed,
+      0x80, 0x86, 0x07, 0x2b, 0xa1, 0xe7, 0xcc, 0x23,
+      0x58, 0xba, 0xec, 0xa1, 0x34, 0xc8, 0x25, 0xa7
+    },
+    {
+      0xdd, 0xaf, 0x35, 0xa1, 0x93, 0x61, 0x7a, 0xba,
+      0xcc, 0x41, 0x73, 0x49, 0xae, 0x20, 0x41, 0x31,
+      0x12, 0xe6, 0xfa, 0x4e, 0x89, 0xa9, 0x7e, 0xa2,
+      0x0a, 0x9e, 0xee, 0xe6, 0x4b, 0x55, 0xd3, 0x9a,
+      0x21, 0x92, 0x99, 0x2a, 0x27, 0x4f, 0xc1, 0xa8,
+      0x36, 0xba, 0x3c, 0x23, 0xa3, 0xfe, 0xeb, 0xbd,
+      0x45, 0x4d, 0x44, 0x23, 0x64, 0x3c, 0xe8, 0x0e,
+      0x2a, 0x9a, 0xc9, 0x4f, 0xa5, 0x4c, 0xa4, 0x9f
+    },
+    {
+      0x53, 0x04, 0x8e, 0x26, 0x81, 0x94, 0x1e, 0xf9,
+      0x9b, 0x2e, 0x29, 0xb7, 0x6b, 0x4c, 0x7d, 0xab,
+      0xe4, 0xc2, 0xd0, 0xc6, 0x34, 0xfc, 0x6d, 0x46,
+      0xe0, 0xe2, 0xf1, 0x31, 0x07, 0xe7, 0xaf, 0x23
+    }
+  },
+  { "abcdbcdecdefdefgefghfghighijhijkijkljklmklmnlmnomnopnopq",
+    {
+      0x33, 0x91, 0xfd, 0xdd, 0xfc, 0x8d, 0xc7, 0x39,
+      0x37, 0x07, 0xa6, 0x5b, 0x1b, 0x47, 0x09, 0x39,
+      0x7c, 0xf8, 0xb1, 0xd1, 0x62, 0xaf, 0x05, 0xab,
+      0xfe, 0x8f, 0x45, 0x0d, 0xe5, 0xf3, 0x6b, 0xc6,
+      0xb0, 0x45, 0x5a, 0x85, 0x20, 0xbc, 0x4e, 0x6f,
+      0x5f, 0xe9, 0x5b, 0x1f, 0xe3, 0xc8, 0x45, 0x2b
+    },
+    {
+      0x20, 0x4a, 0x8f, 0xc6, 0xdd, 0xa8, 0x2f, 0x0a,
+      0x0c, 0xed, 0x7b, 0xeb, 0x8e, 0x08, 0xa4, 0x16,
+      0x57, 0xc1, 0x6e, 0xf4, 0x68, 0xb2, 0x28, 0xa8,
+      0x27, 0x9b, 0xe3, 0x31, 0xa7, 0x03, 0xc3, 0x35,
+      0x96, 0xfd, 0x15, 0xc1, 0x3b, 0x1b, 0x07, 0xf9,
+      0xaa, 0x1d, 0x3b, 0xea, 0x57, 0x78, 0x9c, 0xa0,
+      0x31, 0xad, 0x85, 0xc7, 0xa7, 0x1d, 0xd7, 0x03,
+      0x54, 0xec, 0x63, 0x12, 0x38, 0xca, 0x34, 0x45
+    },
+    {
+      0xbd, 0xe8, 0xe1, 0xf9, 0xf1, 0x9b, 0xb9, 0xfd,
+      0x34, 0x06, 0xc9, 0x0e, 0xc6, 0xbc, 0x47, 0xbd,
+      0x36, 0xd8, 0xad, 0xa9, 0xf1, 0x18, 0x80, 0xdb,
+      0xc8, 0xa2, 0x2a, 0x70, 0x78, 0xb6, 0xa4, 0x61
+    }
+  },
+  { "abcdefghbcdefghicdefghijdefghijkefghijklfghijklmghijklmnhijklmnoijklmnopjklmnopqklmnopqrlmnopqrsmnopqrstnopqrstu",
+    {
+      0x09, 0x33, 0x0c, 0x33, 0xf7, 0x11, 0x47, 0xe8,
+      0x3d, 0x19, 0x2f, 0xc7, 0x82, 0xcd, 0x1b, 0x47,
+      0x53, 0x11, 0x1b, 0x17, 0x3b, 0x3b, 0x05, 0xd2,
+      0x2f, 0xa0, 0x80, 0x86, 0xe3, 0xb0, 0xf7, 0x12,
+      0xfc, 0xc7, 0xc7, 0x1a, 0x55, 0x7e, 0x2d, 0xb9,
+      0x66, 0xc3, 0xe9, 0xfa, 0x91, 0x74, 0x60, 0x39
+    },
+    {
+      0x8e, 0x95, 0x9b, 0x75, 0xda, 0xe3, 0x13, 0xda,
+      0x8c, 0xf4, 0xf7, 0x28, 0x14, 0xfc, 0x14, 0x3f,
+      0x8f, 0x77, 0x79, 0xc6, 0xeb, 0x9f, 0x7f, 0xa1,
+      0x72, 0x99, 0xae, 0xad, 0xb6, 0x88, 0x90, 0x18,
+      0x50, 0x1d, 0x28, 0x9e, 0x49, 0x00, 0xf7, 0xe4,
+      0x33, 0x1b, 0x99, 0xde, 0xc4, 0xb5, 0x43, 0x3a,
+      0xc7, 0xd3, 0x29, 0xee, 0xb6, 0xdd, 0x26, 0x54,
+      0x5e, 0x96, 0xe5, 0x5b, 0x87, 0x4b, 0xe9, 0x09
+    },
+    {
+      0x39, 0x28, 0xe1, 0x84, 0xfb, 0x86, 0x90, 0xf8,
+      0x40, 0xda, 0x39, 0x88, 0x12, 0x1d, 0x31, 0xbe,
+      0x65, 0xcb, 0x9d, 0x3e, 0xf8, 0x3e, 0xe6, 0x14,
+      0x6f, 0xea, 0xc8, 0x61, 0xe1, 0x9b, 0x56, 0x3a
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefg",
+    {
+      0xb0, 0x75, 0xa2, 0xf3, 0xb7, 0xd7, 0x68, 0xe1,
+      0x8f, 0x58, 0x6f, 0x1f, 0x19, 0x58, 0x6a, 0x4f,
+      0x71, 0x09, 0xca, 0x72, 0xba, 0x01, 0x20, 0x94,
+      0x7e, 0x78, 0x13, 0xd2, 0x5f, 0x49, 0x9f, 0x92,
+      0x47, 0x0d, 0x81, 0x9a, 0x4d, 0x6e, 0x42, 0xd3,
+      0xb1, 0x9b, 0xe8, 0x14, 0x16, 0x27, 0xc5, 0x1d
+    },
+    {
+      0xa4, 0x67, 0x69, 0x80, 0x69, 0xea, 0xe8, 0xed,
+      0x1e, 0x0c, 0x6d, 0xbf, 0xd1, 0xb4, 0xa2, 0x47,
+      0xa9, 0xf1, 0xe7, 0xff, 0x4e, 0x3a, 0xf6, 0x21,
+      0x45, 0xed, 0x26, 0xf4, 0x46, 0x8b, 0xc0, 0x94,
+      0x61, 0x08, 0x78, 0xb7, 0x64, 0x40, 0x91, 0x14,
+      0x13, 0x70, 0xa4, 0x7a, 0x76, 0x38, 0xbd, 0xdc,
+      0x95, 0xdb, 0xfe, 0x89, 0x71, 0xc3, 0x4d, 0x13,
+      0xc4, 0x81, 0x5d, 0x4b, 0xb1, 0xb3, 0xe7, 0xf2
+    },
+    {
+      0x61, 0x9f, 0x97, 0xdc, 0x71, 0x82, 0x09, 0x7f,
+      0x5f, 0x15, 0x88, 0x63, 0xcd, 0x05, 0xd1, 0x64,
+      0xb9, 0xba, 0x91, 0xe1, 0x78, 0xdb, 0x09, 0x08,
+      0x35, 0x3f, 0x6c, 0xe5, 0x84, 0x2a, 0x00, 0x5a
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefgh",
+    {
+      0x55, 0x23, 0xcf, 0xb7, 0x7f, 0x9c, 0x55, 0xe0,
+      0xcc, 0xaf, 0xec, 0x5b, 0x87, 0xd7, 0x9c, 0xde,
+      0x64, 0x30, 0x12, 0x28, 0x3b, 0x71, 0x18, 0x8e,
+      0x40, 0x8c, 0x5a, 0xea, 0xe9, 0x19, 0xa3, 0xf2,
+      0x93, 0x37, 0x57, 0x4d, 0x5c, 0x72, 0x9b, 0x33,
+      0x9d, 0x95, 0x53, 0x98, 0x4a, 0xb0, 0x01, 0x4e
+    },
+    {
+      0xa4, 0x73, 0xc9, 0x37, 0x32, 0xee, 0xf6, 0x27,
+      0xd0, 0x2e, 0x86, 0xd1, 0x90, 0x47, 0xa4, 0x22,
+      0xb5, 0x86, 0x11, 0x08, 0x48, 0xec, 0x17, 0xdc,
+      0xea, 0x13, 0xaf, 0x28, 0x2a, 0x15, 0x2f, 0x76,
+      0x54, 0xb0, 0xc7, 0x11, 0xe2, 0x77, 0xfd, 0x42,
+      0xc1, 0xd9, 0x4b, 0xea, 0x8b, 0x7f, 0xed, 0x61,
+      0x5c, 0x52, 0xbb, 0x0f, 0x84, 0x92, 0x27, 0xe1,
+      0x62, 0x40, 0xaf, 0xff, 0xc7, 0xc5, 0x6e, 0x29
+    },
+    {
+      0xf9, 0x5e, 0xa6, 0x6e, 0x19, 0xcd, 0x5f, 0x0e,
+      0x97, 0x7f, 0x50, 0x17, 0xd0, 0x7f, 0x79, 0x06,
+      0xa7, 0xe8, 0x29, 0xdf, 0xee, 0x98, 0x4e, 0x3f,
+      0xf8, 0xda, 0x38, 0x39, 0x02, 0xdb, 0x6d, 0xde
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvw",
+    {
+      0xfb, 0x90, 0x8c, 0xfc, 0x02, 0x67, 0x90, 0x17,
+      0xab, 0x44, 0xa8, 0xe1, 0x00, 0x8d, 0xec, 0x23,
+      0x9e, 0xa3, 0x6a, 0x38, 0x1a, 0x5c, 0x7a, 0x75,
+      0xbc, 0x6d, 0x64, 0xf7, 0x0d, 0xf3, 0x06, 0xf7,
+      0xdf, 0x0f, 0xcf, 0x94, 0xcd, 0x62, 0xa4, 0x5a,
+      0x15, 0x68, 0x5b, 0x5b, 0xb9, 0x3c, 0x70, 0xd7
+    },
+    {
+      0xc6, 0xce, 0x82, 0xcb, 0x15, 0xc8, 0xd7, 0x04,
+      0x0e, 0xf3, 0x70, 0x4b, 0x1c, 0xb1, 0x61, 0xae,
+      0x3a, 0x7f, 0x0a, 0xc4, 0x30, 0x43, 0x3e, 0x6d,
+      0x52, 0xe3, 0xf3, 0x7b, 0xf5, 0x61, 0x27, 0x1b,
+      0xfd, 0x01, 0x43, 0x28, 0x66, 0x0d, 0x29, 0xee,
+      0x73, 0x3a, 0x9f, 0x7f, 0x17, 0x86, 0x71, 0x39,
+      0x0e, 0xb0, 0xf8, 0x02, 0x31, 0x60, 0x3c, 0x83,
+      0x60, 0x24, 0x67, 0x53, 0xe6, 0x40, 0x6b, 0x8d
+    },
+    {
+      0x5d, 0x92, 0x31, 0x2a, 0x28, 0xa0, 0xb7, 0x93,
+      0xb3, 0xf8, 0xf5, 0xe4, 0x3a, 0x2e, 0x97, 0xe8,
+      0x51, 0x33, 0x91, 0x53, 0x81, 0x77, 0xad, 0x17,
+      0xc9, 0xa9, 0x06, 0x9d, 0xe0, 0x90, 0xdb, 0x9e
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwx",
+    {
+      0x67, 0x4b, 0x2e, 0x80, 0xff, 0x8d, 0x94, 0x00,
+      0x8d, 0xe7, 0x40, 0x9c, 0x7b, 0x1f, 0x87, 0x8f,
+      0x9f, 0xae, 0x3a, 0x0a, 0x6d, 0xae, 0x2f, 0x98,
+      0x2c, 0xca, 0x7e, 0x3a, 0xae, 0xf9, 0x1b, 0xf3,
+      0x25, 0xd3, 0xeb, 0x56, 0x82, 0x63, 0xa2, 0xe1,
+      0xe6, 0x85, 0x6a, 0xc7, 0x50, 0x70, 0x06, 0x2a
+    },
+    {
+      0x21, 0x7d, 0x3d, 0x9c, 0x09, 0x52, 0xc3, 0xe4,
+      0x90, 0x7f, 0x06, 0xd4, 0xfb, 0xf3, 0x44, 0x60,
+      0xee, 0x85, 0x2c, 0x6a, 0xf5, 0x91, 0xb0, 0x7c,
+      0x2f, 0xa1, 0xc5, 0xe1, 0x64, 0x55, 0x83, 0x63,
+      0x74, 0xc9, 0x5a, 0xe3, 0x3e, 0x18, 0x42, 0x27,
+      0x91, 0x3f, 0x8a, 0x2e, 0x22, 0x7e, 0x3b, 0xbd,
+      0x51, 0x87, 0xce, 0x57, 0xaa, 0x1b, 0xad, 0x11,
+      0xa8, 0x0f, 0x62, 0x24, 0x12, 0xeb, 0x08, 0x84
+    },
+    {
+      0x8e, 0x7b, 0x3f, 0x63, 0xa5, 0xdc, 0x33, 0xe4,
+      0xdd, 0x50, 0x62, 0x4c, 0x72, 0x04, 0x26, 0xed,
+      0x3d, 0x18, 0x4c, 0xda, 0x38, 0xaf, 0xa8, 0x6b,
+      0xf4, 0x44, 0x9a, 0x05, 0x4d, 0x09, 0xfe, 0x24
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxy",
+    {
+      0x79, 0x7d, 0x56, 0x26, 0x8a, 0x28, 0x49, 0xf4,
+      0xc8, 0xfb, 0xa0, 0xf6, 0x20, 0xf1, 0xd3, 0xdc,
+      0xc9, 0x4d, 0x16, 0xb1, 0x42, 0x43, 0xd5, 0xaa,
+      0xe0, 0x01, 0x5c, 0x39, 0xaa, 0x51, 0xc1, 0x3f,
+      0xc4, 0x55, 0x65, 0x3e, 0xc1, 0x39, 0x26, 0xcd,
+      0x91, 0x39, 0x3c, 0xa4, 0x2b, 0x44, 0x70, 0x9c
+    },
+    {
+      0x18, 0xd5, 0xa2, 0x0f, 0x40, 0xcd, 0x79, 0x03,
+      0xe6, 0x25, 0xac, 0x1e, 0x4f, 0xc1, 0x09, 0x71,
+      0xfb, 0x3b, 0xd6, 0xce, 0xcb, 0x12, 0xa6, 0x84,
+      0xf7, 0x60, 0x09, 0x75, 0x34, 0x06, 0x49, 0xee,
+      0xbc, 0xcd, 0x11, 0xcc, 0x97, 0xfe, 0x9e, 0x36,
+      0xbb, 0xcb, 0x3a, 0xe7, 0x5d, 0x6d, 0x7a, 0x0d,
+      0xc2, 0xe6, 0x0e, 0x00, 0x22, 0xc5, 0x79, 0xe8,
+      0x7c, 0x3e, 0xe2, 0xe3, 0xff, 0xaf, 0x65, 0xcc
+    },
+    {
+      0x4c, 0x35, 0x63, 0x5a, 0xe1, 0x47, 0xbd, 0x82,
+      0x39, 0xe2, 0xe9, 0x01, 0x6b, 0x59, 0xfa, 0xf1,
+      0x8e, 0xd5, 0x5d, 0x11, 0xe8, 0x55, 0xc2, 0x29,
+      0x5f, 0xce, 0x02, 0x3a, 0xdb, 0x71, 0xb3, 0x97
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcde",
+    {
+      0xae, 0xd8, 0xea, 0x98, 0xa0, 0x45, 0x88, 0xfe,
+      0xc1, 0x7c, 0xaa, 0xcd, 0xac, 0xff, 0x7b, 0x6d,
+      0x6b, 0xe7, 0x8c, 0xe0, 0x7c, 0x79, 0x82, 0x48,
+      0x2e, 0x87, 0x81, 0x93, 0xad, 0xd0, 0x0d, 0x5d,
+      0xcb, 0x5e, 0xe7, 0x4d, 0xfb, 0xb0, 0x26, 0x18,
+      0x3f, 0x5e, 0x83, 0xb0, 0x63, 0xe4, 0xda, 0x54
+    },
+    {
+      0xdf, 0x67, 0x33, 0x22, 0x19, 0xc5, 0x55, 0xaa,
+      0xfc, 0x70, 0x07, 0xe6, 0x3c, 0xc1, 0x4d, 0xf8,
+      0xe3, 0xc1, 0xde, 0xc2, 0x49, 0x02, 0xa9, 0x6d,
+      0x55, 0x9c, 0x09, 0x9a, 0x66, 0x72, 0x4a, 0xbd,
+      0xde, 0xb5, 0x78, 0x88, 0x07, 0x62, 0x1c, 0x70,
+      0x3b, 0x16, 0xad, 0x48, 0x17, 0xc9, 0x9a, 0x52,
+      0x8b, 0xce, 0x4f, 0x13, 0x44, 0x76, 0x4b, 0x2f,
+      0x05, 0xc7, 0x65, 0x05, 0x83, 0x39, 0x2b, 0x89
+    },
+    {
+      0xa8, 0xfe, 0x9a, 0x9d, 0xcd, 0xfe, 0x9f, 0x2d,
+      0xa4, 0x50, 0xcd, 0xd6, 0xab, 0xf0, 0x91, 0x6b,
+      0x33, 0x14, 0x4b, 0x4d, 0xcb, 0x5c, 0x26, 0x12,
+      0x6e, 0x7d, 0xff, 0xfc, 0x31, 0x60, 0x78, 0xcb
+    }
+  },
+  { "abcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdefghijklmnopqrstuvwxyzabcdef",
+    {
+      0xf4, 0xfb, 0xf0, 0xf4, 0xd1, 0x57, 0x3c, 0x55,
+      0x06, 0x1e, 0x51, 0x71, 0x8f, 0x3f, 0xd6, 0x55,
+      0xa3, 0x12, 0x9e, 0x6c, 0x55, 0xdb, 0x12, 0x7a,
+      0x4b, 0x8c, 0x0e, 0x82, 0x04, 0x2b, 0x9a, 0xdc,
+      0x73, 0x52, 0x87, 0xb6, 0x42, 0x26, 0x88, 0x7f,
+      0xf8, 0xec, 0xc0, 0x1e, 0xcf, 0x46, 0xa0, 0x54
+    },
+    {
+      0x6b, 0x0d, 0x01, 0x02, 0x5a, 0xe2, 0xc8, 0x17,
+      0x9e, 0x3a, 0x1c, 0x14, 0x62, 0x7b, 0x6b, 0x25,
+      0x59, 0xfa, 0xee, 0x6c, 0x92, 0xb1, 0x33, 0x8e,
+      0x5a, 0x2d, 0x3e, 0x4e, 0xcf, 0xc7, 0x96, 0x55,
+      0x92, 0x9d, 0x35, 0xeb, 0x2f, 0x71, 0x79, 0x87,
+      0x6e, 0x2a, 0xec, 0x19, 0x82, 0x4a, 0x81, 0x31,
+      0x83, 0xa7, 0x7e, 0x35, 0xa3, 0x98, 0x19, 0x54,
+      0xf2, 0xfd, 0xe7, 0xbf, 0xbc, 0xd1, 0xbc, 0x1d
+    },
+    {
+      0xe0, 0x2b, 0x40, 0xf3, 0x08, 0xc5, 0x73, 0x09,
+      0x70, 0xcc, 0x6e, 0xdb, 0xcd, 0xc0, 0xa1, 0x7f,
+      0x2f, 0xc4, 0xc2, 0xc8, 0xd7, 0x99, 0x8a, 0x09,
+      0xc5, 0x9d, 0xf6, 0xf1, 0x97, 0x01, 0xd3, 0xb0
+    }
+  },
+  { NULL, { 0 }, { 0 }, { 0 } }
+};
+
+static const uint8_t million_a[SHA512MINI_HASHLEN] =
+{
+  0xe7, 0x18, 0x48, 0x3d, 0x0c, 0xe7, 0x69, 0x64,
+  0x4e, 0x2e, 0x42, 0xc7, 0xbc, 0x15, 0xb4, 0x63,
+  0x8e, 0x1f, 0x98, 0xb1, 0x3b, 0x20, 0x44, 0x28,
+  0x56, 0x32, 0xa8, 0x03, 0xaf, 0xa9, 0x73, 0xeb,
+  0xde, 0x0f, 0xf2, 0x44, 0x87, 0x7e, 0xa6, 0x0a,
+  0x4c, 0xb0, 0x43, 0x2c, 0xe5, 0x77, 0xc3, 0x1b,
+  0xeb, 0x00, 0x9c, 0x5c, 0x2c, 0x49, 0xaa, 0x2e,
+  0x4e, 0xad, 0xb2, 0x17, 0xad, 0x8c, 0xc0, 0x9b
+};
+
+static int test_million_a(void)
+{
+  static uint8_t buf[1000];
+  uint8_t res[SHA512MINI_HASHLEN];
+  SHA512Mini_ctx ctx;
+  size_t done = 0, n = 1;
+
+  memset(buf, 'a', sizeof(buf));
+  SHA512Mini_Init(&ctx);
+  while ( done < 1000000 )
+  {
+    if ( n > 1000000 - done )
+      n = 1000000 - done;
+    SHA512Mini_Update(&ctx, buf, n);
+    done += n;
+    n = (n * 7 + 13) % sizeof(buf);
+  }
+  SHA512Mini_Final(&ctx, res);
+  printf("Million a's: ");
+  if ( memcmp(res, million_a, sizeof(res)) != 0 )
+  {
+    printf("FAIL\n");
+    return 1;
+  }
+  printf("OK\n");
+  return 0;
+}
+
+int main()
+{
+  const TestVector *tv;
+  int fails=0;
+
+  for (tv=&tvs[0]; tv->in != NULL; tv++)
+  {
+    uint8_t b384[SHA384MINI_HASHLEN], b512[SHA512MINI_HASHLEN];
+    uint8_t b256[SHA512_256MINI_HASHLEN];
+    size_t l = strlen(tv->in);
+
+    printf("Length %5ld: ", (unsigned long)l);
+    SHA384Mini(tv->in, l, b384);
+    SHA512Mini(tv->in, l, b512);
+    SHA512_256Mini(tv->in, l, b256);
+    if ( memcmp(b384, tv->out384, sizeof(b384)) != 0
+         || memcmp(b512, tv->out512, sizeof(b512)) != 0
+         || memcmp(b256, tv->out512_256, sizeof(b256)) != 0 )
+    {
+      fails++;
+      printf("FAIL\n");
+    }
+    else
+      printf("OK\n");
+  }
+  fails += test_million_a();
+
+  return fails ? 1 : 0;
+}
+
+#endif
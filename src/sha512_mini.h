@@ -0,0 +1,58 @@
+#ifndef SHA512_MINI_H
+#define SHA512_MINI_H
+/*
+ * SHA-384, SHA-512 and SHA-512/256 implementation from minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * These work on 64-bit words, so on 64-bit CPUs they get through more
+ * bytes per round than SHA-256; SHA-512/256 is the one to use for bulk
+ * hashing where a 256-bit result is wanted. On 32-bit targets SHA-256
+ * is faster.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+
+typedef struct
+{
+  uint64_t count;
+  uint8_t msgbuf[128];
+  uint64_t H[8];
+}
+  SHA512Mini_ctx;
+
+/* The truncated variants use the same context, with their own Init and Final */
+typedef SHA512Mini_ctx SHA384Mini_ctx;
+typedef SHA512Mini_ctx SHA512_256Mini_ctx;
+
+#define SHA512MINI_HASHLEN     64
+#define SHA384MINI_HASHLEN     48
+#define SHA512_256MINI_HASHLEN 32
+
+extern void SHA512Mini_Init(SHA512Mini_ctx *ctx);
+extern void SHA512Mini_Update(SHA512Mini_ctx *ctx, const void *pvmsg, size_t msglen);
+extern void SHA512Mini_Final(SHA512Mini_ctx *ctx, uint8_t *out);
+
+extern void SHA384Mini_Init(SHA384Mini_ctx *ctx);
+extern void SHA384Mini_Update(SHA384Mini_ctx *ctx, const void *pvmsg, size_t msglen);
+extern void SHA384Mini_Final(SHA384Mini_ctx *ctx, uint8_t *out);
+
+extern void SHA512_256Mini_Init(SHA512_256Mini_ctx *ctx);
+extern void SHA512_256Mini_Update(SHA512_256Mini_ctx *ctx, const void *pvmsg, size_t msglen);
+extern void SHA512_256Mini_Final(SHA512_256Mini_ctx *ctx, uint8_t *out);
+
+extern void SHA512Mini(const void *msg, size_t msglen, uint8_t *out64);
+extern void SHA384Mini(const void *msg, size_t msglen, uint8_t *out48);
+extern void SHA512_256Mini(const void *msg, size_t msglen, uint8_t *out32);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SHA512_MINI_H */
@@ -0,0 +1,75 @@
+/*
+ *
+ * x86 CPU feature detection from Minicrypt library
+ *
+ * This program is placed into the public domain
+ * by its author, Ian Harvey.
+ * Note there is NO WARRANTY of any kind.
+ */
+
+#include "x86cpu_mini.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <cpuid.h>
+
+static uint32_t xgetbv0(void)
+{
+  uint32_t lo, hi;
+  __asm__ ("xgetbv" : "=a"(lo), "=d"(hi) : "c"(0));
+  return lo;
+}
+
+static unsigned detect(void)
+{
+  unsigned a, b, c, d;
+  unsigned res = 0;
+  uint32_t xcr0 = 0;
+
+  if ( !__get_cpuid(1, &a, &b, &c, &d) )
+    return 0;
+
+  if ( d & bit_SSE2 )   res |= X86MINI_SSE2;
+  if ( c & bit_SSSE3 )  res |= X86MINI_SSSE3;
+  if ( c & bit_SSE4_1 ) res |= X86MINI_SSE41;
+  if ( c & bit_OSXSAVE )
+  {
+    xcr0 = xgetbv0();
+    if ( (c & bit_AVX) && (xcr0 & 0x06) == 0x06 )
+      res |= X86MINI_AVX;
+  }
+
+  if ( __get_cpuid_count(7, 0, &a, &b, &c, &d) )
+  {
+    if ( (b & (1u << 5)) && (res & X86MINI_AVX) )  res |= X86MINI_AVX2;
+    if ( b & (1u << 29) ) res |= X86MINI_SHA;
+    if ( b & (1u << 8) )  res |= X86MINI_BMI2;
+    if ( b & (1u << 19) ) res |= X86MINI_ADX;
+    if ( (b & (1u << 16)) && (xcr0 & 0xE6) == 0xE6 ) res |= X86MINI_AVX512F;
+  }
+  return res;
+}
+
+#else
+
+static unsigned detect(void)
+{
+  return 0;
+}
+
+#endif
+
+unsigned X86Mini_features(void)
+{
+  /* Top bit marks 'already detected'. Racing threads will all
+     write the same value, so relaxed atomics are enough. */
+  static unsigned features = 0;
+  unsigned f = __atomic_load_n(&features, __ATOMIC_RELAXED);
+
+  if ( f == 0 )
+  {
+    f = detect() | 0x80000000u;
+    __atomic_store_n(&features, f, __ATOMIC_RELAXED);
+  }
+  return f & 0x7FFFFFFFu;
+}
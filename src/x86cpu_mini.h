@@ -0,0 +1,37 @@
+#ifndef X86CPU_MINI_H
+#define X86CPU_MINI_H
+/*
+ * x86 CPU feature detection for minicrypt library
+ *
+ * https://github.com/IanHarvey/minicrypt
+ *
+ * In the public domain. Note there is NO WARRANTY.
+ *
+ * Only used by the optional x86-accelerated code paths. On other
+ * architectures, or other compilers than GCC/clang, no features are reported.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "minicrypt.h"
+
+#define X86MINI_SSE2     0x0001
+#define X86MINI_SSSE3    0x0002
+#define X86MINI_SSE41    0x0004
+#define X86MINI_AVX      0x0008  /* Includes OS support for YMM state */
+#define X86MINI_AVX2     0x0010
+#define X86MINI_SHA      0x0020
+#define X86MINI_BMI2     0x0040
+#define X86MINI_ADX      0x0080
+#define X86MINI_AVX512F  0x0100  /* Includes OS support for ZMM state */
+
+extern unsigned X86Mini_features(void);
+/* Returns a mask of X86MINI_xxx values supported by this CPU */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* X86CPU_MINI_H */